@@ -19,9 +19,15 @@ Copyright(C), tao.jing All rights reserved
 #include "TFMeaManager.h"
 #include "DataPubZmqManager.h"
 #include "AiResultSaveManager.h"
+#include "AnnotatedVideoManager.h"
+#include "LatencyTracer.h"
+#include "MetricsRegistry.h"
 #include "DbManager.h"
+#include "StartupSequencer.h"
+#include "TConfig.h"
 #include "TLog.h"
 #include "loguru.hpp"
+#include <algorithm>
 #include <iostream>
 
 
@@ -35,6 +41,7 @@ int TF::AppMonitor::initApp(int argc, char* argv[]) {
 
     try {
         AppLocalConfig::instance().initConfigs();
+        initAsyncLog();
     } catch (TFRuntimeException& ex) {
         exitApp(ex);
     } catch (std::exception &ex) {
@@ -42,18 +49,72 @@ int TF::AppMonitor::initApp(int argc, char* argv[]) {
     }
 
     try {
-        TFDetectManager::instance().init();
-        ThermalManager::instance().init();
-        DbManager::instance().init();
-        TFMeaManager::instance().init();
-        DataPubZmqManager::instance().init();
-        AiResultSaveManager::instance().init();
+        // The experiment view reads the database path while the window is built
+        DbManager::instance().initParams();
+        initStartupStages();
+        StartupSequencer::instance().start();
     } catch (std::exception &ex) {
-        LOG_F(ERROR, "Init TFDetectManager failed %s.", ex.what());
+        LOG_F(ERROR, "Init startup stages failed %s.", ex.what());
     }
     return 0;
 }
 
+void TF::AppMonitor::initStartupStages() {
+    auto &startup = StartupSequencer::instance();
+
+    // Model parsing and warm-up, the database and the socket run on the startup pool
+    // while the UI comes up
+    startup.addStage("detector", QObject::tr("检测模型"), {}, StartupAffinity::Pool, []() {
+        return TFDetectManager::instance().init();
+    });
+    startup.addStage("db", QObject::tr("数据库"), {}, StartupAffinity::Pool, []() {
+        DbManager::instance().openDb();
+        return true;
+    });
+    startup.addStage("zmq", QObject::tr("数据发布"), {}, StartupAffinity::Pool, []() {
+        return DataPubZmqManager::instance().init();
+    });
+
+    // Config reads only, done before the window is built
+    startup.addStage("metrics", QObject::tr("运行指标"), {}, StartupAffinity::Main, []() {
+        MetricsRegistry::instance().init();
+        return true;
+    });
+    startup.addStage("thermal", QObject::tr("红外模组"), {}, StartupAffinity::Main, []() {
+        ThermalManager::instance().init();
+        return true;
+    });
+    startup.addStage("measure", QObject::tr("测量"), {}, StartupAffinity::Main, []() {
+        TFMeaManager::instance().init();
+        return true;
+    });
+    startup.addStage("annotatedVideo", QObject::tr("标注视频"), {}, StartupAffinity::Main, []() {
+        AnnotatedVideoManager::instance().init();
+        return true;
+    });
+    startup.addStage("latencyTrace", QObject::tr("延迟追踪"), {}, StartupAffinity::Main, []() {
+        LatencyTracer::instance().init();
+        return true;
+    });
+
+    // Sample records go to the database, saving waits for it
+    startup.addStage("resultSave", QObject::tr("结果保存"), {"db"}, StartupAffinity::Main, []() {
+        AiResultSaveManager::instance().init();
+        return true;
+    });
+}
+
+void TF::AppMonitor::shutdownApp() {
+    // The metrics export thread publishes through DataPubZmqManager; both are function-static
+    // singletons created on different startup threads, so their destruction order is not fixed
+    MetricsRegistry::instance().shutdown();
+    DataPubZmqManager::instance().shutdown();
+
+    // Last, so the shutdown messages above are written as well
+    TBase::TAsyncLog::instance().flush();
+    TBase::TAsyncLog::instance().stop();
+}
+
 void TF::AppMonitor::initAfterWid() {
     mMainWid->initAfterDisplay();
 
@@ -74,6 +135,19 @@ void TF::AppMonitor::initAppLog(int argc, char* argv[]) {
     }
 }
 
+void TF::AppMonitor::initAsyncLog() {
+    if (!GET_BOOL_CONFIG("Log", "Async")) {
+        return;
+    }
+
+    TBase::TAsyncLog::Params params;
+    params.threadQueueSize = static_cast<std::size_t>(std::max(2, GET_INT_CONFIG("Log", "ThreadQueueSize")));
+    params.repeatLimitPerSec = GET_INT_CONFIG("Log", "RepeatLimitPerSec");
+    TBase::TAsyncLog::instance().start(params);
+    LOG_F(INFO, "Async log started, %zu records per thread, %d repeats per second.",
+          params.threadQueueSize, params.repeatLimitPerSec);
+}
+
 void TF::AppMonitor::exitApp(TFRuntimeException& ex) {
     std::cerr << "----- Fatal error: " << std::endl;
     std::cerr << ex.what() << std::endl;
@@ -26,6 +26,9 @@ namespace TF {
     public:
         static int initApp(int argc, char *argv[]);
 
+        // Stops the background threads in dependency order before the singletons are destroyed
+        static void shutdownApp();
+
         void initAfterWid();
 
         void setMainWid(FuMainWid *wid) {mMainWid = wid;};
@@ -35,6 +38,10 @@ namespace TF {
     private:
         static void initAppLog(int argc, char *argv[]);
 
+        static void initAsyncLog();
+
+        static void initStartupStages();
+
         static void exitApp(TFRuntimeException& ex);
 
     private:
@@ -0,0 +1,291 @@
+/**************************************************************************
+
+Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : StartupSequencer.cpp
+   Author : tao.jing
+   Date   : 2026/10/19
+   Brief  : Dependency-ordered, parallel subsystem startup
+**************************************************************************/
+#include "StartupSequencer.h"
+#include "MetricsRegistry.h"
+#include "TLog.h"
+#include <QMutexLocker>
+#include <QThread>
+#include <algorithm>
+#include <exception>
+
+
+namespace TF {
+
+    namespace {
+        int stageIndex(const QVector<StartupStageInfo> &stages, const QString &name) {
+            for (int i = 0; i < stages.size(); ++i) {
+                if (stages[i].name == name) {
+                    return i;
+                }
+            }
+            return -1;
+        }
+
+        bool isTerminal(StartupState state) {
+            return state == StartupState::Ready || state == StartupState::Failed || state == StartupState::Skipped;
+        }
+    }
+
+    StartupSequencer::StartupSequencer(QObject *parent) : QObject(parent) {
+        mPool.setMaxThreadCount(std::max(2, QThread::idealThreadCount()));
+    }
+
+    StartupSequencer::~StartupSequencer() {
+        mPool.waitForDone();
+    }
+
+    void StartupSequencer::addStage(const QString &name, const QString &title, const QStringList &deps,
+                                    StartupAffinity affinity, StageFunc func) {
+        QMutexLocker locker(&mMutex);
+        if (mStarted) {
+            LOG_F(ERROR, "Startup stage %s added after start, ignored.", name.toStdString().c_str());
+            return;
+        }
+
+        StartupStageInfo info;
+        info.name = name;
+        info.title = title;
+        info.deps = deps;
+        info.affinity = affinity;
+        mStages.append(info);
+        mFuncs.append(std::move(func));
+    }
+
+    void StartupSequencer::start() {
+        {
+            QMutexLocker locker(&mMutex);
+            if (mStarted) {
+                return;
+            }
+            mStarted = true;
+            mClock.start();
+
+            for (const auto &stage : mStages) {
+                for (const auto &dep : stage.deps) {
+                    if (stageIndex(mStages, dep) < 0) {
+                        LOG_F(ERROR, "Startup stage %s depends on unknown stage %s.",
+                              stage.name.toStdString().c_str(), dep.toStdString().c_str());
+                    }
+                }
+            }
+        }
+
+        LOG_F(INFO, "Startup of %d subsystems, %d pool threads.", static_cast<int>(stages().size()),
+              mPool.maxThreadCount());
+        scheduleReady();
+    }
+
+    QVector<StartupStageInfo> StartupSequencer::stages() const {
+        QMutexLocker locker(&mMutex);
+        return mStages;
+    }
+
+    bool StartupSequencer::isReady(const QString &name) const {
+        QMutexLocker locker(&mMutex);
+        const int index = stageIndex(mStages, name);
+        return index >= 0 && mStages[index].state == StartupState::Ready;
+    }
+
+    bool StartupSequencer::isFinished() const {
+        QMutexLocker locker(&mMutex);
+        return mTotalMs >= 0;
+    }
+
+    qint64 StartupSequencer::elapsedMs() const {
+        QMutexLocker locker(&mMutex);
+        if (mTotalMs >= 0) {
+            return mTotalMs;
+        }
+        return mClock.isValid() ? mClock.elapsed() : 0;
+    }
+
+    const char *StartupSequencer::stateName(StartupState state) {
+        switch (state) {
+            case StartupState::Pending:
+                return "pending";
+            case StartupState::Running:
+                return "running";
+            case StartupState::Ready:
+                return "ready";
+            case StartupState::Failed:
+                return "failed";
+            case StartupState::Skipped:
+                return "skipped";
+        }
+        return "unknown";
+    }
+
+    void StartupSequencer::scheduleReady() {
+        QVector<int> poolStages;
+        QVector<int> mainStages;
+        QStringList skipped;
+        bool finishedNow = false;
+        {
+            QMutexLocker locker(&mMutex);
+            // A skip can unblock the skip of the stages behind it, repeat until nothing changes
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                for (int i = 0; i < mStages.size(); ++i) {
+                    auto &stage = mStages[i];
+                    if (stage.state != StartupState::Pending) {
+                        continue;
+                    }
+
+                    bool blocked = false;
+                    bool waiting = false;
+                    for (const auto &dep : stage.deps) {
+                        const int depIndex = stageIndex(mStages, dep);
+                        if (depIndex < 0 || mStages[depIndex].state == StartupState::Failed ||
+                            mStages[depIndex].state == StartupState::Skipped) {
+                            blocked = true;
+                            break;
+                        }
+                        if (mStages[depIndex].state != StartupState::Ready) {
+                            waiting = true;
+                        }
+                    }
+
+                    if (blocked) {
+                        stage.state = StartupState::Skipped;
+                        stage.error = QStringLiteral("dependency not ready");
+                        skipped << stage.name;
+                        changed = true;
+                    }
+                    else if (!waiting) {
+                        stage.state = StartupState::Running;
+                        if (stage.affinity == StartupAffinity::Pool) {
+                            poolStages << i;
+                        }
+                        else {
+                            mainStages << i;
+                        }
+                    }
+                }
+            }
+
+            const bool allDone = std::all_of(mStages.cbegin(), mStages.cend(), [](const auto &stage) {
+                return isTerminal(stage.state);
+            });
+            if (allDone && mTotalMs < 0) {
+                mTotalMs = mClock.elapsed();
+                finishedNow = true;
+            }
+        }
+
+        for (const auto &name : skipped) {
+            LOG_F(WARNING, "Startup stage %s skipped, a dependency is not ready.", name.toStdString().c_str());
+            emit stageChanged(name, static_cast<int>(StartupState::Skipped));
+        }
+
+        for (const int index : poolStages) {
+            mPool.start([this, index]() {
+                loguru::set_thread_name("startup");
+                runStage(index);
+            });
+        }
+        for (const int index : mainStages) {
+            if (QThread::currentThread() == thread()) {
+                runStage(index);
+            }
+            else {
+                QMetaObject::invokeMethod(this, [this, index]() { runStage(index); }, Qt::QueuedConnection);
+            }
+        }
+
+        if (finishedNow) {
+            logTimeline();
+        }
+    }
+
+    void StartupSequencer::runStage(int index) {
+        QString name;
+        StageFunc func;
+        qint64 startMs = 0;
+        {
+            QMutexLocker locker(&mMutex);
+            startMs = mClock.elapsed();
+            mStages[index].startMs = startMs;
+            name = mStages[index].name;
+            func = mFuncs[index];
+        }
+        emit stageChanged(name, static_cast<int>(StartupState::Running));
+
+        bool ok = false;
+        QString error;
+        try {
+            ok = func();
+            if (!ok) {
+                error = QStringLiteral("init returned false");
+            }
+        }
+        catch (const std::exception &ex) {
+            error = QString::fromLocal8Bit(ex.what());
+        }
+        catch (...) {
+            error = QStringLiteral("unknown exception");
+        }
+
+        const auto state = ok ? StartupState::Ready : StartupState::Failed;
+        qint64 durationMs = 0;
+        {
+            QMutexLocker locker(&mMutex);
+            durationMs = mClock.elapsed() - startMs;
+            mStages[index].durationMs = durationMs;
+            mStages[index].state = state;
+            mStages[index].error = error;
+        }
+
+        if (ok) {
+            LOG_F(INFO, "Startup stage %s ready, %lld ms.", name.toStdString().c_str(),
+                  static_cast<long long>(durationMs));
+        }
+        else {
+            LOG_F(ERROR, "Startup stage %s failed after %lld ms, %s.", name.toStdString().c_str(),
+                  static_cast<long long>(durationMs), error.toStdString().c_str());
+        }
+        emit stageChanged(name, static_cast<int>(state));
+
+        scheduleReady();
+    }
+
+    void StartupSequencer::logTimeline() {
+        auto timeline = stages();
+        std::stable_sort(timeline.begin(), timeline.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.startMs < rhs.startMs;
+        });
+
+        int failedCount = 0;
+        for (const auto &stage : timeline) {
+            if (stage.state != StartupState::Ready) {
+                ++failedCount;
+            }
+        }
+        const qint64 totalMs = elapsedMs();
+
+        LOG_F(INFO, "Startup finished in %lld ms, %d of %d subsystems not ready.", static_cast<long long>(totalMs),
+              failedCount, static_cast<int>(timeline.size()));
+        for (const auto &stage : timeline) {
+            LOG_F(INFO, "  %-16s %-4s start %6lld ms  took %6lld ms  %s%s%s",
+                  stage.name.toStdString().c_str(),
+                  stage.affinity == StartupAffinity::Pool ? "pool" : "main",
+                  static_cast<long long>(std::max<qint64>(stage.startMs, 0)),
+                  static_cast<long long>(std::max<qint64>(stage.durationMs, 0)),
+                  stateName(stage.state),
+                  stage.error.isEmpty() ? "" : ", ",
+                  stage.error.toStdString().c_str());
+        }
+
+        MetricsRegistry::instance().gauge("startup.total_ms").set(static_cast<double>(totalMs));
+        emit finished(totalMs, failedCount);
+    }
+
+}
@@ -0,0 +1,110 @@
+/**************************************************************************
+
+Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : StartupSequencer.h
+   Author : tao.jing
+   Date   : 2026/10/19
+   Brief  : Dependency-ordered, parallel subsystem startup
+**************************************************************************/
+#ifndef FIREAPP_STARTUPSEQUENCER_H
+#define FIREAPP_STARTUPSEQUENCER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <functional>
+
+#include "TSingleton.h"
+
+
+namespace TF {
+
+    enum class StartupState : int {
+        Pending = 0,
+        Running,
+        Ready,
+        Failed,
+        Skipped     // a dependency failed
+    };
+
+    enum class StartupAffinity {
+        Main,       // config reads and other quick work, on the GUI thread
+        Pool        // blocking I/O and model loading, on the startup pool
+    };
+
+    struct StartupStageInfo {
+        QString name;
+        QString title;
+        QStringList deps;
+        StartupAffinity affinity{StartupAffinity::Main};
+        StartupState state{StartupState::Pending};
+        qint64 startMs{-1};     // since start()
+        qint64 durationMs{-1};
+        QString error;
+    };
+
+    // Runs the subsystem inits as a dependency graph. A stage starts as soon as all of its
+    // dependencies are ready; Pool stages run in parallel, Main stages on the GUI thread.
+    // Main stages without pending dependencies run inside start(), so they are done before
+    // the window is built. When the last stage ends the timeline is written to the log.
+    class StartupSequencer : public QObject, public TBase::TSingleton<StartupSequencer> {
+        Q_OBJECT
+
+    public:
+        using StageFunc = std::function<bool()>;
+
+        // Stages are added before start(), dependencies by name
+        void addStage(const QString &name, const QString &title, const QStringList &deps,
+                      StartupAffinity affinity, StageFunc func);
+
+        void start();
+
+        [[nodiscard]] QVector<StartupStageInfo> stages() const;
+
+        [[nodiscard]] bool isReady(const QString &name) const;
+
+        [[nodiscard]] bool isFinished() const;
+
+        // Until the last stage ended, or so far while starting
+        [[nodiscard]] qint64 elapsedMs() const;
+
+        static const char *stateName(StartupState state);
+
+    signals:
+        void stageChanged(const QString &name, int state);
+
+        void finished(qint64 totalMs, int failedCount);
+
+    private:
+        friend class TBase::TSingleton<StartupSequencer>;
+        explicit StartupSequencer(QObject *parent = nullptr);
+
+        ~StartupSequencer() override;
+
+        // Starts every pending stage whose dependencies are ready, skips those behind a failure
+        void scheduleReady();
+
+        void runStage(int index);
+
+        void logTimeline();
+
+        mutable QMutex mMutex;
+        QVector<StartupStageInfo> mStages;
+        QVector<StageFunc> mFuncs;
+        QElapsedTimer mClock;
+        qint64 mTotalMs{-1};
+        bool mStarted{false};
+
+        QThreadPool mPool;
+    };
+
+}
+
+
+#endif //FIREAPP_STARTUPSEQUENCER_H
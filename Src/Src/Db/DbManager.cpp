@@ -14,6 +14,7 @@
 #include "TSysUtils.h"
 #include "PathConfig.h"
 #include "TLog.h"
+#include "MetricsRegistry.h"
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
@@ -57,6 +58,10 @@ namespace TF {
 
 void TF::DbManager::init() {
     initParams();
+    openDb();
+}
+
+void TF::DbManager::openDb() {
     initDb();
     initChannelCache();
 }
@@ -65,6 +70,11 @@ std::string TF::DbManager::databaseFile() const {
     return mDBFile;
 }
 
+bool TF::DbManager::isOpen() const {
+    std::scoped_lock lk(mMtx);
+    return mDB != nullptr && mInitialized;
+}
+
 void TF::DbManager::initParams() {
     auto db_file_dir = GET_STR_CONFIG("Database", "DbDir");
     auto app_config_dir = TFPathParam("AppConfigDir");
@@ -85,12 +95,15 @@ void TF::DbManager::initDb() {
         return;
     }
 
-    if (mInitialized) {
+    if (isOpen()) {
         return;
     }
 
+    // Opened outside the lock, published under it: openDb() runs on a startup thread
+    // while the UI may already query
+    SQLite::Database *database = nullptr;
     try {
-        mDB = new SQLite::Database(mDBFile, SQLite::OPEN_READWRITE);
+        database = new SQLite::Database(mDBFile, SQLite::OPEN_READWRITE);
     }
     catch (std::exception &e) {
         LOG_F(ERROR, "SQLite open exception: %s.", e.what());
@@ -99,11 +112,14 @@ void TF::DbManager::initDb() {
     }
 
     LOG_F(INFO, "Load database file path %s.", mDBFile.c_str());
+    std::scoped_lock lk(mMtx);
+    mDB = database;
     mInitialized = true;
 }
 
 void TF::DbManager::initChannelCache() {
     try {
+        std::scoped_lock lk(mMtx);
         if (mDB == nullptr) {
             mDB = new SQLite::Database(mDBFile, SQLite::OPEN_READWRITE);
         }
@@ -137,6 +153,7 @@ bool TF::DbManager::channelTableExistsUnsafe() const {
 }
 
 void TF::DbManager::refreshChannelCache() {
+    std::scoped_lock dbLk(mMtx);
     if (!mDB) {
         return;
     }
@@ -211,14 +228,14 @@ std::optional<std::string> TF::DbManager::getChannelNameById(int channel_id) con
 
 
 std::optional<std::string> TF::DbManager::GetDetectImagePath(int exp_id, int sample_id) const {
-    if (!mDB || !mInitialized) {
-        return std::nullopt;
-    }
     if (exp_id < 0 || sample_id < 0) {
         return std::nullopt;
     }
 
     std::scoped_lock lk(mMtx);
+    if (!mDB || !mInitialized) {
+        return std::nullopt;
+    }
 
     if (!mStmtGetDetectImagePath) {
         mStmtGetDetectImagePath = std::make_unique<SQLite::Statement>(
@@ -250,14 +267,14 @@ bool TF::DbManager::UpsertDetectImage(int exp_id, int sample_id, std::string_vie
                                        std::string_view ori_image_path,
                                        std::string_view ir_img_path, std::string_view ir_dat_path,
                                        std::string_view fire_mask_path) {
-    if (!mDB || !mInitialized) {
-        return false;
-    }
     if (exp_id < 0 || sample_id < 0 || image_path.empty()) {
         return false;
     }
 
     std::scoped_lock lk(mMtx);
+    if (!mDB || !mInitialized) {
+        return false;
+    }
 
     if (!mStmtUpsertDetectImage) {
         mStmtUpsertDetectImage = std::make_unique<SQLite::Statement>(
@@ -411,7 +428,13 @@ std::size_t TF::DbManager::InsertBatch(std::span<const DataRow> rows, ConflictPo
         stmt.clearBindings();
     }
 
-    txn.commit();
+    {
+        static auto& commitTime = MetricsRegistry::instance().histogram("db.commit_us");
+        MetricTimer timer(commitTime);
+        txn.commit();
+    }
+    static auto& rowCount = MetricsRegistry::instance().counter("db.rows");
+    rowCount.add(static_cast<int64_t>(rows.size()));
     return changed;
 }
 
@@ -450,6 +473,8 @@ std::size_t TF::DbManager::Writer::Add(std::span<const DataRow> rows) {
         mStmt.reset();
         mStmt.clearBindings();
     }
+    static auto& rowCount = MetricsRegistry::instance().counter("db.rows");
+    rowCount.add(static_cast<int64_t>(rows.size()));
     return changed;
 }
 
@@ -460,7 +485,11 @@ void TF::DbManager::Writer::Commit() {
     if (mCommitted) {
         return;
     }
-    mTxn.commit();
+    {
+        static auto& commitTime = MetricsRegistry::instance().histogram("db.commit_us");
+        MetricTimer timer(commitTime);
+        mTxn.commit();
+    }
     mCommitted = true;
 }
 
@@ -914,10 +943,17 @@ void TF::DbManager::DeleteExperimentAll(int exp_id) {
 }
 
 // ---------------- db(): Get connection ----------------
+// Callers hold mMtx; throws while openDb() has not finished instead of dereferencing null
 SQLite::Database& TF::DbManager::db() {
+    if (mDB == nullptr) {
+        TF_LOG_THROW_RUNTIME("SQLite database not open: %s.", mDBFile.c_str());
+    }
     return *mDB;
 }
 
 const SQLite::Database& TF::DbManager::db() const {
+    if (mDB == nullptr) {
+        TF_LOG_THROW_RUNTIME("SQLite database not open: %s.", mDBFile.c_str());
+    }
     return *mDB;
 }
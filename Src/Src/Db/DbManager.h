@@ -64,8 +64,17 @@ namespace TF {
     public:
         void init();
 
+        // init() in two steps: the path is taken from the config first, so the UI can read
+        // databaseFile() while openDb() still runs on a startup thread
+        void initParams();
+
+        void openDb();
+
         [[nodiscard]] std::string databaseFile() const;
 
+        // False until openDb() has finished; the queries below throw meanwhile
+        [[nodiscard]] bool isOpen() const;
+
         // ---------- Schema / PRAGMA ----------
         void EnsureSchema(); // Create Data table and index
         void ConfigureForIngest(); // PRAGMA (WAL/timeout/synchronous)
@@ -170,8 +179,6 @@ namespace TF {
                                std::string_view fire_mask_path = {});
 
     private:
-        void initParams();
-
         void initDb();
 
         void initChannelCache();
@@ -13,16 +13,27 @@
 #include "ExperimentParamManager.h"
 #include "ThermalManager.h"
 #include "DataPubZmqManager.h"
+#include "MetricsRegistry.h"
 
 
 namespace TF {
 
+    namespace {
+        MetricGauge &SaveBacklog() {
+            static auto &backlog = MetricsRegistry::instance().gauge("save.backlog");
+            return backlog;
+        }
+    }
+
     void AiResultSaveWorker::enqueue(const QImage &image, const QString &filePath, const QString &description,
                                      const QImage &irImage, const QString &irImgPath,
                                      const QByteArray &irRawData, const QString &irDatPath,
                                      const QImage &fireMask, const QString &fireMaskPath,
                                      bool publishZmq,
-                                     const InnerFlameDetectResult &zmqResult) {
+                                     const InnerFlameDetectResult &zmqResult,
+                                     const DetectOverlay &overlay,
+                                     const FrameTrace &trace,
+                                     const QString &sourceFlag) {
         if (image.isNull()) {
             return;
         }
@@ -31,6 +42,7 @@ namespace TF {
         task.image = image.copy();
         task.filePath = filePath;
         task.description = description;
+        task.overlay = overlay;
         if (!irImage.isNull() && !irImgPath.isEmpty()) {
             task.irImage = irImage.copy();
             task.irImgPath = irImgPath;
@@ -45,9 +57,12 @@ namespace TF {
         }
         task.publishZmq = publishZmq;
         task.zmqResult = zmqResult;
+        task.trace = trace;
+        task.sourceFlag = sourceFlag;
 
         QMutexLocker locker(&mMutex);
         mTasks.enqueue(std::move(task));
+        SaveBacklog().set(mTasks.size());
         mCond.wakeOne();
     }
 
@@ -71,18 +86,27 @@ namespace TF {
                 }
 
                 task = mTasks.dequeue();
+                SaveBacklog().set(mTasks.size());
             }
 
             if (task.image.isNull() || task.filePath.isEmpty()) {
                 continue;
             }
 
+            static auto &saveTime = MetricsRegistry::instance().histogram("save.task_us");
+            MetricTimer timer(saveTime);
+
             QDir dir(QFileInfo(task.filePath).absolutePath());
             if (!dir.exists()) {
                 dir.mkpath(".");
             }
 
+            if (!task.overlay.empty()) {
+                task.image = RasterizeDetectOverlay(task.image, task.overlay);
+            }
             if (!task.image.save(task.filePath)) {
+                static auto &failed = MetricsRegistry::instance().counter("save.failed");
+                failed.add();
                 LOG_F(ERROR, "Failed to save AI result image to %s", task.filePath.toStdString().c_str());
                 continue;
             }
@@ -136,10 +160,14 @@ namespace TF {
                 }
             }
 
+            task.trace.mark(TraceStage::Saved);
+
             // 所有文件保存完成后，再发布ZMQ结果（保证订阅端收到消息时文件已落盘）
             if (task.publishZmq) {
                 DataPubZmqManager::instance().publishResult(task.zmqResult);
+                task.trace.mark(TraceStage::Published);
             }
+            LatencyTracer::instance().finish(task.trace, task.sourceFlag);
         }
 
         QMutexLocker locker(&mMutex);
@@ -247,30 +275,31 @@ namespace TF {
         return mRecentRecords;
     }
 
-    void AiResultSaveManager::submitResult(const QImage &detImage,
-                                           const QImage &oriImage,
+    bool AiResultSaveManager::submitResult(const QImage &oriImage,
+                                           const DetectOverlay &overlay,
                                            const QImage &fireMaskImage,
                                            const QString &sourceFlag,
                                            int timeCost,
                                            int detectionId,
                                            std::size_t detectedCount,
                                            float fireHeight,
-                                           float fireArea) {
+                                           float fireArea,
+                                           const FrameTrace &trace) {
         if (!mEnabled.load()) {
-            return;
+            return false;
         }
 
         if (!TFDetectManager::instance().isDetecting()) {
-            return;
+            return false;
         }
 
         if (!shouldSaveNow()) {
-            return;
+            return false;
         }
 
         auto record = ExperimentParamManager::instance().prepareSample(fireHeight, fireArea);
         if (!record.has_value()) {
-            return;
+            return false;
         }
 
         ensureWorker();
@@ -279,7 +308,7 @@ namespace TF {
         }
 
         if (!mWorker) {
-            return;
+            return false;
         }
 
         const QString detFilePath = record->imagePath.isEmpty()
@@ -311,11 +340,11 @@ namespace TF {
         zmqResult.maxTemp = thermalCam ? static_cast<float>(thermalCam->latestMaxTemp()) : 0.0f;
         zmqResult.minTemp = thermalCam ? static_cast<float>(thermalCam->latestMinTemp()) : 0.0f;
 
-        mWorker->enqueue(detImage, detFilePath, description,
+        mWorker->enqueue(oriImage, detFilePath, description,
                          irImage, record->irImgPath,
                          irRawData, record->irDatPath,
                          fireMaskImage, record->fireMaskPath,
-                         true, zmqResult);
+                         true, zmqResult, overlay, trace, sourceFlag);
 
         if (!oriImage.isNull() && !record->oriImagePath.isEmpty()) {
             mWorker->enqueue(oriImage, record->oriImagePath,
@@ -323,6 +352,7 @@ namespace TF {
         }
 
         recordMeta(detFilePath, description);
+        return true;
     }
 }
 
@@ -13,6 +13,8 @@
 
 #include "TSingleton.h"
 #include "DataPubZmqManager.h"
+#include "DetectOverlay.h"
+#include "LatencyTracer.h"
 
 namespace TF {
     struct AiResultMetaInfo
@@ -32,7 +34,10 @@ namespace TF {
                      const QByteArray& irRawData = {}, const QString& irDatPath = {},
                      const QImage& fireMask = {}, const QString& fireMaskPath = {},
                      bool publishZmq = false,
-                     const InnerFlameDetectResult& zmqResult = {});
+                     const InnerFlameDetectResult& zmqResult = {},
+                     const DetectOverlay& overlay = {},
+                     const FrameTrace& trace = {},
+                     const QString& sourceFlag = {});
 
     public slots:
         void startWork();
@@ -44,6 +49,8 @@ namespace TF {
             QImage image;
             QString filePath;
             QString description;
+            // 非空时保存前绘制到 image 上（_det 图像）
+            DetectOverlay overlay;
             // 红外数据
             QImage irImage;
             QString irImgPath;
@@ -55,6 +62,9 @@ namespace TF {
             // 文件保存完成后发布ZMQ
             bool publishZmq{false};
             InnerFlameDetectResult zmqResult;
+            // 发布后交给延时追踪
+            FrameTrace trace;
+            QString sourceFlag;
         };
 
         QMutex mMutex;
@@ -78,15 +88,18 @@ namespace TF {
 
         [[nodiscard]] int saveFrequency() const { return mSaveFrequency.load(); }
 
-        void submitResult(const QImage& detImage,
-                          const QImage& oriImage,
+        // The _det image is oriImage with the overlay painted on, rasterized by the save thread.
+        // Returns true when the frame was queued, the save thread then finishes its trace.
+        bool submitResult(const QImage& oriImage,
+                          const DetectOverlay& overlay,
                           const QImage& fireMaskImage,
                           const QString& sourceFlag,
                           int timeCost,
                           int detectionId,
                           std::size_t detectedCount,
                           float fireHeight,
-                          float fireArea);
+                          float fireArea,
+                          const FrameTrace& trace = {});
 
         [[nodiscard]] std::vector<AiResultMetaInfo> recentRecords() const;
 
@@ -0,0 +1,339 @@
+#include "AnnotatedVideoManager.h"
+
+#include <algorithm>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#include "DetectorWorkerManager.h"
+#include "ffmpeginclude.h"
+#include "TConfig.h"
+#include "TLog.h"
+
+
+namespace TF {
+
+    static std::string FFmpegError(int err) {
+        char buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+        av_strerror(err, buf, sizeof(buf));
+        return buf;
+    }
+
+    AnnotatedVideoWorker::AnnotatedVideoWorker(const AnnotatedVideoParams &params, const QString &filePath)
+        : mParams(params), mFilePath(filePath) {
+        // Set before the thread starts, a stop that comes ahead of startWork must not be lost
+        mRunning.store(true);
+    }
+
+    AnnotatedVideoWorker::~AnnotatedVideoWorker() {
+        close();
+    }
+
+    bool AnnotatedVideoWorker::enqueue(const QImage &image, const DetectOverlay &overlay, qint64 timestampMs) {
+        QMutexLocker locker(&mMutex);
+        if (mFrames.size() >= std::max(1, mParams.queueSize)) {
+            return false;
+        }
+        // QImage is implicitly shared, the frame is not copied here
+        mFrames.enqueue({image, overlay, timestampMs});
+        mCond.wakeOne();
+        return true;
+    }
+
+    void AnnotatedVideoWorker::startWork() {
+        while (true) {
+            Frame frame;
+            {
+                QMutexLocker locker(&mMutex);
+                while (mRunning.load() && mFrames.isEmpty()) {
+                    mCond.wait(&mMutex);
+                }
+
+                // Frames already queued are still written after stop
+                if (mFrames.isEmpty()) {
+                    break;
+                }
+                frame = mFrames.dequeue();
+            }
+
+            if (!mOpenFailed) {
+                encode(frame);
+            }
+        }
+
+        close();
+    }
+
+    void AnnotatedVideoWorker::stopWork() {
+        QMutexLocker locker(&mMutex);
+        mRunning.store(false);
+        mCond.wakeAll();
+    }
+
+    bool AnnotatedVideoWorker::open(const QSize &size) {
+        // yuv420p needs even dimensions
+        const int width = size.width() & ~1;
+        const int height = size.height() & ~1;
+        if (width <= 0 || height <= 0) {
+            return false;
+        }
+
+        const bool hevc = mParams.codec.compare("h265", Qt::CaseInsensitive) == 0 ||
+                          mParams.codec.compare("hevc", Qt::CaseInsensitive) == 0;
+        const char *encoderName = hevc ? "libx265" : "libx264";
+        const AVCodec *codec = avcodec_find_encoder_by_name(encoderName);
+        if (!codec) {
+            LOG_F(ERROR, "Annotated video: encoder %s is not available", encoderName);
+            return false;
+        }
+
+        QDir().mkpath(QFileInfo(mFilePath).absolutePath());
+        const QByteArray path = mFilePath.toUtf8();
+        int ret = avformat_alloc_output_context2(&mFormatCtx, nullptr, "mp4", path.constData());
+        if (ret < 0 || !mFormatCtx) {
+            LOG_F(ERROR, "Annotated video: failed to create %s, %s", path.constData(), FFmpegError(ret).c_str());
+            return false;
+        }
+
+        mCodecCtx = avcodec_alloc_context3(codec);
+        mCodecCtx->width = width;
+        mCodecCtx->height = height;
+        mCodecCtx->pix_fmt = AV_PIX_FMT_YUV420P;
+        // Millisecond timestamps keep the real timing when frames are dropped
+        mCodecCtx->time_base = AVRational{1, 1000};
+        mCodecCtx->framerate = AVRational{std::max(1, mParams.fps), 1};
+        mCodecCtx->gop_size = std::max(1, mParams.fps) * 2;
+        if (mFormatCtx->oformat->flags & AVFMT_GLOBALHEADER) {
+            mCodecCtx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+        }
+
+        AVDictionary *options = nullptr;
+        av_dict_set(&options, "preset", mParams.preset.toUtf8().constData(), 0);
+        av_dict_set_int(&options, "crf", mParams.crf, 0);
+        if (hevc) {
+            av_dict_set(&options, "x265-params", "log-level=error", 0);
+        }
+        ret = avcodec_open2(mCodecCtx, codec, &options);
+        av_dict_free(&options);
+        if (ret < 0) {
+            LOG_F(ERROR, "Annotated video: failed to open %s, %s", encoderName, FFmpegError(ret).c_str());
+            return false;
+        }
+
+        mStream = avformat_new_stream(mFormatCtx, nullptr);
+        mStream->time_base = mCodecCtx->time_base;
+        avcodec_parameters_from_context(mStream->codecpar, mCodecCtx);
+        if (hevc) {
+            // hvc1 plays in QuickTime/browsers as well, hev1 only in ffmpeg based players
+            mStream->codecpar->codec_tag = MKTAG('h', 'v', 'c', '1');
+        }
+
+        ret = avio_open(&mFormatCtx->pb, path.constData(), AVIO_FLAG_WRITE);
+        if (ret < 0) {
+            LOG_F(ERROR, "Annotated video: failed to open %s, %s", path.constData(), FFmpegError(ret).c_str());
+            return false;
+        }
+        ret = avformat_write_header(mFormatCtx, nullptr);
+        if (ret < 0) {
+            LOG_F(ERROR, "Annotated video: failed to write header, %s", FFmpegError(ret).c_str());
+            return false;
+        }
+        mHeaderWritten = true;
+
+        mFrame = av_frame_alloc();
+        mFrame->format = mCodecCtx->pix_fmt;
+        mFrame->width = width;
+        mFrame->height = height;
+        ret = av_frame_get_buffer(mFrame, 0);
+        if (ret < 0) {
+            LOG_F(ERROR, "Annotated video: failed to allocate the frame, %s", FFmpegError(ret).c_str());
+            return false;
+        }
+        mPacket = av_packet_alloc();
+
+        LOG_F(INFO, "Annotated video: %s %dx%d %d fps crf %d -> %s", encoderName, width, height,
+              mParams.fps, mParams.crf, path.constData());
+        return true;
+    }
+
+    void AnnotatedVideoWorker::encode(const Frame &frame) {
+        QImage image = frame.overlay.empty() ? frame.image : RasterizeDetectOverlay(frame.image, frame.overlay);
+        if (image.isNull()) {
+            return;
+        }
+        if (image.format() != QImage::Format_RGB32) {
+            image = image.convertToFormat(QImage::Format_RGB32);
+        }
+
+        if (!mCodecCtx) {
+            if (!open(image.size())) {
+                mOpenFailed = true;
+                close();
+                return;
+            }
+        }
+
+        // Later frames of another size are scaled to the size the stream was opened with
+        mSwsCtx = sws_getCachedContext(mSwsCtx, image.width(), image.height(), AV_PIX_FMT_RGB32,
+                                       mCodecCtx->width, mCodecCtx->height, AV_PIX_FMT_YUV420P,
+                                       SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!mSwsCtx || av_frame_make_writable(mFrame) < 0) {
+            return;
+        }
+
+        const uint8_t *src[1] = {image.constBits()};
+        const int srcStride[1] = {static_cast<int>(image.bytesPerLine())};
+        sws_scale(mSwsCtx, src, srcStride, 0, image.height(), mFrame->data, mFrame->linesize);
+
+        if (mFirstTimestampMs < 0) {
+            mFirstTimestampMs = frame.timestampMs;
+        }
+        const qint64 pts = std::max(frame.timestampMs - mFirstTimestampMs, mLastPts + 1);
+        mLastPts = pts;
+        mFrame->pts = pts;
+        writePackets(mFrame);
+        ++mEncodedCount;
+    }
+
+    void AnnotatedVideoWorker::writePackets(AVFrame *frame) {
+        int ret = avcodec_send_frame(mCodecCtx, frame);
+        if (ret < 0) {
+            LOG_F(ERROR, "Annotated video: encode failed, %s", FFmpegError(ret).c_str());
+            return;
+        }
+
+        while ((ret = avcodec_receive_packet(mCodecCtx, mPacket)) >= 0) {
+            av_packet_rescale_ts(mPacket, mCodecCtx->time_base, mStream->time_base);
+            mPacket->stream_index = mStream->index;
+            ret = av_interleaved_write_frame(mFormatCtx, mPacket);
+            if (ret < 0) {
+                LOG_F(ERROR, "Annotated video: write failed, %s", FFmpegError(ret).c_str());
+            }
+        }
+    }
+
+    void AnnotatedVideoWorker::close() {
+        if (mHeaderWritten) {
+            writePackets(nullptr);
+            av_write_trailer(mFormatCtx);
+            mHeaderWritten = false;
+            LOG_F(INFO, "Annotated video: %lld frames written to %s", mEncodedCount,
+                  mFilePath.toStdString().c_str());
+        }
+
+        if (mSwsCtx) {
+            sws_freeContext(mSwsCtx);
+            mSwsCtx = nullptr;
+        }
+        if (mFrame) {
+            av_frame_free(&mFrame);
+        }
+        if (mPacket) {
+            av_packet_free(&mPacket);
+        }
+        if (mCodecCtx) {
+            avcodec_free_context(&mCodecCtx);
+        }
+        if (mFormatCtx) {
+            if (mFormatCtx->pb) {
+                avio_closep(&mFormatCtx->pb);
+            }
+            avformat_free_context(mFormatCtx);
+            mFormatCtx = nullptr;
+        }
+        mStream = nullptr;
+    }
+
+    AnnotatedVideoManager::AnnotatedVideoManager(QObject *parent) : QObject(parent) {
+    }
+
+    AnnotatedVideoManager::~AnnotatedVideoManager() {
+        stop();
+    }
+
+    void AnnotatedVideoManager::init() {
+        mParams.enabled = GET_BOOL_CONFIG("VisionMea", "AnnotatedVideoEnabled");
+        mParams.codec = QString::fromStdString(GET_STR_CONFIG("VisionMea", "AnnotatedVideoCodec"));
+        mParams.fps = std::max(1, GET_INT_CONFIG("VisionMea", "AnnotatedVideoFps"));
+        mParams.crf = GET_INT_CONFIG("VisionMea", "AnnotatedVideoCrf");
+        mParams.preset = QString::fromStdString(GET_STR_CONFIG("VisionMea", "AnnotatedVideoPreset"));
+        mParams.queueSize = std::max(1, GET_INT_CONFIG("VisionMea", "AnnotatedVideoQueue"));
+    }
+
+    void AnnotatedVideoManager::start(const QString &dir) {
+        if (!mParams.enabled || mRunning.exchange(true)) {
+            return;
+        }
+
+        const QString fileName = QString("annotated_%1.mp4")
+                                     .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+        mThread = new QThread;
+        mWorker = new AnnotatedVideoWorker(mParams, QDir(dir).filePath(fileName));
+        mWorker->moveToThread(mThread);
+
+        connect(mThread, &QThread::started, mWorker, &AnnotatedVideoWorker::startWork, Qt::QueuedConnection);
+        connect(mThread, &QThread::finished, mWorker, &QObject::deleteLater);
+        connect(mThread, &QThread::finished, mThread, &QObject::deleteLater);
+
+        // The detector output reaches this object queued, DetectorWorker never waits on the encoder
+        mFrameConnection = connect(&DetectorWorkerManager::instance(), &DetectorWorkerManager::frameProcessed,
+                                   this, &AnnotatedVideoManager::submitFrame);
+
+        mNextDueMs = 0;
+        mAcceptedCount = 0;
+        mRateDropCount = 0;
+        mQueueDropCount = 0;
+        mThread->start();
+    }
+
+    void AnnotatedVideoManager::stop() {
+        if (!mRunning.exchange(false)) {
+            return;
+        }
+
+        disconnect(mFrameConnection);
+
+        if (mWorker) {
+            mWorker->stopWork();
+        }
+        if (mThread) {
+            mThread->quit();
+            mThread->wait();
+        }
+
+        mWorker = nullptr;
+        mThread = nullptr;
+
+        LOG_F(INFO, "Annotated video stopped: %lld frames queued, %lld skipped for the %d fps target, "
+                    "%lld dropped while the encoder was behind",
+              mAcceptedCount, mRateDropCount, mParams.fps, mQueueDropCount);
+    }
+
+    void AnnotatedVideoManager::submitFrame(const QString &sourceFlag, const QImage &image,
+                                            const DetectOverlay &overlay, double meanValue, int timeCost) {
+        Q_UNUSED(sourceFlag);
+        Q_UNUSED(meanValue);
+        Q_UNUSED(timeCost);
+
+        if (!mRunning.load() || !mWorker || image.isNull()) {
+            return;
+        }
+
+        // Keep the cadence while frames arrive in time, restart it after a gap
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        const qint64 interval = 1000 / mParams.fps;
+        if (mNextDueMs > 0 && now < mNextDueMs) {
+            ++mRateDropCount;
+            return;
+        }
+        mNextDueMs = (mNextDueMs > 0 && now - mNextDueMs < interval) ? mNextDueMs + interval : now + interval;
+
+        if (mWorker->enqueue(image, overlay, now)) {
+            ++mAcceptedCount;
+        }
+        else {
+            ++mQueueDropCount;
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <QImage>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+
+#include "TSingleton.h"
+#include "DetectOverlay.h"
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVPacket;
+struct AVStream;
+struct SwsContext;
+
+namespace TF {
+
+    struct AnnotatedVideoParams {
+        bool enabled{false};
+        QString codec{"h264"};          // h264 -> libx264, h265 -> libx265
+        int fps{10};                    // target output rate, faster input is dropped
+        int crf{28};
+        QString preset{"veryfast"};
+        int queueSize{8};               // frames waiting for the encoder, a full queue drops the frame
+    };
+
+    // Software H.264/H.265 encoder for the annotated detector output, the overlay is
+    // rasterized here so the caller only hands over the shared frame and vector data
+    class AnnotatedVideoWorker : public QObject {
+        Q_OBJECT
+
+    public:
+        explicit AnnotatedVideoWorker(const AnnotatedVideoParams &params, const QString &filePath);
+
+        ~AnnotatedVideoWorker() override;
+
+        // Never blocks, returns false when the queue is full and the frame was dropped
+        bool enqueue(const QImage &image, const DetectOverlay &overlay, qint64 timestampMs);
+
+    public slots:
+        void startWork();
+        void stopWork();
+
+    private:
+        struct Frame {
+            QImage image;
+            DetectOverlay overlay;
+            qint64 timestampMs{0};
+        };
+
+        bool open(const QSize &size);
+        void encode(const Frame &frame);
+        void writePackets(AVFrame *frame);
+        void close();
+
+        AnnotatedVideoParams mParams;
+        QString mFilePath;
+
+        QMutex mMutex;
+        QWaitCondition mCond;
+        QQueue<Frame> mFrames;
+        std::atomic<bool> mRunning{false};
+
+        AVFormatContext *mFormatCtx{nullptr};
+        AVCodecContext *mCodecCtx{nullptr};
+        AVStream *mStream{nullptr};
+        AVFrame *mFrame{nullptr};
+        AVPacket *mPacket{nullptr};
+        SwsContext *mSwsCtx{nullptr};
+        bool mHeaderWritten{false};
+        bool mOpenFailed{false};
+        qint64 mFirstTimestampMs{-1};
+        qint64 mLastPts{-1};
+        qint64 mEncodedCount{0};
+    };
+
+    class AnnotatedVideoManager : public QObject, public TBase::TSingleton<AnnotatedVideoManager> {
+        Q_OBJECT
+
+    public:
+        void init();
+
+        [[nodiscard]] bool isEnabled() const { return mParams.enabled; }
+
+        [[nodiscard]] bool isRunning() const { return mRunning.load(); }
+
+        // Starts an annotated_<time>.mp4 in dir and follows the detector output until stop()
+        void start(const QString &dir);
+
+        void stop();
+
+    public slots:
+        void submitFrame(const QString &sourceFlag, const QImage &image, const TF::DetectOverlay &overlay,
+                         double meanValue, int timeCost);
+
+    private:
+        friend class TBase::TSingleton<AnnotatedVideoManager>;
+        explicit AnnotatedVideoManager(QObject *parent = nullptr);
+
+        ~AnnotatedVideoManager() override;
+
+        AnnotatedVideoParams mParams;
+
+        QThread *mThread{nullptr};
+        AnnotatedVideoWorker *mWorker{nullptr};
+        std::atomic<bool> mRunning{false};
+        QMetaObject::Connection mFrameConnection;
+
+        qint64 mNextDueMs{0};
+        qint64 mAcceptedCount{0};
+        qint64 mRateDropCount{0};
+        qint64 mQueueDropCount{0};
+    };
+}
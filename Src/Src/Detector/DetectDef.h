@@ -50,8 +50,35 @@ namespace TF {
         "火焰",
     };
 
+    // Fallback model input, the actual size comes from the model or VisionMea/InputSize
     static const int TF_DETECT_IMG_SIZE = 640;
 
+    // Wall time spent in each inference stage, ms
+    typedef struct _InferStageTimes {
+        double preprocessMs{0.0};   // color conversion, resize, blob
+        double inferMs{0.0};        // session run
+        double decodeMs{0.0};       // box decoding and NMS
+        double maskMs{0.0};         // prototype mask assembly
+    } InferStageTimes;
+
+    // Sliced (tiled) inference for frames much larger than the model input
+    typedef struct _SliceParam {
+        bool enabled{false};
+        int tileSize{TF_DETECT_IMG_SIZE};   // tile edge in source pixels
+        int stride{512};                    // tile step, < tileSize gives overlap
+        bool globalPass{true};              // also run one downscaled full-frame pass
+        float mergeIou{0.5f};               // same-class boxes above this IoU are merged
+        float mergeIos{0.6f};               // or above this intersection-over-smaller (cut flames)
+    } SliceParam;
+
+    // Native-resolution re-inference around known flames
+    typedef struct _RoiParam {
+        bool enabled{false};
+        float expand{2.0f};                 // crop edge relative to the flame's longer side
+        int minSize{TF_DETECT_IMG_SIZE};    // crops are never smaller than this
+        int fullFrameInterval{5};           // every N-th detector run still covers the full frame
+    } RoiParam;
+
     typedef struct _Detection {
         int class_id{0};
         std::string className{};
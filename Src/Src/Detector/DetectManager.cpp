@@ -15,6 +15,7 @@
 #include "TLog.h"
 #include "TCvMatQImage.h"
 #include "TConfig.h"
+#include <algorithm>
 #include <chrono>
 
 
@@ -26,8 +27,30 @@ namespace TF {
     }
 
 
+    // [ModelRegistry] holds parallel lists, entry i is Names[i] with DetModes[i], ModelPaths[i], ...
+    static bool LoadRegistrySpec(const std::string& name, DetectorSpec& spec) {
+        std::size_t num = 0;
+        TBase::TConfig::instance().getSeqNodeLen({"ModelRegistry", "Names"}, num);
+        for (std::size_t i = 0; i < num; ++i) {
+            if (GET_ARR_STR_CONFIG(i, "ModelRegistry", "Names") != name) {
+                continue;
+            }
+            spec.name = name;
+            spec.detMode = GET_ARR_STR_CONFIG(i, "ModelRegistry", "DetModes");
+            spec.modelPath = GET_ARR_STR_CONFIG(i, "ModelRegistry", "ModelPaths");
+            spec.confThreshold = GET_ARR_FLOAT_CONFIG(i, "ModelRegistry", "ConfThresholds");
+            spec.iouThreshold = GET_ARR_FLOAT_CONFIG(i, "ModelRegistry", "IouThresholds");
+            return true;
+        }
+        return false;
+    }
+
+
     TFDetectManager::~TFDetectManager() {
         stopDetect();
+        if (mSwapThread.joinable()) {
+            mSwapThread.join();
+        }
     }
 
     bool TFDetectManager::init() {
@@ -36,17 +59,161 @@ namespace TF {
             return true;
         }
 
+        if (mLoadState.exchange(DetectorLoadState::Loading) != DetectorLoadState::Loading) {
+            mLoadStart = std::chrono::steady_clock::now();
+        }
+
         mNeedPrintDebugInfo = GET_BOOL_CONFIG("RGBCam", "NeedPrintDebugInfo");
         mNeedSaveOriImg = GET_BOOL_CONFIG("RGBCam", "NeedSaveOriImg");
 
-        mDetector = new Detector();
-        mInitialized = mDetector->init();
-        LOG_F(INFO, "TbDetectManager init finished, ret %d.", static_cast<int>(mInitialized));
+        auto detector = std::make_shared<Detector>();
+        const bool ret = detector->init();
+        if (ret) {
+            installDetector(std::move(detector));
+        }
+        mInitialized = ret;
+
+        mLoadMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - mLoadStart).count();
+        mLoadState = ret ? DetectorLoadState::Ready : DetectorLoadState::Failed;
+        LOG_F(INFO, "TbDetectManager init finished, ret %d, %lld ms.", static_cast<int>(ret),
+              static_cast<long long>(mLoadMs.load()));
         return mInitialized;
     }
 
-    void TFDetectManager::startDetect() {
+    int64_t TFDetectManager::loadElapsedMs() const {
+        if (mLoadState.load() == DetectorLoadState::Loading) {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - mLoadStart).count();
+        }
+        return mLoadMs.load();
+    }
+
+    std::shared_ptr<Detector> TFDetectManager::activeDetector() const {
+        std::lock_guard<std::mutex> lock(mDetectorMutex);
+        return mDetector;
+    }
+
+    void TFDetectManager::installDetector(std::shared_ptr<Detector> detector) {
+        std::lock_guard<std::mutex> lock(mDetectorMutex);
+        // The model before the previous one is released once its last frame finishes
+        mPrevDetector = std::move(mDetector);
+        mDetector = std::move(detector);
+        ++mModelGeneration;
+    }
+
+    std::vector<std::string> TFDetectManager::registeredModels() const {
+        std::vector<std::string> names{"default"};
+        std::size_t num = 0;
+        TBase::TConfig::instance().getSeqNodeLen({"ModelRegistry", "Names"}, num);
+        for (std::size_t i = 0; i < num; ++i) {
+            names.emplace_back(GET_ARR_STR_CONFIG(i, "ModelRegistry", "Names"));
+        }
+        return names;
+    }
+
+    bool TFDetectManager::swapModelAsync(const std::string& name) {
+        DetectorSpec spec;
+        if (name == "default") {
+            spec = LoadDefaultDetectorSpec();
+        }
+        else if (!LoadRegistrySpec(name, spec)) {
+            LOG_F(ERROR, "[TbDetectManager::swapModelAsync] Model %s not in ModelRegistry.", name.c_str());
+            return false;
+        }
+        return swapModelAsync(spec);
+    }
+
+    bool TFDetectManager::swapModelAsync(const DetectorSpec& spec) {
         if (!mInitialized) {
+            LOG_F(ERROR, "[TbDetectManager::swapModelAsync] TbDetectManager not initialized.");
+            return false;
+        }
+        bool expected = false;
+        if (!mSwapLoading.compare_exchange_strong(expected, true)) {
+            LOG_F(WARNING, "[TbDetectManager::swapModelAsync] Another model is loading, %s ignored.", spec.name.c_str());
+            return false;
+        }
+        if (mSwapThread.joinable()) {
+            mSwapThread.join();
+        }
+
+        // Detection keeps running on the current model until the new one is warm
+        mSwapThread = std::thread([this, spec]() {
+            const auto start = std::chrono::steady_clock::now();
+            auto detector = std::make_shared<Detector>();
+            bool ret = false;
+            try {
+                ret = detector->init(spec);
+                if (ret) {
+                    detector->warmUp();
+                }
+            }
+            catch (const std::exception& ex) {
+                LOG_F(ERROR, "[TbDetectManager::swapModelAsync] Load model %s failed, %s.", spec.name.c_str(), ex.what());
+                ret = false;
+            }
+
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (ret) {
+                installDetector(std::move(detector));
+                LOG_F(INFO, "Model %s (%s %s) swapped in after %lld ms.", spec.name.c_str(), spec.detMode.c_str(),
+                      spec.modelPath.c_str(), static_cast<long long>(ms));
+            }
+            else {
+                LOG_F(ERROR, "Model %s failed to load after %lld ms, keeping %s.", spec.name.c_str(),
+                      static_cast<long long>(ms), activeModelName().c_str());
+            }
+            mSwapLoading = false;
+        });
+        return true;
+    }
+
+    bool TFDetectManager::rollbackModel() {
+        std::lock_guard<std::mutex> lock(mDetectorMutex);
+        if (mPrevDetector == nullptr) {
+            LOG_F(WARNING, "[TbDetectManager::rollbackModel] No previous model to roll back to.");
+            return false;
+        }
+        std::swap(mDetector, mPrevDetector);
+        ++mModelGeneration;
+        LOG_F(INFO, "Model rolled back to %s.", mDetector->spec().name.c_str());
+        return true;
+    }
+
+    std::string TFDetectManager::activeModelName() const {
+        auto detector = activeDetector();
+        return detector == nullptr ? std::string() : detector->spec().name;
+    }
+
+    std::vector<ModelLatencyStats> TFDetectManager::modelLatencyStats() const {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        std::vector<ModelLatencyStats> stats;
+        stats.reserve(mLatencyStats.size());
+        for (const auto& [name, stat] : mLatencyStats) {
+            stats.push_back(stat);
+        }
+        return stats;
+    }
+
+    void TFDetectManager::recordLatency(const Detector& detector, std::chrono::steady_clock::time_point start) {
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        auto& stat = mLatencyStats[detector.spec().name];
+        stat.name = detector.spec().name;
+        stat.frames++;
+        stat.meanMs += (ms - stat.meanMs) / static_cast<double>(stat.frames);
+        stat.maxMs = std::max(stat.maxMs, ms);
+        stat.lastMs = ms;
+    }
+
+    void TFDetectManager::startDetect() {
+        if (mLoadState.load() == DetectorLoadState::Loading) {
+            LOG_F(INFO, "[TbDetectManager::startDetect] Detector still loading (%lld ms), detection starts when ready.",
+                  static_cast<long long>(loadElapsedMs()));
+        }
+        else if (!mInitialized) {
             LOG_F(ERROR, "[TbDetectManager::onStartDetectBtnClicked] TbDetectManager not initialized.");
             return;
         }
@@ -61,7 +228,7 @@ namespace TF {
     }
 
     void TFDetectManager::stopDetect() {
-        if (!mInitialized) {
+        if (!mInitialized && mLoadState.load() != DetectorLoadState::Loading) {
             LOG_F(ERROR, "[TbDetectManager::onStopDetectBtnClicked] TbDetectManager not initialized.");
             return;
         }
@@ -83,54 +250,143 @@ namespace TF {
     bool TFDetectManager::runDetect(const std::string& im_path,
                                     std::size_t& detect_num,
                                     std::vector<Detection>& detections) {
-        if (mDetector == nullptr) {
+        auto detector = activeDetector();
+        if (detector == nullptr) {
             return false;
         }
 
         cv::Mat frame;
-        bool ret = mDetector->runDetect(im_path, detect_num, detections, frame);
+        bool ret = detector->runDetect(im_path, detect_num, detections, frame);
         return ret;
     }
 
     int TFDetectManager::runDetect(const cv::Mat& input_frame,
                                    size_t& detect_num,
                                    std::vector<Detection>& detections) {
-        if (mDetector == nullptr) {
-            return false;
+        auto detector = activeDetector();
+        if (detector == nullptr) {
+            return -1;
         }
 
-        bool ret = mDetector->runDetect(input_frame, detect_num, detections);
+        const auto start = std::chrono::steady_clock::now();
+        bool ret = detector->runDetect(input_frame, detect_num, detections);
+        recordLatency(*detector, start);
         if (ret) {
-            return ++mDetectedId;
+            return nextDetectionId();
+        }
+        return -1;
+    }
+
+    int TFDetectManager::runDetectScaled(const cv::Mat& model_frame,
+                                         const cv::Point2f& scale,
+                                         const cv::Size& frame_size,
+                                         std::size_t& detect_num,
+                                         std::vector<Detection>& detections) {
+        auto detector = activeDetector();
+        if (detector == nullptr) {
+            return -1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        bool ret = detector->runDetectScaled(model_frame, scale, frame_size, detect_num, detections);
+        recordLatency(*detector, start);
+        if (ret) {
+            return nextDetectionId();
         }
         return -1;
     }
 
     bool TFDetectManager::runDetectWithSlice(const cv::Mat& input_frame, size_t& detect_num,
                                              std::vector<Detection>& detections) {
-        if (mDetector == nullptr) {
+        auto detector = activeDetector();
+        if (detector == nullptr) {
             return false;
         }
 
-        bool ret = mDetector->runDetect(input_frame, detect_num, detections);
+        const auto start = std::chrono::steady_clock::now();
+        bool ret = detector->runDetectWithSlice(input_frame, detect_num, detections);
+        recordLatency(*detector, start);
         return ret;
     }
 
     int TFDetectManager::runDetectWithPreview(cv::Mat& input_frame,
                                               std::size_t& detect_num,
                                               std::vector<Detection>& detections) {
-        if (mDetector == nullptr) {
-            return false;
+        auto detector = activeDetector();
+        if (detector == nullptr) {
+            return -1;
         }
 
-        bool ret = mDetector->runDetectWithPreview(input_frame, detect_num, detections);
+        const auto start = std::chrono::steady_clock::now();
+        bool ret = detector->runDetectWithPreview(input_frame, detect_num, detections);
+        recordLatency(*detector, start);
         if (ret) {
-            mDetectedId = mDetectedId + 1;
-            return mDetectedId;
+            return nextDetectionId();
         }
         return -1;
     }
 
+    int TFDetectManager::runDetectInRois(const cv::Mat& input_frame,
+                                         const std::vector<cv::Rect>& rois,
+                                         std::size_t& detect_num,
+                                         std::vector<Detection>& detections) {
+        auto detector = activeDetector();
+        if (detector == nullptr) {
+            return -1;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        bool ret = detector->runDetectInRois(input_frame, rois, detect_num, detections);
+        recordLatency(*detector, start);
+        if (ret) {
+            return nextDetectionId();
+        }
+        return -1;
+    }
+
+    int TFDetectManager::nextDetectionId() {
+        const int id = ++mDetectedId;
+        if (id == 1) {
+            LOG_F(INFO, "First detection %lld ms after detector load start.",
+                  static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - mLoadStart).count()));
+        }
+        return id;
+    }
+
+    void TFDetectManager::drawDetections(cv::Mat& frame, const std::vector<Detection>& detections) {
+        Detector::drawDetections(frame, detections);
+    }
+
+    bool TFDetectManager::setInputSize(int size) {
+        auto detector = activeDetector();
+        if (detector == nullptr) {
+            return false;
+        }
+        return detector->setInputSize(size);
+    }
+
+    int TFDetectManager::inputSize() const {
+        auto detector = activeDetector();
+        return detector == nullptr ? TF_DETECT_IMG_SIZE : detector->inputSize();
+    }
+
+    int TFDetectManager::decodeScaleSize() const {
+        // Tiles are cut from the full-resolution frame
+        if (GET_BOOL_CONFIG("VisionMea", "SliceEnabled")) {
+            return 0;
+        }
+        return std::max(0, GET_INT_CONFIG("VisionMea", "DecodeScaleSize"));
+    }
+
+    std::vector<int> TFDetectManager::supportedInputSizes() const {
+        auto detector = activeDetector();
+        if (detector == nullptr) {
+            return {};
+        }
+        return detector->supportedInputSizes();
+    }
+
     /*
     cv::Scalar CLASS_COLORS[TF_CLASS_NUM] = {
         cv::Scalar(0, 255, 0), // TB_INTRODUCTION_DEVICE 0
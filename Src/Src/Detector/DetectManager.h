@@ -14,6 +14,10 @@
 #include "TSingleton.h"
 #include "DetectDef.h"
 #include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <string>
 #include <vector>
@@ -32,6 +36,23 @@ namespace TF {
 
     class Detector;
 
+    struct DetectorSpec;
+
+    struct ModelLatencyStats {
+        std::string name;
+        uint64_t frames{0};
+        double meanMs{0.0};
+        double maxMs{0.0};
+        double lastMs{0.0};
+    };
+
+    enum class DetectorLoadState {
+        Idle,
+        Loading,
+        Ready,
+        Failed
+    };
+
     class TFDetectManager : public TBase::TSingleton<TFDetectManager>
     {
     public:
@@ -39,6 +60,33 @@ namespace TF {
 
         bool init();
 
+        DetectorLoadState loadState() const { return mLoadState.load(); }
+
+        // Time the last load took, or has taken so far while loading
+        int64_t loadElapsedMs() const;
+
+        // Models listed in [ModelRegistry], plus "default" for the VisionMea model
+        std::vector<std::string> registeredModels() const;
+
+        // Loads and warms up the named model on a background thread, then swaps it in
+        // between two frames; the replaced model is kept for rollbackModel().
+        // False when the name is unknown or another swap is still loading.
+        bool swapModelAsync(const std::string& name);
+
+        bool swapModelAsync(const DetectorSpec& spec);
+
+        // Swaps the previous model back in instantly
+        bool rollbackModel();
+
+        bool isSwapLoading() const { return mSwapLoading; }
+
+        std::string activeModelName() const;
+
+        // Bumped on every swap, callers caching model properties (input sizes) reload on change
+        int modelGeneration() const { return mModelGeneration; }
+
+        std::vector<ModelLatencyStats> modelLatencyStats() const;
+
         void startDetect();
 
         void stopDetect();
@@ -59,6 +107,13 @@ namespace TF {
                       std::size_t& detect_num,
                       std::vector<Detection>& detections);
 
+        // Detects on the decoder-scaled frame, results in full-frame coordinates
+        int runDetectScaled(const cv::Mat& model_frame,
+                            const cv::Point2f& scale,
+                            const cv::Size& frame_size,
+                            std::size_t& detect_num,
+                            std::vector<Detection>& detections);
+
         bool runDetectWithSlice(const cv::Mat& input_frame,
                                 std::size_t& detect_num,
                                 std::vector<Detection>& detections);
@@ -67,6 +122,24 @@ namespace TF {
                                  std::size_t& detect_num,
                                  std::vector<Detection>& detections);
 
+        // Detects inside rois only, nothing is painted; returns the detection id or -1
+        int runDetectInRois(const cv::Mat& input_frame,
+                            const std::vector<cv::Rect>& rois,
+                            std::size_t& detect_num,
+                            std::vector<Detection>& detections);
+
+        void drawDetections(cv::Mat& frame, const std::vector<Detection>& detections);
+
+        bool setInputSize(int size);
+
+        int inputSize() const;
+
+        // Edge of the square frame the decoder scales for detection, 0 when detection needs
+        // the full frame (VisionMea/DecodeScaleSize is 0 or slicing is on)
+        int decodeScaleSize() const;
+
+        std::vector<int> supportedInputSizes() const;
+
         cv::Scalar generateClassColor(int class_id);
 
         std::string getDefectNamesByIds(const std::set<int>& class_ids);
@@ -76,6 +149,15 @@ namespace TF {
         bool needSaveOriImg() { return mNeedSaveOriImg; }
 
     private:
+        // Frames hold their own reference, a swap never pulls the model out from under a running frame
+        std::shared_ptr<Detector> activeDetector() const;
+
+        void installDetector(std::shared_ptr<Detector> detector);
+
+        void recordLatency(const Detector& detector, std::chrono::steady_clock::time_point start);
+
+        int nextDetectionId();
+
         bool mNeedPrintDebugInfo{false};
 
         bool mNeedSaveOriImg{false};
@@ -87,7 +169,21 @@ namespace TF {
 
         std::atomic<int> mDetectedId{0};
 
-        Detector* mDetector{nullptr};
+        std::atomic<DetectorLoadState> mLoadState{DetectorLoadState::Idle};
+        std::chrono::steady_clock::time_point mLoadStart{};
+        std::atomic<int64_t> mLoadMs{-1};
+
+        mutable std::mutex mDetectorMutex;
+        std::shared_ptr<Detector> mDetector;
+        std::shared_ptr<Detector> mPrevDetector;
+        std::atomic<int> mModelGeneration{0};
+
+        std::atomic<bool> mSwapLoading{false};
+        std::thread mSwapThread;
+
+        mutable std::mutex mStatsMutex;
+        std::map<std::string, ModelLatencyStats> mLatencyStats;
+
         std::thread mThread;
     };
 };
@@ -0,0 +1,68 @@
+#include "DetectOverlay.h"
+
+#include <QPainter>
+#include <QPen>
+#include <QVector>
+
+namespace TF {
+
+    namespace {
+        const int BoxLineWidth = 4;
+
+        // Detection colors are OpenCV BGR scalars
+        QColor ToQColor(const cv::Scalar &color) {
+            return QColor(static_cast<int>(color[2]), static_cast<int>(color[1]), static_cast<int>(color[0]));
+        }
+    }
+
+    DetectOverlay MakeDetectOverlay(const std::vector<Detection> &detections, const cv::Size &frameSize) {
+        DetectOverlay overlay;
+        overlay.frameSize = QSize(frameSize.width, frameSize.height);
+        overlay.items.reserve(detections.size());
+
+        const cv::Rect frameRect(0, 0, frameSize.width, frameSize.height);
+        for (const auto &det : detections) {
+            OverlayItem item;
+            item.box = QRect(det.box.x, det.box.y, det.box.width, det.box.height);
+            item.color = ToQColor(det.color);
+
+            // Masks are zero outside their box, only the box crop is kept
+            const cv::Rect roi = det.box & frameRect;
+            if (!det.mask.empty() && det.mask.size() == frameSize && roi.area() > 0) {
+                const cv::Mat crop = det.mask(roi);
+                QImage mask(crop.data, crop.cols, crop.rows, static_cast<int>(crop.step), QImage::Format_Indexed8);
+                QVector<QRgb> colorTable(256, item.color.rgb());
+                colorTable[0] = qRgba(0, 0, 0, 0);
+                mask.setColorTable(colorTable);
+                item.mask = mask.copy();
+                item.maskOrigin = QPoint(roi.x, roi.y);
+            }
+            overlay.items.emplace_back(std::move(item));
+        }
+        return overlay;
+    }
+
+    void PaintDetectOverlay(QPainter &painter, const DetectOverlay &overlay) {
+        painter.save();
+        painter.setBrush(Qt::NoBrush);
+        for (const auto &item : overlay.items) {
+            if (!item.mask.isNull()) {
+                painter.drawImage(item.maskOrigin, item.mask);
+            }
+            painter.setPen(QPen(item.color, BoxLineWidth));
+            painter.drawRect(item.box);
+        }
+        painter.restore();
+    }
+
+    QImage RasterizeDetectOverlay(const QImage &frame, const DetectOverlay &overlay) {
+        if (overlay.empty() || frame.isNull()) {
+            return frame;
+        }
+        QImage annotated = frame.convertToFormat(QImage::Format_RGB32);
+        QPainter painter(&annotated);
+        PaintDetectOverlay(painter, overlay);
+        painter.end();
+        return annotated;
+    }
+}
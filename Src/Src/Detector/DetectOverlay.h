@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QColor>
+#include <QImage>
+#include <QMetaType>
+#include <QPoint>
+#include <QRect>
+#include <QSize>
+#include <vector>
+
+#include "DetectDef.h"
+
+class QPainter;
+
+namespace TF {
+
+    struct OverlayItem {
+        QRect box;
+        QColor color;
+        QImage mask;             // Indexed8 crop of the mask, index 0 transparent, the rest the item color
+        QPoint maskOrigin;
+    };
+
+    // Detection results as vector data in frame pixel coordinates. The view paints them
+    // over the frame at display time and the save path rasterizes them only for the
+    // _det images, so the frame itself is never modified.
+    struct DetectOverlay {
+        QSize frameSize;
+        std::vector<OverlayItem> items;
+
+        bool empty() const { return items.empty(); }
+    };
+
+    DetectOverlay MakeDetectOverlay(const std::vector<Detection> &detections, const cv::Size &frameSize);
+
+    // Same look as Detector::drawDetections, the painter works in frame pixel coordinates
+    void PaintDetectOverlay(QPainter &painter, const DetectOverlay &overlay);
+
+    QImage RasterizeDetectOverlay(const QImage &frame, const DetectOverlay &overlay);
+}
+
+Q_DECLARE_METATYPE(TF::DetectOverlay)
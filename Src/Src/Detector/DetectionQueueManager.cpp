@@ -3,11 +3,17 @@
 #include <QMutexLocker>
 
 #include "TCvMatQImage.h"
+#include "MetricsRegistry.h"
 
 namespace TF {
 
     namespace {
         const int MaxQueueSize = 5;
+
+        MetricGauge &QueueDepth() {
+            static auto &depth = MetricsRegistry::instance().gauge("detect.queue.depth");
+            return depth;
+        }
     }
 
     void DetectionQueueManager::start() {
@@ -23,7 +29,13 @@ namespace TF {
         mCond.wakeAll();
     }
 
-    void DetectionQueueManager::enqueue(const QString &sourceFlag, const QImage &image, int timeCost) {
+    void DetectionQueueManager::enqueue(const QString &sourceFlag, const QImage &image, int timeCost,
+                                        const FrameTrace &trace) {
+        enqueue(sourceFlag, image, QImage(), timeCost, trace);
+    }
+
+    void DetectionQueueManager::enqueue(const QString &sourceFlag, const QImage &image, const QImage &modelImage,
+                                        int timeCost, const FrameTrace &trace) {
         if (!mRunning.load()) {
             return;
         }
@@ -32,20 +44,33 @@ namespace TF {
             return;
         }
 
-        cv::Mat safeMat = QtOcv::image2Mat(image, CV_8UC3).clone();
-        if (safeMat.empty()) {
+        DetectionTask task;
+        task.sourceFlag = sourceFlag;
+        task.timeCost = timeCost;
+        task.trace = trace;
+        task.image = QtOcv::image2Mat(image, CV_8UC3).clone();
+        if (task.image.empty()) {
             return;
         }
+        if (!modelImage.isNull() && modelImage.width() > 0 && modelImage.height() > 0) {
+            task.modelImage = QtOcv::image2Mat(modelImage, CV_8UC3).clone();
+            task.modelScale = {static_cast<float>(image.width()) / static_cast<float>(modelImage.width()),
+                               static_cast<float>(image.height()) / static_cast<float>(modelImage.height())};
+        }
+        task.trace.mark(TraceStage::Queued);
 
         QMutexLocker locker(&mMutex);
         if (mTasks.size() >= MaxQueueSize) {
+            static auto &dropped = MetricsRegistry::instance().counter("detect.queue.dropped");
+            dropped.add();
             mTasks.dequeue();
         }
 
         // Store a copied cv::Mat to avoid referencing buffers that might be
         // released once playback stops, while skipping a second deep copy
         // when the worker converts the frame.
-        mTasks.enqueue({sourceFlag, std::move(safeMat), timeCost});
+        mTasks.enqueue(std::move(task));
+        QueueDepth().set(mTasks.size());
         mCond.wakeOne();
     }
 
@@ -60,6 +85,7 @@ namespace TF {
         }
 
         task = mTasks.dequeue();
+        QueueDepth().set(mTasks.size());
         return true;
     }
 }
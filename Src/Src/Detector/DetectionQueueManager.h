@@ -10,13 +10,19 @@
 #include <opencv2/core.hpp>
 
 #include "TSingleton.h"
+#include "LatencyTracer.h"
 
 namespace TF {
 
     struct DetectionTask {
         QString sourceFlag;
         cv::Mat image;
+        // Frame the decoder scaled to the model input, empty when only the full frame was sent;
+        // modelScale maps its pixels back to image (image = modelImage * modelScale)
+        cv::Mat modelImage;
+        cv::Point2f modelScale{1.0f, 1.0f};
         int timeCost{0};
+        FrameTrace trace;
     };
 
     class DetectionQueueManager : public TBase::TSingleton<DetectionQueueManager> {
@@ -25,7 +31,10 @@ namespace TF {
 
         void stop();
 
-        void enqueue(const QString &sourceFlag, const QImage &image, int timeCost);
+        void enqueue(const QString &sourceFlag, const QImage &image, int timeCost, const FrameTrace &trace = {});
+
+        void enqueue(const QString &sourceFlag, const QImage &image, const QImage &modelImage, int timeCost,
+                     const FrameTrace &trace = {});
 
         bool waitAndPop(DetectionTask &task);
 
@@ -3,11 +3,17 @@
 #include "TCvMatQImage.h"
 #include "AiResultSaveManager.h"
 #include "TLog.h"
+#include "TConfig.h"
+#include "SliceInference.h"
+#include "MetricsRegistry.h"
 #include <QtGlobal>
+#include <algorithm>
 
 #include <opencv2/imgproc.hpp>
 
 #include "TFMeaManager.h"
+#include "ThermalManager.h"
+#include "DataPubZmqManager.h"
 
 
 namespace TF {
@@ -16,6 +22,15 @@ namespace TF {
 
     void DetectorWorker::startWork() {
         mRunning.store(true);
+        loadMotionGate();
+        loadTracker();
+        loadRoiParam();
+        mInputSizeGeneration = 0;
+        mFrameIndex = 0;
+        mDetectRunIndex = 0;
+        mLastDetections.clear();
+        mLastOverlay = {};
+        mLastPhysHeight = 0.0f;
         DetectionQueueManager::instance().start();
 
         DetectionTask task;
@@ -23,6 +38,7 @@ namespace TF {
             if (!DetectionQueueManager::instance().waitAndPop(task)) {
                 break;
             }
+            task.trace.mark(TraceStage::Dequeued);
             //processFrame(task);
             processDetect(task);
         }
@@ -33,6 +49,205 @@ namespace TF {
         DetectionQueueManager::instance().stop();
     }
 
+    void DetectorWorker::loadMotionGate() {
+        MotionGate::Params params;
+        params.enabled = GET_BOOL_CONFIG("VisionMea", "MotionGateEnabled");
+        params.pixelDiffThreshold = GET_INT_CONFIG("VisionMea", "MotionPixelDiff");
+        params.blockChangeRatio = GET_FLOAT_CONFIG("VisionMea", "MotionBlockRatio");
+        params.minIntervalMs = GET_INT_CONFIG("VisionMea", "MotionMinIntervalMs");
+        params.holdMs = GET_INT_CONFIG("VisionMea", "MotionHoldMs");
+        mMotionGate.configure(params);
+    }
+
+    void DetectorWorker::loadTracker() {
+        FlameTracker::Params params;
+        params.enabled = GET_BOOL_CONFIG("VisionMea", "TrackEnabled");
+        params.detectInterval = GET_INT_CONFIG("VisionMea", "TrackDetectInterval");
+        params.matchIou = GET_FLOAT_CONFIG("VisionMea", "TrackMatchIou");
+        params.highScore = GET_FLOAT_CONFIG("VisionMea", "TrackHighScore");
+        params.minHits = GET_INT_CONFIG("VisionMea", "TrackMinHits");
+        params.maxMisses = GET_INT_CONFIG("VisionMea", "TrackMaxMisses");
+        mTracker.configure(params);
+    }
+
+    void DetectorWorker::loadRoiParam() {
+        mRoi.enabled = GET_BOOL_CONFIG("VisionMea", "RoiEnabled");
+        mRoi.expand = GET_FLOAT_CONFIG("VisionMea", "RoiExpand");
+        mRoi.minSize = GET_INT_CONFIG("VisionMea", "RoiMinSize");
+        mRoi.fullFrameInterval = std::max(1, GET_INT_CONFIG("VisionMea", "RoiFullFrameInterval"));
+    }
+
+    void DetectorWorker::loadInputSizePolicy() {
+        auto& config = TBase::TConfig::instance();
+        InputSizePolicy::Params params;
+        params.defaultSize = GET_INT_CONFIG("VisionMea", "InputSize");
+        if (params.defaultSize <= 0) {
+            params.defaultSize = TFDetectManager::instance().inputSize();
+        }
+        params.adaptive = GET_BOOL_CONFIG("VisionMea", "InputAdaptive");
+        params.budgetMs = GET_INT_CONFIG("VisionMea", "InputBudgetMs");
+
+        std::size_t ladder_num = 0;
+        config.getSeqNodeLen({"VisionMea", "InputSizeLadder"}, ladder_num);
+        for (std::size_t i = 0; i < ladder_num; ++i) {
+            params.ladder.push_back(GET_ARR_INT_CONFIG(i, "VisionMea", "InputSizeLadder"));
+        }
+        params.ladder.push_back(params.defaultSize);
+
+        // StreamInputSizes[i] applies to the stream whose source flag is StreamInputFlags[i]
+        std::size_t flag_num = 0;
+        std::size_t size_num = 0;
+        config.getSeqNodeLen({"VisionMea", "StreamInputFlags"}, flag_num);
+        config.getSeqNodeLen({"VisionMea", "StreamInputSizes"}, size_num);
+        if (flag_num != size_num) {
+            LOG_F(WARNING, "StreamInputFlags (%zu) and StreamInputSizes (%zu) differ, per-stream sizes ignored.",
+                  flag_num, size_num);
+            flag_num = 0;
+        }
+        for (std::size_t i = 0; i < flag_num; ++i) {
+            const int size = GET_ARR_INT_CONFIG(i, "VisionMea", "StreamInputSizes");
+            params.streamSizes[GET_ARR_STR_CONFIG(i, "VisionMea", "StreamInputFlags")] = size;
+            params.ladder.push_back(size);
+        }
+        mInputSize.configure(params, TFDetectManager::instance().supportedInputSizes());
+    }
+
+    std::vector<cv::Rect> DetectorWorker::focusRois(const cv::Size& frameSize) {
+        if (!mRoi.enabled) {
+            return {};
+        }
+        // Periodic full-frame run so flames outside the current crops are still found
+        if (mDetectRunIndex++ % mRoi.fullFrameInterval == 0) {
+            return {};
+        }
+
+        std::vector<cv::Rect> boxes;
+        if (mTracker.params().enabled) {
+            int primaryTrackId = -1;
+            boxes = trackBoxes(primaryTrackId);
+        }
+        else {
+            for (const auto& detection : mLastDetections) {
+                boxes.push_back(detection.box);
+            }
+        }
+        return MakeFocusRois(boxes, frameSize, mRoi.expand, mRoi.minSize);
+    }
+
+    std::vector<cv::Rect> DetectorWorker::trackBoxes(int& primaryTrackId) const {
+        std::vector<cv::Rect> boxes;
+        int maxArea = 0;
+        primaryTrackId = -1;
+        for (const auto& track : mTracker.confirmedTracks()) {
+            boxes.push_back(track.box);
+            if (track.box.area() > maxArea) {
+                maxArea = track.box.area();
+                primaryTrackId = track.id;
+            }
+        }
+        return boxes;
+    }
+
+    FlameFrameMetrics DetectorWorker::updateMeasurements(const std::vector<cv::Rect>& boxes, int primaryTrackId) {
+        float max_height = 0.0f;
+        float max_width = 0.0f;
+        float max_area = 0.0f;
+        cv::Rect largestBbox;
+        for (const auto& box : boxes) {
+            auto box_height = static_cast<float>(box.height);
+            auto box_width = static_cast<float>(box.width);
+            max_height = max_height > box_height ? max_height : box_height;
+            max_width = max_width > box_width ? max_width : box_width;
+
+            auto area = static_cast<float>(box.height * box.width);
+            if (area > max_area) {
+                max_area = area;
+                largestBbox = box;
+            }
+        }
+
+        FlameFrameMetrics metrics;
+        metrics.primaryTrackId = primaryTrackId;
+        metrics.dist = TFMeaManager::instance().currentDist();
+        if (metrics.dist < 0.1f) {
+            metrics.dist = 12.0f;
+        }
+        double phys_w, phys_h;
+        TFMeaManager::instance().pixelToPhysical(metrics.dist, max_width, max_height, phys_w, phys_h);
+        auto phys_w_f = static_cast<float>(phys_w);
+        metrics.height = static_cast<float>(phys_h);
+        metrics.area = phys_w_f * metrics.height;
+
+        TFMeaManager::instance().calcHRR(metrics.area, metrics.hrr);
+
+        // Update flame state and bbox atomically under one lock
+        TFMeaManager::instance().updateFlameResult(!boxes.empty(), largestBbox);
+        TFMeaManager::instance().receiveStatistics({
+            metrics.height, metrics.area, metrics.hrr
+        });
+        return metrics;
+    }
+
+    void DetectorWorker::publishLive(int64_t frameId, std::size_t detectNum, const FlameFrameMetrics& metrics) {
+        if (!DataPubZmqManager::instance().isLiveEnabled()) {
+            return;
+        }
+
+        FlameLiveResult live;
+        live.frameId = frameId;
+        live.detectNum = static_cast<int32_t>(detectNum);
+        live.fireHeight = metrics.height;
+        live.fireArea = metrics.area;
+        live.hrr = metrics.hrr;
+        live.distance = metrics.dist;
+        live.tiltAngle = TFMeaManager::instance().currentTiltAngle();
+        live.trackId = metrics.primaryTrackId;
+        auto* thermalCam = ThermalManager::instance().getThermalCamera();
+        if (thermalCam && thermalCam->isRunning()) {
+            live.maxTemp = static_cast<float>(thermalCam->latestMaxTemp());
+            live.minTemp = static_cast<float>(thermalCam->latestMinTemp());
+        }
+        DataPubZmqManager::instance().publishLive(live);
+    }
+
+    void DetectorWorker::processPredicted(const DetectionTask& task) {
+        mTracker.predict(task.image.size());
+
+        int primaryTrackId = -1;
+        const auto boxes = trackBoxes(primaryTrackId);
+        const auto metrics = updateMeasurements(boxes, primaryTrackId);
+        // Keeps the live rate at the frame rate between detector runs
+        publishLive(-1, boxes.size(), metrics);
+
+        // Masks are not predicted, only the tracked boxes are drawn
+        std::vector<Detection> predicted;
+        for (const auto& track : mTracker.confirmedTracks()) {
+            Detection det;
+            det.class_id = track.classId;
+            det.confidence = track.confidence;
+            det.color = TFDetectManager::instance().generateClassColor(track.classId);
+            det.box = track.box;
+            predicted.emplace_back(std::move(det));
+        }
+
+        mLastPhysHeight = metrics.height;
+        emit frameProcessed(task.sourceFlag, QtOcv::mat2Image(task.image),
+                            MakeDetectOverlay(predicted, task.image.size()), metrics.height, task.timeCost);
+        finishTrace(task);
+    }
+
+    void DetectorWorker::processSkipped(const DetectionTask& task) {
+        emit frameProcessed(task.sourceFlag, QtOcv::mat2Image(task.image), mLastOverlay, mLastPhysHeight,
+                            task.timeCost);
+        finishTrace(task);
+    }
+
+    void DetectorWorker::finishTrace(const DetectionTask& task) {
+        FrameTrace trace = task.trace;
+        trace.mark(TraceStage::Processed);
+        LatencyTracer::instance().finish(trace, task.sourceFlag);
+    }
+
     void DetectorWorker::processFrame(const DetectionTask& task) {
         if (task.image.empty()) {
             return;
@@ -48,7 +263,7 @@ namespace TF {
         const double mean = (meanScalar[0] + meanScalar[1] + meanScalar[2]) / 3.0;
 
         QImage preview = QtOcv::mat2Image(task.image);
-        emit frameProcessed(task.sourceFlag, preview, mean, task.timeCost);
+        emit frameProcessed(task.sourceFlag, preview, DetectOverlay{}, mean, task.timeCost);
     }
 
     void DetectorWorker::processDetect(const DetectionTask& task) {
@@ -63,19 +278,55 @@ namespace TF {
                 return;
             }
 
-            std::chrono::high_resolution_clock::time_point start;
-            if (TFDetectManager::instance().needPrintDebugInfo()) {
-                start = std::chrono::high_resolution_clock::now();
+            // The gate only looks at a thumbnail, the decoder-scaled frame is enough
+            if (!mMotionGate.shouldInfer(task.modelImage.empty() ? task.image : task.modelImage)) {
+                static auto &skipped = MetricsRegistry::instance().counter("detect.frames.skipped");
+                skipped.add();
+                processSkipped(task);
+                return;
             }
 
-            cv::Mat cv_im = task.image;
-            QImage q_ori = QtOcv::mat2Image(cv_im);
+            // With no confirmed flame the detector runs every frame so new flames are picked up at once
+            if (mTracker.params().enabled) {
+                const bool detectFrame = (mFrameIndex++ % mTracker.params().detectInterval) == 0;
+                if (!detectFrame && mTracker.hasConfirmedTracks()) {
+                    static auto &predicted = MetricsRegistry::instance().counter("detect.frames.predicted");
+                    predicted.add();
+                    processPredicted(task);
+                    return;
+                }
+            }
+
+            // Rebuilt once the model has loaded and after every model swap
+            const int generation = TFDetectManager::instance().modelGeneration();
+            if (generation != mInputSizeGeneration) {
+                loadInputSizePolicy();
+                mInputSizeGeneration = generation;
+            }
+            const std::string stream = task.sourceFlag.toStdString();
+            // Generation 0: no detector installed yet, the frame passes through undetected
+            if (mInputSizeGeneration != 0) {
+                TFDetectManager::instance().setInputSize(mInputSize.sizeFor(stream));
+            }
+
+            const auto start = std::chrono::high_resolution_clock::now();
 
             size_t detect_num = 0;
             std::vector<Detection> detections;
             int detectionId = -1;
             try {
-                detectionId = TFDetectManager::instance().runDetectWithPreview(cv_im, detect_num, detections);
+                const auto rois = focusRois(task.image.size());
+                if (rois.empty() && !task.modelImage.empty()) {
+                    detectionId = TFDetectManager::instance().runDetectScaled(task.modelImage, task.modelScale,
+                                                                              task.image.size(), detect_num,
+                                                                              detections);
+                }
+                else if (rois.empty()) {
+                    detectionId = TFDetectManager::instance().runDetect(task.image, detect_num, detections);
+                }
+                else {
+                    detectionId = TFDetectManager::instance().runDetectInRois(task.image, rois, detect_num, detections);
+                }
             }
             catch (const cv::Exception& e) {
                 LOG_F(ERROR, "Object detect inference failed: %s.", e.what());
@@ -87,47 +338,47 @@ namespace TF {
                 LOG_F(ERROR, "Object detect inference failed.");
             }
 
+            const auto elapsed = std::chrono::high_resolution_clock::now() - start;
+            const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
+            static auto &inferTime = MetricsRegistry::instance().histogram("detect.infer_us");
+            static auto &inferred = MetricsRegistry::instance().counter("detect.frames.inferred");
+            static auto &failed = MetricsRegistry::instance().counter("detect.frames.failed");
+            inferTime.record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+            if (detectionId >= 0) {
+                inferred.add();
+            }
+            else {
+                failed.add();
+            }
+            FrameTrace trace = task.trace;
+            trace.mark(TraceStage::Inferred);
+            if (detectionId >= 0) {
+                mInputSize.report(stream, static_cast<int>(duration.count()));
+            }
             if (TFDetectManager::instance().needPrintDebugInfo()) {
-                auto end = std::chrono::high_resolution_clock::now();
-                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-                std::cout << "Detect time " << duration.count() << " ms, detect_num " << detect_num << std::endl;
-            }
-
-            float max_height = 0.0f;
-            float max_width = 0.0f;
-            float max_area = 0.0f;
-            cv::Rect largestBbox;
-            for (const auto& detection : detections) {
-                auto box_height = static_cast<float>(detection.box.height);
-                auto box_width = static_cast<float>(detection.box.width);
-                max_height = max_height > box_height ? max_height : box_height;
-                max_width = max_width > box_width ? max_width : box_width;
-
-                auto area = static_cast<float>(detection.box.height * detection.box.width);
-                if (area > max_area) {
-                    max_area = area;
-                    largestBbox = detection.box;
-                }
+                std::cout << "Detect time " << duration.count() << " ms, input " << TFDetectManager::instance().inputSize()
+                          << ", detect_num " << detect_num << std::endl;
             }
 
-            auto dist = TFMeaManager::instance().currentDist();
-            if (dist < 0.1f) {
-                dist = 12.0f;
+            std::vector<cv::Rect> flameBoxes;
+            int primaryTrackId = -1;
+            if (mTracker.params().enabled && detectionId >= 0) {
+                mTracker.update(detections, task.image.size());
+                flameBoxes = trackBoxes(primaryTrackId);
             }
-            double phys_w, phys_h;
-            TFMeaManager::instance().pixelToPhysical(dist, max_width, max_height, phys_w, phys_h);
-            auto phys_w_f = static_cast<float>(phys_w);
-            auto phys_h_f = static_cast<float>(phys_h);
-            auto phys_area = phys_w_f * phys_h_f;
-
-            float hrr = 0.0f;
-            TFMeaManager::instance().calcHRR(phys_area, hrr);
+            else {
+                for (const auto& detection : detections) {
+                    flameBoxes.push_back(detection.box);
+                }
+            }
+            const auto metrics = updateMeasurements(flameBoxes, primaryTrackId);
+            const float phys_h_f = metrics.height;
+            const float phys_area = metrics.area;
 
-            // Update flame state and bbox atomically under one lock
-            TFMeaManager::instance().updateFlameResult(detect_num > 0, largestBbox);
-            TFMeaManager::instance().receiveStatistics({
-                phys_h_f, phys_area, hrr
-            });
+            // 逐帧实时发布测量结果，与图像保存（受 SaveFreq 限制）解耦
+            if (detectionId >= 0) {
+                publishLive(detectionId, detect_num, metrics);
+            }
 
             // 合成火焰分割掩膜：将所有检测到的火焰mask合并为一张单通道1位图像
             QImage fireMaskImage;
@@ -154,13 +405,24 @@ namespace TF {
                 fireMaskImage = gray.convertToFormat(QImage::Format_Mono);
             }
 
-            QImage q_im = QtOcv::mat2Image(cv_im);
+            // The frame is converted once; boxes and masks travel as overlay data
+            const QImage q_ori = QtOcv::mat2Image(task.image);
+            const DetectOverlay overlay = MakeDetectOverlay(detections, task.image.size());
+            trace.mark(TraceStage::Processed);
+            bool saving = false;
             if (detectionId >= 0) {
-                AiResultSaveManager::instance().submitResult(q_im, q_ori, fireMaskImage, task.sourceFlag, task.timeCost,
-                                                             detectionId, detect_num,
-                                                             phys_h_f, phys_area);
+                mLastDetections = detections;
+                mLastOverlay = overlay;
+                mLastPhysHeight = phys_h_f;
+                saving = AiResultSaveManager::instance().submitResult(q_ori, overlay, fireMaskImage, task.sourceFlag,
+                                                                      task.timeCost, detectionId, detect_num,
+                                                                      phys_h_f, phys_area, trace);
+            }
+            emit frameProcessed(task.sourceFlag, q_ori, overlay, phys_h_f, task.timeCost);
+            // Saved frames are finished by the save thread once the result is published
+            if (!saving) {
+                LatencyTracer::instance().finish(trace, task.sourceFlag);
             }
-            emit frameProcessed(task.sourceFlag, q_im, phys_h_f, task.timeCost);
         }
     }
 }
@@ -4,9 +4,22 @@
 #include <atomic>
 
 #include "DetectionQueueManager.h"
+#include "DetectDef.h"
+#include "DetectOverlay.h"
+#include "MotionGate.h"
+#include "FlameTracker.h"
+#include "InputSizePolicy.h"
 
 namespace TF {
 
+    struct FlameFrameMetrics {
+        float dist{0.0f};       // m
+        float height{0.0f};     // m
+        float area{0.0f};       // m^2
+        float hrr{0.0f};
+        int primaryTrackId{-1}; // track of the largest flame, -1 without tracker
+    };
+
     class DetectorWorker : public QObject {
     Q_OBJECT
 
@@ -16,7 +29,9 @@ namespace TF {
         ~DetectorWorker() override = default;
 
     signals:
-        void frameProcessed(const QString &sourceFlag, const QImage &image, double meanValue, int timeCost);
+        // image is the untouched frame, overlay the detections to paint over it
+        void frameProcessed(const QString &sourceFlag, const QImage &image, const TF::DetectOverlay &overlay,
+                            double meanValue, int timeCost);
 
     public slots:
         void startWork();
@@ -28,7 +43,46 @@ namespace TF {
 
         void processDetect(const DetectionTask &task);
 
+        // Static scene: show the frame with the last results, skip inference
+        void processSkipped(const DetectionTask &task);
+
+        // Between detector runs: advance the tracker and measure its predicted boxes
+        void processPredicted(const DetectionTask &task);
+
+        // Hands the trace of a frame that skipped inference or saving to the latency tracer
+        void finishTrace(const DetectionTask &task);
+
+        // Derives physical metrics from the flame boxes and pushes them to TFMeaManager
+        FlameFrameMetrics updateMeasurements(const std::vector<cv::Rect> &boxes, int primaryTrackId);
+
+        // Live ZMQ result of every measured frame, frameId < 0 for tracker-predicted frames
+        void publishLive(int64_t frameId, std::size_t detectNum, const FlameFrameMetrics &metrics);
+
+        std::vector<cv::Rect> trackBoxes(int &primaryTrackId) const;
+
+        // Crops around the known flames, empty when this run has to cover the full frame
+        std::vector<cv::Rect> focusRois(const cv::Size &frameSize);
+
+        void loadMotionGate();
+
+        void loadTracker();
+
+        void loadRoiParam();
+
+        void loadInputSizePolicy();
+
         std::atomic<bool> mRunning{false};
+
+        MotionGate mMotionGate;
+        FlameTracker mTracker;
+        uint64_t mFrameIndex{0};
+        RoiParam mRoi;
+        InputSizePolicy mInputSize;
+        int mInputSizeGeneration{0};    // model generation the policy was built for, 0 = none loaded yet
+        uint64_t mDetectRunIndex{0};
+        std::vector<Detection> mLastDetections;
+        DetectOverlay mLastOverlay;
+        float mLastPhysHeight{0.0f};
     };
 }
 
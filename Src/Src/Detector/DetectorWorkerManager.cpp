@@ -3,6 +3,7 @@
 #include <QMetaObject>
 
 #include "DetectionQueueManager.h"
+#include "LatencyTracer.h"
 
 namespace TF {
 
@@ -18,6 +19,7 @@ namespace TF {
             return;
         }
 
+        qRegisterMetaType<TF::DetectOverlay>();
         mThread = new QThread;
         mWorker = new DetectorWorker;
         mWorker->moveToThread(mThread);
@@ -35,6 +37,7 @@ namespace TF {
         if (mRunning.exchange(true)) {
             return;
         }
+        LatencyTracer::instance().reset();
 
         if (mThread && !mThread->isRunning()) {
             mThread->start();
@@ -56,6 +59,7 @@ namespace TF {
 
         mWorker = nullptr;
         mThread = nullptr;
+        LatencyTracer::instance().exportTrace();
     }
 
     DetectorWorker *DetectorWorkerManager::worker() const {
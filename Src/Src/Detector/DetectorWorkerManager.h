@@ -23,7 +23,8 @@ namespace TF {
         DetectorWorker *worker() const;
 
     signals:
-        void frameProcessed(const QString &sourceFlag, const QImage &image, double meanValue, int timeCost);
+        void frameProcessed(const QString &sourceFlag, const QImage &image, const TF::DetectOverlay &overlay,
+                            double meanValue, int timeCost);
 
         void stopWorker();
 
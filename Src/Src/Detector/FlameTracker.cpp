@@ -0,0 +1,187 @@
+#include "FlameTracker.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace TF {
+
+    namespace {
+        // State [cx, cy, w, h, vcx, vcy, vw, vh], measurement [cx, cy, w, h]
+        const int StateDim = 8;
+        const int MeasureDim = 4;
+
+        // Flames flicker frame to frame, so measurements are trusted less than
+        // for rigid objects; this is what smooths the height/area curves
+        const float PosProcessNoise = 1.0f;
+        const float VelProcessNoise = 0.05f;
+        const float MeasureNoise = 25.0f;
+    }
+
+    void FlameTracker::configure(const Params &params) {
+        mParams = params;
+        mParams.detectInterval = std::max(1, mParams.detectInterval);
+        reset();
+    }
+
+    void FlameTracker::reset() {
+        mTracks.clear();
+        mNextId = 1;
+    }
+
+    cv::KalmanFilter FlameTracker::createFilter(const cv::Rect &box) {
+        cv::KalmanFilter kf(StateDim, MeasureDim, 0, CV_32F);
+        cv::setIdentity(kf.transitionMatrix);
+        for (int i = 0; i < MeasureDim; ++i) {
+            kf.transitionMatrix.at<float>(i, i + MeasureDim) = 1.0f;
+        }
+        kf.measurementMatrix = cv::Mat::zeros(MeasureDim, StateDim, CV_32F);
+        for (int i = 0; i < MeasureDim; ++i) {
+            kf.measurementMatrix.at<float>(i, i) = 1.0f;
+        }
+
+        kf.processNoiseCov = cv::Mat::zeros(StateDim, StateDim, CV_32F);
+        for (int i = 0; i < StateDim; ++i) {
+            kf.processNoiseCov.at<float>(i, i) = i < MeasureDim ? PosProcessNoise : VelProcessNoise;
+        }
+        cv::setIdentity(kf.measurementNoiseCov, cv::Scalar::all(MeasureNoise));
+        cv::setIdentity(kf.errorCovPost, cv::Scalar::all(10.0f));
+        for (int i = MeasureDim; i < StateDim; ++i) {
+            kf.errorCovPost.at<float>(i, i) = 1000.0f;
+        }
+
+        kf.statePost = cv::Mat::zeros(StateDim, 1, CV_32F);
+        kf.statePost.at<float>(0) = static_cast<float>(box.x) + box.width * 0.5f;
+        kf.statePost.at<float>(1) = static_cast<float>(box.y) + box.height * 0.5f;
+        kf.statePost.at<float>(2) = static_cast<float>(box.width);
+        kf.statePost.at<float>(3) = static_cast<float>(box.height);
+        return kf;
+    }
+
+    cv::Rect FlameTracker::stateToBox(const cv::Mat &state, const cv::Size &frameSize) {
+        const float cx = state.at<float>(0);
+        const float cy = state.at<float>(1);
+        const float w = std::max(1.0f, state.at<float>(2));
+        const float h = std::max(1.0f, state.at<float>(3));
+        const cv::Rect box(cvRound(cx - w * 0.5f), cvRound(cy - h * 0.5f), cvRound(w), cvRound(h));
+        return box & cv::Rect(0, 0, frameSize.width, frameSize.height);
+    }
+
+    float FlameTracker::iou(const cv::Rect &a, const cv::Rect &b) {
+        const float inter = static_cast<float>((a & b).area());
+        if (inter <= 0.0f) {
+            return 0.0f;
+        }
+        return inter / static_cast<float>(a.area() + b.area() - inter);
+    }
+
+    void FlameTracker::predict(const cv::Size &frameSize) {
+        for (auto &track : mTracks) {
+            const cv::Mat state = track.kf.predict();
+            track.info.box = stateToBox(state, frameSize);
+        }
+    }
+
+    void FlameTracker::associate(const std::vector<const Detection *> &dets,
+                                 std::vector<bool> &trackMatched,
+                                 std::vector<const Detection *> &unmatched,
+                                 const cv::Size &frameSize) {
+        // Greedy matching on descending IoU; flame counts are small so this is
+        // as good as Hungarian in practice
+        std::vector<std::tuple<float, size_t, size_t>> pairs;
+        for (size_t t = 0; t < mTracks.size(); ++t) {
+            if (trackMatched[t]) continue;
+            for (size_t d = 0; d < dets.size(); ++d) {
+                if (dets[d]->class_id != mTracks[t].info.classId) continue;
+                const float v = iou(mTracks[t].info.box, dets[d]->box);
+                if (v >= mParams.matchIou) {
+                    pairs.emplace_back(v, t, d);
+                }
+            }
+        }
+        std::sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b) {
+            return std::get<0>(a) > std::get<0>(b);
+        });
+
+        std::vector<bool> detMatched(dets.size(), false);
+        for (const auto &[v, t, d] : pairs) {
+            if (trackMatched[t] || detMatched[d]) continue;
+            trackMatched[t] = true;
+            detMatched[d] = true;
+
+            auto &track = mTracks[t];
+            const cv::Rect &box = dets[d]->box;
+            cv::Mat measurement = (cv::Mat_<float>(MeasureDim, 1)
+                << box.x + box.width * 0.5f, box.y + box.height * 0.5f,
+                   static_cast<float>(box.width), static_cast<float>(box.height));
+            const cv::Mat state = track.kf.correct(measurement);
+            track.info.box = stateToBox(state, frameSize);
+            track.info.confidence = dets[d]->confidence;
+            track.info.hits++;
+            track.info.misses = 0;
+            if (track.info.hits >= mParams.minHits) {
+                track.info.confirmed = true;
+            }
+        }
+
+        for (size_t d = 0; d < dets.size(); ++d) {
+            if (!detMatched[d]) {
+                unmatched.push_back(dets[d]);
+            }
+        }
+    }
+
+    void FlameTracker::update(const std::vector<Detection> &detections, const cv::Size &frameSize) {
+        predict(frameSize);
+
+        std::vector<const Detection *> high;
+        std::vector<const Detection *> low;
+        for (const auto &det : detections) {
+            (det.confidence >= mParams.highScore ? high : low).push_back(&det);
+        }
+
+        std::vector<bool> trackMatched(mTracks.size(), false);
+        std::vector<const Detection *> unmatchedHigh;
+        std::vector<const Detection *> unmatchedLow;
+        associate(high, trackMatched, unmatchedHigh, frameSize);
+        associate(low, trackMatched, unmatchedLow, frameSize);
+
+        for (size_t t = 0; t < mTracks.size(); ++t) {
+            if (!trackMatched[t]) {
+                mTracks[t].info.misses++;
+            }
+        }
+        mTracks.erase(std::remove_if(mTracks.begin(), mTracks.end(), [&](const TrackState &track) {
+            // Unconfirmed tracks are dropped on their first miss
+            return track.info.misses > (track.info.confirmed ? mParams.maxMisses : 0);
+        }), mTracks.end());
+
+        // Only confident detections may start a track
+        for (const auto *det : unmatchedHigh) {
+            TrackState track;
+            track.info.id = mNextId++;
+            track.info.classId = det->class_id;
+            track.info.confidence = det->confidence;
+            track.info.box = det->box;
+            track.info.hits = 1;
+            track.info.confirmed = mParams.minHits <= 1;
+            track.kf = createFilter(det->box);
+            mTracks.emplace_back(std::move(track));
+        }
+    }
+
+    std::vector<FlameTrack> FlameTracker::confirmedTracks() const {
+        std::vector<FlameTrack> tracks;
+        for (const auto &track : mTracks) {
+            if (track.info.confirmed && track.info.box.area() > 0) {
+                tracks.push_back(track.info);
+            }
+        }
+        return tracks;
+    }
+
+    bool FlameTracker::hasConfirmedTracks() const {
+        return std::any_of(mTracks.begin(), mTracks.end(), [](const TrackState &track) {
+            return track.info.confirmed;
+        });
+    }
+}
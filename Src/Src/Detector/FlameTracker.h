@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/video/tracking.hpp>
+
+#include "DetectDef.h"
+
+namespace TF {
+
+    struct FlameTrack {
+        int id{0};
+        int classId{0};
+        float confidence{0.0f};
+        cv::Rect box{};          // Kalman-smoothed box in frame coordinates
+        int hits{0};             // matched detections so far
+        int misses{0};           // consecutive detection frames without a match
+        bool confirmed{false};
+    };
+
+    // IoU + constant-velocity Kalman tracker with ByteTrack-style two-stage
+    // association: confident detections are matched first, the rest may only
+    // extend existing tracks. Between detector runs the tracks are advanced by
+    // prediction alone, so measurements keep the frame rate while inference
+    // runs every K frames.
+    class FlameTracker {
+    public:
+        struct Params {
+            bool enabled{false};
+            int detectInterval{1};     // run the detector every K frames
+            float matchIou{0.3f};      // minimum IoU for a track/detection pair
+            float highScore{0.9f};     // first-stage confidence; lower ones only extend tracks
+            int minHits{2};            // hits before a track is reported
+            int maxMisses{10};         // detection frames a track survives unmatched
+        };
+
+        void configure(const Params &params);
+
+        const Params &params() const { return mParams; }
+
+        void reset();
+
+        // Detection frame: predict, associate, correct, spawn and retire tracks
+        void update(const std::vector<Detection> &detections, const cv::Size &frameSize);
+
+        // Frame without inference: advance every track by prediction only
+        void predict(const cv::Size &frameSize);
+
+        std::vector<FlameTrack> confirmedTracks() const;
+
+        bool hasConfirmedTracks() const;
+
+    private:
+        struct TrackState {
+            FlameTrack info;
+            cv::KalmanFilter kf;
+        };
+
+        static cv::KalmanFilter createFilter(const cv::Rect &box);
+
+        static cv::Rect stateToBox(const cv::Mat &state, const cv::Size &frameSize);
+
+        static float iou(const cv::Rect &a, const cv::Rect &b);
+
+        void associate(const std::vector<const Detection *> &dets,
+                       std::vector<bool> &trackMatched,
+                       std::vector<const Detection *> &unmatched,
+                       const cv::Size &frameSize);
+
+        Params mParams;
+        std::vector<TrackState> mTracks;
+        int mNextId{1};
+    };
+}
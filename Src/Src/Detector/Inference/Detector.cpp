@@ -10,16 +10,21 @@
 **************************************************************************/
 #include "Detector.h"
 #include "InferenceORT.h"
+#ifdef FIREAPP_WITH_TRT
 #include "InferenceTRT.h"
+#endif
+#include "SliceInference.h"
 #include "TSysUtils.h"
 #include "TFException.h"
 #include "TConfig.h"
 #include "TLog.h"
 
 #include <opencv2/opencv.hpp>
+#include <algorithm>
 
 
 namespace TF {
+#ifdef FIREAPP_WITH_TRT
     static cv::Scalar GetColorByClassId(int class_id) {
         static const cv::Scalar palette[] = {
             {255, 56, 56}, {255, 157, 151}, {255, 112, 31}, {255, 178, 29},
@@ -36,7 +41,7 @@ namespace TF {
     static std::vector<Detection> SegmentResToDetections(
         const trtyolo::SegmentRes& result,
         const cv::Size& origSize, // 原图大小：input_frame.size()
-        const cv::Size& inferSize, // 推理大小：cv::Size(640, 640)
+        const cv::Size& inferSize, // 推理大小：当前模型输入，如 cv::Size(640, 640)
         const std::vector<std::string>& labels,
         float mask_thresh = 0.5f
     ) {
@@ -150,14 +155,37 @@ namespace TF {
         }
         return detections;
     }
+#endif
+
+
+    DetectorSpec LoadDefaultDetectorSpec() {
+        DetectorSpec spec;
+        spec.name = "default";
+        spec.detMode = GET_STR_CONFIG("VisionMea", "DetMode");
+        spec.modelPath = spec.detMode == "TRT" ? GET_STR_CONFIG("TrtYolo", "EnginePath")
+                                               : GET_STR_CONFIG("VisionMea", "DetModelName");
+        return spec;
+    }
 
 
     Detector::Detector() {
     }
 
+    Detector::~Detector() {
+        delete mInfORT;
+#ifdef FIREAPP_WITH_TRT
+        delete mInfTRT;
+#endif
+    }
+
     bool Detector::init() {
+        return init(LoadDefaultDetectorSpec());
+    }
+
+    bool Detector::init(const DetectorSpec& spec) {
         bool ret = false;
-        mDetMode = GET_STR_CONFIG("VisionMea", "DetMode");
+        mSpec = spec;
+        mDetMode = spec.detMode;
         if (mDetMode == "ORT") {
             ret = initORT();
         }
@@ -167,11 +195,173 @@ namespace TF {
         else {
             TF_LOG_THROW_RUNTIME("[Detector::init] Invalid DetMode %s.", mDetMode.c_str());
         }
+        loadSliceParam();
+        if (ret) {
+#ifdef FIREAPP_WITH_TRT
+            mInputSize = mDetMode == "TRT" ? mInfTRT->defaultInputSize() : mInfORT->inputSize();
+#else
+            mInputSize = mInfORT->inputSize();
+#endif
+            LOG_F(INFO, "[Detector] Model %s default input size %d.", mSpec.name.c_str(), mInputSize);
+        }
         return ret;
     }
 
+    void Detector::warmUp() {
+        const cv::Mat blank = cv::Mat::zeros(mInputSize, mInputSize, CV_8UC3);
+        detectFrame(blank);
+        resetStageTimes();
+    }
+
+    void Detector::dropBelowThreshold(std::vector<Detection>& detections) const {
+        if (mSpec.confThreshold <= 0.0f) {
+            return;
+        }
+        detections.erase(std::remove_if(detections.begin(), detections.end(), [this](const Detection& det) {
+            return det.confidence < mSpec.confThreshold;
+        }), detections.end());
+    }
+
+    bool Detector::setInputSize(int size) {
+        if (size == mInputSize) {
+            return true;
+        }
+#ifdef FIREAPP_WITH_TRT
+        if (mDetMode == "TRT" && mInfTRT != nullptr) {
+            mInputSize = mInfTRT->resolveInputSize(size);
+            return mInputSize == size;
+        }
+#endif
+        if (mInfORT != nullptr) {
+            mInfORT->setInputSize(size);
+            mInputSize = mInfORT->inputSize();
+        }
+        return mInputSize == size;
+    }
+
+    std::vector<int> Detector::supportedInputSizes() const {
+#ifdef FIREAPP_WITH_TRT
+        if (mDetMode == "TRT" && mInfTRT != nullptr) {
+            return mInfTRT->inputSizes();
+        }
+#endif
+        if (mInfORT != nullptr && !mInfORT->dynamicInput()) {
+            return {mInfORT->inputSize()};
+        }
+        return {};
+    }
+
+    void Detector::loadSliceParam() {
+        mSlice.enabled = GET_BOOL_CONFIG("VisionMea", "SliceEnabled");
+        mSlice.tileSize = GET_INT_CONFIG("VisionMea", "SliceTileSize");
+        mSlice.stride = GET_INT_CONFIG("VisionMea", "SliceStride");
+        mSlice.globalPass = GET_BOOL_CONFIG("VisionMea", "SliceGlobalPass");
+        mSlice.mergeIou = GET_FLOAT_CONFIG("VisionMea", "SliceMergeIou");
+        mSlice.mergeIos = GET_FLOAT_CONFIG("VisionMea", "SliceMergeIos");
+
+        if (mSlice.tileSize <= 0) {
+            mSlice.tileSize = TF_DETECT_IMG_SIZE;
+        }
+        if (mSlice.stride <= 0 || mSlice.stride > mSlice.tileSize) {
+            mSlice.stride = mSlice.tileSize;
+        }
+        LOG_F(INFO, "[Detector] Slice inference %s, tile %d, stride %d, global pass %d.",
+              mSlice.enabled ? "enabled" : "disabled", mSlice.tileSize, mSlice.stride,
+              static_cast<int>(mSlice.globalPass));
+    }
+
+    InferStageTimes Detector::stageTimes() const {
+        if (mInfORT != nullptr) {
+            return mInfORT->stageTimes();
+        }
+        return {};
+    }
+
+    void Detector::resetStageTimes() {
+        if (mInfORT != nullptr) {
+            mInfORT->resetStageTimes();
+        }
+    }
+
+    std::vector<Detection> Detector::detectFrame(const cv::Mat& input_frame) {
+#ifdef FIREAPP_WITH_TRT
+        if (mDetMode == "TRT") {
+            std::vector<std::string> class_names;
+            class_names.emplace_back("fire");
+            auto result = mInfTRT->runInference(input_frame, mInputSize);
+
+            const cv::Size inferSize(mInputSize, mInputSize);
+            auto detections = SegmentResToDetections(result, input_frame.size(), inferSize, class_names, 0.5f);
+            dropBelowThreshold(detections);
+            return detections;
+        }
+#endif
+        return mInfORT->runInference(input_frame);
+    }
+
+    std::vector<Detection> Detector::detectInRects(const cv::Mat& input_frame, const std::vector<cv::Rect>& rects) {
+        std::vector<Detection> candidates;
+#ifdef FIREAPP_WITH_TRT
+        if (mDetMode == "TRT") {
+            // One engine call per batch of crops
+            std::vector<cv::Mat> crops;
+            crops.reserve(rects.size());
+            for (const auto& rect : rects) {
+                crops.emplace_back(input_frame(rect));
+            }
+
+            std::vector<std::string> class_names;
+            class_names.emplace_back("fire");
+            const cv::Size inferSize(mInputSize, mInputSize);
+            const auto results = mInfTRT->runInference(crops, mInputSize);
+            for (size_t i = 0; i < results.size() && i < rects.size(); ++i) {
+                auto rectDets = SegmentResToDetections(results[i], rects[i].size(), inferSize, class_names, 0.5f);
+                dropBelowThreshold(rectDets);
+                for (auto& det : rectDets) {
+                    ShiftDetectionToFrame(det, rects[i], input_frame.size());
+                    candidates.emplace_back(std::move(det));
+                }
+            }
+            return candidates;
+        }
+#endif
+        // The ORT session keeps per-call scale state, crops are run one after another
+        for (const auto& rect : rects) {
+            auto rectDets = mInfORT->runInference(input_frame(rect));
+            for (auto& det : rectDets) {
+                ShiftDetectionToFrame(det, rect, input_frame.size());
+                candidates.emplace_back(std::move(det));
+            }
+        }
+        return candidates;
+    }
+
+    std::vector<Detection> Detector::detectSliced(const cv::Mat& input_frame) {
+        const auto tiles = MakeSliceTiles(input_frame.size(), mSlice.tileSize, mSlice.stride);
+        if (tiles.size() <= 1) {
+            // Frame fits in one tile, slicing would only add the merge cost
+            return detectFrame(input_frame);
+        }
+
+        std::vector<Detection> candidates = detectInRects(input_frame, tiles);
+
+        if (mSlice.globalPass) {
+            // Large, near flames may span several tiles; the downscaled pass keeps them whole
+            auto globalDets = detectFrame(input_frame);
+            for (auto& det : globalDets) {
+                CropMaskToBox(det);
+                candidates.emplace_back(std::move(det));
+            }
+        }
+
+        // Masks stay box-sized through the merge, one full-frame mask per merged flame
+        auto detections = MergeSliceDetections(std::move(candidates), mSlice.mergeIou, mSlice.mergeIos);
+        ExpandMasksToFrame(detections, input_frame.size());
+        return detections;
+    }
+
     bool Detector::initORT() {
-        auto model_path = GET_STR_CONFIG("VisionMea", "DetModelName");
+        const auto& model_path = mSpec.modelPath;
         LOG_F(INFO, "Load detection model %s.", model_path.c_str());
 
         if (!TBase::fileExists(model_path)) {
@@ -180,6 +370,7 @@ namespace TF {
 
         try {
             mInfORT = new InferenceORT(model_path);
+            mInfORT->setThresholds(mSpec.confThreshold, mSpec.iouThreshold);
             LOG_F(INFO, "[TbDetector] TbInferenceORT model loaded.");
             return true;
         }
@@ -196,8 +387,12 @@ namespace TF {
     }
 
     bool Detector::initTRT() {
+#ifndef FIREAPP_WITH_TRT
+        LOG_F(ERROR, "[TbDetector] DetMode TRT requested, built without FIREAPP_WITH_TRT.");
+        return false;
+#else
         try {
-            mInfTRT = new InferenceTRT();
+            mInfTRT = new InferenceTRT(mSpec.modelPath);
             LOG_F(INFO, "[TbDetector] InferenceTRT model loaded.");
             return true;
         }
@@ -208,6 +403,7 @@ namespace TF {
             LOG_F(ERROR, "[TbDetector] InferenceTRT model load failed, unknown exception.");
         }
         return false;
+#endif
     }
 
     bool Detector::runDetect(const std::string& im_path, size_t& detect_num, std::vector<Detection>& detections,
@@ -269,7 +465,61 @@ namespace TF {
             return false;
         }
 
-        detections = mInfORT->runInference(input_frame);
+        detections = mSlice.enabled ? detectSliced(input_frame) : detectFrame(input_frame);
+        detect_num = detections.size();
+        return true;
+    }
+
+    bool Detector::runDetectScaled(const cv::Mat& model_frame,
+                                   const cv::Point2f& scale,
+                                   const cv::Size& frame_size,
+                                   size_t& detect_num,
+                                   std::vector<Detection>& detections) {
+        if (model_frame.empty() || frame_size.width <= 0 || frame_size.height <= 0) {
+            return false;
+        }
+
+        detections = detectFrame(model_frame);
+        for (auto& det : detections) {
+            ScaleDetectionToFrame(det, scale, frame_size);
+        }
+        detect_num = detections.size();
+        return true;
+    }
+
+    bool Detector::runDetectInRois(const cv::Mat& input_frame,
+                                   const std::vector<cv::Rect>& rois,
+                                   size_t& detect_num,
+                                   std::vector<Detection>& detections) {
+        if (input_frame.empty() || rois.empty()) {
+            return false;
+        }
+
+        try {
+            // Crops are cut from the full-resolution frame, so each flame gets the model's
+            // whole input instead of a few pixels of a downscaled frame
+            detections = MergeSliceDetections(detectInRects(input_frame, rois), mSlice.mergeIou, mSlice.mergeIos);
+            ExpandMasksToFrame(detections, input_frame.size());
+            detect_num = detections.size();
+            return true;
+        }
+        catch (const std::exception& ex) {
+            LOG_F(ERROR, "[TbDetector] Run ROI inference failed, %s.", ex.what());
+        }
+        catch (...) {
+            LOG_F(ERROR, "[TbDetector] Run ROI inference failed");
+        }
+        return false;
+    }
+
+    bool Detector::runDetectWithSlice(const cv::Mat& input_frame,
+                                      size_t& detect_num,
+                                      std::vector<Detection>& detections) {
+        if (input_frame.empty()) {
+            return false;
+        }
+
+        detections = detectSliced(input_frame);
         detect_num = detections.size();
         return true;
     }
@@ -282,42 +532,10 @@ namespace TF {
         }
 
         try {
-            if (mDetMode == "TRT") {
-                std::vector<std::string> class_names;
-                class_names.emplace_back("fire");
-                auto result = mInfTRT->runInference(input_frame);
-
-                const cv::Size inferSize(640, 640);
-                detections = SegmentResToDetections(result, input_frame.size(), inferSize, class_names, 0.5f);
-            }
-
-            if (mDetMode == "ORT") {
-                detections = mInfORT->runInference(input_frame);
-            }
+            detections = mSlice.enabled ? detectSliced(input_frame) : detectFrame(input_frame);
 
             detect_num = detections.size();
-
-            for (auto idx = 0; idx < detect_num; idx++) {
-                const auto& detection = detections[idx];
-
-                cv::Rect box = detection.box;
-                cv::Scalar color = detection.color;
-                if (!detection.mask.empty()) {
-                    cv::Mat maskColor(input_frame.size(), input_frame.type(), color);
-                    maskColor.copyTo(input_frame, detection.mask);
-                }
-                cv::rectangle(input_frame, box, color, 4);
-                /*
-                std::string classString = detection.className + ' ' + std::to_string(detection.confidence).substr(0, 4);
-                cv::Size textSize = cv::getTextSize(classString, cv::FONT_HERSHEY_DUPLEX, 1, 2, 0);
-                cv::Rect textBox(box.x, box.y - 40, textSize.width + 10, textSize.height + 20);
-
-                cv::rectangle(input_frame, textBox, color, cv::FILLED);
-                cv::putText(input_frame, classString,
-                            cv::Point(box.x + 5, box.y - 10),
-                            cv::FONT_HERSHEY_DUPLEX, 1,
-                            cv::Scalar(0, 0, 0), 2, 0);*/
-            }
+            drawDetections(input_frame, detections);
             return true;
         }
         catch (const std::exception& ex) {
@@ -331,4 +549,26 @@ namespace TF {
         }
         return false;
     }
+
+    void Detector::drawDetections(cv::Mat& frame, const std::vector<Detection>& detections) {
+        for (const auto& detection : detections) {
+            cv::Rect box = detection.box;
+            cv::Scalar color = detection.color;
+            if (!detection.mask.empty() && detection.mask.size() == frame.size()) {
+                cv::Mat maskColor(frame.size(), frame.type(), color);
+                maskColor.copyTo(frame, detection.mask);
+            }
+            cv::rectangle(frame, box, color, 4);
+            /*
+            std::string classString = detection.className + ' ' + std::to_string(detection.confidence).substr(0, 4);
+            cv::Size textSize = cv::getTextSize(classString, cv::FONT_HERSHEY_DUPLEX, 1, 2, 0);
+            cv::Rect textBox(box.x, box.y - 40, textSize.width + 10, textSize.height + 20);
+
+            cv::rectangle(frame, textBox, color, cv::FILLED);
+            cv::putText(frame, classString,
+                        cv::Point(box.x + 5, box.y - 10),
+                        cv::FONT_HERSHEY_DUPLEX, 1,
+                        cv::Scalar(0, 0, 0), 2, 0);*/
+        }
+    }
 };
@@ -22,13 +22,34 @@ namespace TF {
 
     class InferenceTRT;
 
+    // One loadable model: backend, weights and thresholds, see [ModelRegistry] in the config
+    struct DetectorSpec {
+        std::string name;
+        std::string detMode;            // ORT or TRT
+        std::string modelPath;          // onnx model for ORT, engine for TRT (built for TrtYolo/InputSize)
+        float confThreshold{0.0f};      // <= 0 keeps the backend's configured value
+        float iouThreshold{0.0f};       // ORT only, TRT engines have NMS built in
+    };
+
+    // The model described by VisionMea/DetMode, DetModelName and TrtYolo/EnginePath
+    DetectorSpec LoadDefaultDetectorSpec();
+
     class Detector {
 
     public:
         Detector();
 
+        ~Detector();
+
         bool init();
 
+        bool init(const DetectorSpec &spec);
+
+        const DetectorSpec &spec() const { return mSpec; }
+
+        // One inference on a blank frame so the first real frame after a swap pays no lazy setup
+        void warmUp();
+
         bool runDetect(const std::string &im_path,
                size_t &detect_num,
                std::vector<Detection> &detections,
@@ -42,14 +63,69 @@ namespace TF {
                        size_t &detect_num,
                        std::vector<Detection> &detections);
 
+        // Detects on a frame already scaled to (about) the model input; results are mapped back
+        // to the frame_size frame with frame = model_frame * scale. Slicing needs the full frame.
+        bool runDetectScaled(const cv::Mat &model_frame,
+                             const cv::Point2f &scale,
+                             const cv::Size &frame_size,
+                             size_t &detect_num,
+                             std::vector<Detection> &detections);
+
+        bool runDetectWithSlice(const cv::Mat &input_frame,
+                                size_t &detect_num,
+                                std::vector<Detection> &detections);
+
+        // Detects only inside rois (frame coordinates), the frame is left untouched
+        bool runDetectInRois(const cv::Mat &input_frame,
+                             const std::vector<cv::Rect> &rois,
+                             size_t &detect_num,
+                             std::vector<Detection> &detections);
+
+        const SliceParam &sliceParam() const { return mSlice; }
+
+        // Square model input used by the following runs; a size the backend cannot run
+        // falls back to its default and false is returned
+        bool setInputSize(int size);
+
+        int inputSize() const { return mInputSize; }
+
+        // Resolutions the loaded model(s) can run at, empty means any multiple of 32
+        std::vector<int> supportedInputSizes() const;
+
+        // Per-stage times summed since the last reset, only the ORT backend reports them
+        InferStageTimes stageTimes() const;
+
+        void resetStageTimes();
+
+        // Paints masks and boxes in place, the same overlay as runDetectWithPreview
+        static void drawDetections(cv::Mat &frame, const std::vector<Detection> &detections);
+
     private:
         bool initORT();
 
         bool initTRT();
 
+        // TRT engines filter with their own threshold, a stricter spec threshold is applied here
+        void dropBelowThreshold(std::vector<Detection> &detections) const;
+
+        void loadSliceParam();
+
+        std::vector<Detection> detectFrame(const cv::Mat &input_frame);
+
+        std::vector<Detection> detectSliced(const cv::Mat &input_frame);
+
+        // Runs every rect as its own model input, results in frame coordinates (not merged)
+        std::vector<Detection> detectInRects(const cv::Mat &input_frame, const std::vector<cv::Rect> &rects);
+
     private:
+        DetectorSpec mSpec;
+
         std::string mDetMode;
 
+        SliceParam mSlice;
+
+        int mInputSize{TF_DETECT_IMG_SIZE};
+
         bool mRunOnGPU{true};
 
         InferenceORT *mInfORT{nullptr};
@@ -14,7 +14,20 @@
 #include "TConfig.h"
 #include "DetectManager.h"
 #include <onnxruntime_cxx_api.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
 #include <regex>
+#include <sstream>
+#include <unordered_map>
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 
 #ifdef USE_CUDA
@@ -34,7 +47,184 @@
 #define min(a, b)            (((a) < (b)) ? (a) : (b))
 
 
-TF::InferenceORT::InferenceORT(const std::string &model_path) {
+namespace {
+    using StageClock = std::chrono::steady_clock;
+
+    double ElapsedMs(StageClock::time_point start) {
+        return std::chrono::duration<double, std::milli>(StageClock::now() - start).count();
+    }
+
+    // Outputs are decoded in float; FP16 models exported with half I/O are widened first
+    cv::Mat TensorAsFloatMat(Ort::Value &tensor, int rows, int cols) {
+        if (tensor.GetTensorTypeAndShapeInfo().GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+            cv::Mat widened;
+            cv::Mat(rows, cols, CV_16F, tensor.GetTensorMutableData<uint16_t>()).convertTo(widened, CV_32F);
+            return widened;
+        }
+        return cv::Mat(rows, cols, CV_32F, tensor.GetTensorMutableData<float>());
+    }
+
+    // QuantizeModel.py tags its output with a "precision" metadata entry; QDQ INT8
+    // models keep float I/O, so without the tag they are indistinguishable from FP32
+    std::string ModelPrecision(Ort::Session &session, bool half_io) {
+        Ort::AllocatorWithDefaultOptions allocator;
+        auto tag = session.GetModelMetadata().LookupCustomMetadataMapAllocated("precision", allocator);
+        if (tag != nullptr) {
+            return tag.get();
+        }
+        return half_io ? "FP16" : "FP32";
+    }
+}
+
+
+TF::ORT_RUNTIME_PARAM TF::LoadOrtRuntimeParam() {
+    ORT_RUNTIME_PARAM param;
+    param.provider = GET_STR_CONFIG("OrtRuntime", "Provider");
+    param.intraOpThreads = GET_INT_CONFIG("OrtRuntime", "IntraOpThreads");
+    param.interOpThreads = GET_INT_CONFIG("OrtRuntime", "InterOpThreads");
+    param.parallelExecution = GET_BOOL_CONFIG("OrtRuntime", "ParallelExecution");
+    param.globalThreadPool = GET_BOOL_CONFIG("OrtRuntime", "GlobalThreadPool");
+    param.allowSpinning = GET_BOOL_CONFIG("OrtRuntime", "AllowSpinning");
+    param.intraOpAffinity = GET_STR_CONFIG("OrtRuntime", "IntraOpAffinity");
+    param.graphOptLevel = GET_STR_CONFIG("OrtRuntime", "GraphOptLevel");
+    param.cacheDir = GET_STR_CONFIG("OrtRuntime", "CacheDir");
+
+    // The tune file is written per machine by DetectBench --tune and wins over the config
+    const auto tune_file = GET_STR_CONFIG("OrtRuntime", "TuneFile");
+    QFile file(QString::fromStdString(tune_file));
+    if (tune_file.empty() || !file.open(QIODevice::ReadOnly)) {
+        return param;
+    }
+    const auto obj = QJsonDocument::fromJson(file.readAll()).object();
+    if (obj.isEmpty()) {
+        LOG_F(WARNING, "ORT tune file %s is not valid json, ignored.", tune_file.c_str());
+        return param;
+    }
+    param.provider = obj.value("provider").toString(QString::fromStdString(param.provider)).toStdString();
+    param.intraOpThreads = obj.value("intraOpThreads").toInt(param.intraOpThreads);
+    param.interOpThreads = obj.value("interOpThreads").toInt(param.interOpThreads);
+    param.parallelExecution = obj.value("parallelExecution").toBool(param.parallelExecution);
+    param.allowSpinning = obj.value("allowSpinning").toBool(param.allowSpinning);
+    LOG_F(INFO, "ORT runtime from tune file %s (%.2f ms p50 when tuned).", tune_file.c_str(),
+          obj.value("p50Ms").toDouble());
+    return param;
+}
+
+bool TF::SaveOrtTuneFile(const std::string &path, const ORT_RUNTIME_PARAM &param, double p50Ms) {
+    QJsonObject obj;
+    obj["provider"] = QString::fromStdString(param.provider);
+    obj["intraOpThreads"] = param.intraOpThreads;
+    obj["interOpThreads"] = param.interOpThreads;
+    obj["parallelExecution"] = param.parallelExecution;
+    obj["allowSpinning"] = param.allowSpinning;
+    obj["p50Ms"] = p50Ms;
+
+    QFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Indented));
+    return true;
+}
+
+std::string TF::OrtRuntimeParamToString(const ORT_RUNTIME_PARAM &param) {
+    std::ostringstream oss;
+    oss << "provider " << param.provider
+        << ", intra " << param.intraOpThreads
+        << ", inter " << param.interOpThreads
+        << (param.parallelExecution ? ", parallel" : ", sequential")
+        << (param.globalThreadPool ? ", global pool" : "")
+        << (param.allowSpinning ? ", spin" : ", no spin");
+    if (!param.intraOpAffinity.empty()) {
+        oss << ", affinity " << param.intraOpAffinity;
+    }
+    return oss.str();
+}
+
+namespace {
+    // ORT wants a single Env per process; when the global pools are enabled every
+    // session created afterwards runs on them, so the first session decides
+    Ort::Env &SharedOrtEnv(const TF::ORT_RUNTIME_PARAM &runtime, bool &global_pool) {
+        static std::once_flag once;
+        static std::unique_ptr<Ort::Env> env;
+        static bool has_global_pool = false;
+        std::call_once(once, [&runtime]() {
+            if (runtime.globalThreadPool) {
+                Ort::ThreadingOptions threading;
+                threading.SetGlobalIntraOpNumThreads(runtime.intraOpThreads);
+                threading.SetGlobalInterOpNumThreads(runtime.interOpThreads);
+                threading.SetGlobalSpinControl(runtime.allowSpinning ? 1 : 0);
+                if (!runtime.intraOpAffinity.empty()) {
+                    threading.SetGlobalIntraOpThreadAffinity(runtime.intraOpAffinity.c_str());
+                }
+                env = std::make_unique<Ort::Env>(threading, ORT_LOGGING_LEVEL_WARNING, "Yolo");
+                has_global_pool = true;
+            }
+            else {
+                env = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "Yolo");
+            }
+        });
+        if (runtime.globalThreadPool != has_global_pool) {
+            LOG_F(WARNING, "ORT Env already created %s global thread pool, GlobalThreadPool=%d ignored.",
+                  has_global_pool ? "with" : "without", static_cast<int>(runtime.globalThreadPool));
+        }
+        global_pool = has_global_pool;
+        return *env;
+    }
+
+    uint64_t Fnv1a(const char *data, size_t size, uint64_t hash) {
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // <CacheDir>/<model>_<key>.ort, the key covers the model bytes, the ORT version and
+    // everything that changes the optimized graph; empty when the cache is disabled
+    std::filesystem::path OptimizedModelCachePath(const std::string &model_path,
+                                                  const TF::ORT_RUNTIME_PARAM &runtime,
+                                                  bool cuda) {
+        if (runtime.cacheDir.empty()) {
+            return {};
+        }
+        std::ifstream model(model_path, std::ios::binary);
+        if (!model) {
+            return {};
+        }
+
+        uint64_t hash = 14695981039346656037ULL;
+        std::vector<char> buffer(1 << 20);
+        while (model) {
+            model.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            hash = Fnv1a(buffer.data(), static_cast<size_t>(model.gcount()), hash);
+        }
+        const std::string variant = Ort::GetVersionString() + "|" + runtime.provider + "|" +
+                                    runtime.graphOptLevel + "|" + (cuda ? "cuda" : "cpu");
+        hash = Fnv1a(variant.data(), variant.size(), hash);
+
+        std::error_code ec;
+        std::filesystem::create_directories(runtime.cacheDir, ec);
+        std::ostringstream name;
+        name << std::filesystem::path(model_path).stem().string() << "_"
+             << std::hex << std::setw(16) << std::setfill('0') << hash << ".ort";
+        return std::filesystem::path(runtime.cacheDir) / name.str();
+    }
+
+    GraphOptimizationLevel ToGraphOptLevel(const std::string &level) {
+        if (level == "Disabled") return GraphOptimizationLevel::ORT_DISABLE_ALL;
+        if (level == "Basic") return GraphOptimizationLevel::ORT_ENABLE_BASIC;
+        if (level == "Extended") return GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+        return GraphOptimizationLevel::ORT_ENABLE_ALL;
+    }
+}
+
+
+TF::InferenceORT::InferenceORT(const std::string &model_path)
+    : InferenceORT(model_path, LoadOrtRuntimeParam()) {
+}
+
+TF::InferenceORT::InferenceORT(const std::string &model_path, const ORT_RUNTIME_PARAM &runtime) {
 
     inputNodeNames.reserve(20);
     outputNodeNames.reserve(20);
@@ -43,37 +233,56 @@ TF::InferenceORT::InferenceORT(const std::string &model_path) {
     params.rectConfidenceThreshold = GET_FLOAT_CONFIG("VisionMea", "RectConfidenceThreshold");
     params.iouThreshold = GET_FLOAT_CONFIG("VisionMea", "IouThreshold");;
     params.modelPath = model_path;
-    params.imgSize = {TF_DETECT_IMG_SIZE, TF_DETECT_IMG_SIZE};
+    const int input_size = GET_INT_CONFIG("VisionMea", "InputSize");
+    if (input_size > 0) {
+        params.imgSize = {input_size, input_size};
+    }
+    params.runtime = runtime;
 #ifdef USE_CUDA
+    // Input tensors are prepared in device memory, only the CUDA provider can take them
+    if (runtime.provider != "Auto" && runtime.provider != "CUDA") {
+        LOG_F(WARNING, "ORT provider %s ignored in a USE_CUDA build.", runtime.provider.c_str());
+    }
     params.cudaEnable = true;
 
     // GPU FP32 inference
     //params.modelType = YOLO_DETECT;
     params.modelType = YOLO_SEG;
-    // GPU FP16 inference
-    //Note: change fp16 onnx model
-    //params.modelType = YOLO_DETECT_HALF;
 #else
     // CPU inference
     params.modelType = YOLO_DETECT;
-    params.cudaEnable = false;
+    params.cudaEnable = runtime.provider == "CUDA";
 #endif
+    // FP16 models switch to the HALF type in CreateSession from their input element type;
+    // INT8 (QDQ) models keep float I/O and run as the configured type
 
-    CreateSession(params);
+    mReady = CreateSession(params);
 }
 
 TF::InferenceORT::~InferenceORT() {
-
+    // Sessions are created repeatedly when tuning, release them with the object
+    delete mSession;
+    for (auto name : inputNodeNames) {
+        delete[] name;
+    }
+    for (auto name : outputNodeNames) {
+        delete[] name;
+    }
 }
 
 #ifdef USE_CUDA
+using HalfType = half;
+#else
+// CPU builds have no cuda_fp16.h, OpenCV's half has the same IEEE layout
+using HalfType = cv::float16_t;
+#endif
+
 namespace Ort {
     template<>
-    struct TypeToTensorType<half> {
+    struct TypeToTensorType<HalfType> {
         static constexpr ONNXTensorElementDataType type = ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
     };
 }
-#endif
 
 
 template<typename T>
@@ -170,10 +379,12 @@ bool TF::InferenceORT::CreateSession(DL_INIT_PARAM &iParams) {
         iouThreshold = iParams.iouThreshold;
         imgSize = iParams.imgSize;
         modelType = iParams.modelType;
-        mEnv = Ort::Env(ORT_LOGGING_LEVEL_WARNING, "Yolo");
+        const auto &runtime = iParams.runtime;
+        bool global_pool = false;
+        Ort::Env &env = SharedOrtEnv(runtime, global_pool);
         Ort::SessionOptions sessionOption;
+        cudaEnable = iParams.cudaEnable;
         if (iParams.cudaEnable) {
-            cudaEnable = iParams.cudaEnable;
             OrtCUDAProviderOptions cudaOption;
             cudaOption.device_id = 0;
 
@@ -188,23 +399,72 @@ bool TF::InferenceORT::CreateSession(DL_INIT_PARAM &iParams) {
             //tensorrtOption.device_id = 0;
             //sessionOption.AppendExecutionProvider_TensorRT(tensorrtOption);
         }
-        sessionOption.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-        sessionOption.SetIntraOpNumThreads(iParams.intraOpNumThreads);
-        sessionOption.SetLogSeverityLevel(iParams.logSeverityLevel);
-
-#ifdef _WIN32
-        int ModelPathSize = MultiByteToWideChar(CP_UTF8, 0, iParams.modelPath.c_str(),
-                                                static_cast<int>(iParams.modelPath.length()), nullptr, 0);
-        wchar_t *wide_cstr = new wchar_t[ModelPathSize + 1];
-        MultiByteToWideChar(CP_UTF8, 0, iParams.modelPath.c_str(), static_cast<int>(iParams.modelPath.length()),
-                            wide_cstr, ModelPathSize);
-        wide_cstr[ModelPathSize] = L'\0';
-        const wchar_t *modelPath = wide_cstr;
-#else
-        const char* modelPath = iParams.modelPath.c_str();
-#endif // _WIN32
+        else if (runtime.provider == "XNNPACK") {
+            // XNNPACK runs its own pool; ORT's intra-op threads should not spin against it
+            std::unordered_map<std::string, std::string> xnnOption{
+                {"intra_op_num_threads", std::to_string(std::max(1, runtime.intraOpThreads))}
+            };
+            sessionOption.AppendExecutionProvider("XNNPACK", xnnOption);
+        }
 
-        mSession = new Ort::Session(mEnv, modelPath, sessionOption);
+        if (global_pool) {
+            sessionOption.DisablePerSessionThreads();
+        }
+        else {
+            sessionOption.SetIntraOpNumThreads(runtime.provider == "XNNPACK" ? 1 : runtime.intraOpThreads);
+            sessionOption.SetInterOpNumThreads(runtime.interOpThreads);
+            const char *spin = runtime.allowSpinning && runtime.provider != "XNNPACK" ? "1" : "0";
+            sessionOption.AddConfigEntry("session.intra_op.allow_spinning", spin);
+            sessionOption.AddConfigEntry("session.inter_op.allow_spinning", spin);
+            if (!runtime.intraOpAffinity.empty()) {
+                sessionOption.AddConfigEntry("session.intra_op_thread_affinities", runtime.intraOpAffinity.c_str());
+            }
+        }
+        sessionOption.SetExecutionMode(runtime.parallelExecution ? ExecutionMode::ORT_PARALLEL
+                                                                 : ExecutionMode::ORT_SEQUENTIAL);
+        sessionOption.SetGraphOptimizationLevel(ToGraphOptLevel(runtime.graphOptLevel));
+        sessionOption.SetLogSeverityLevel(iParams.logSeverityLevel);
+        LOG_F(INFO, "ORT session runtime: %s.", OrtRuntimeParamToString(runtime).c_str());
+
+        // The path is ASCII (checked above), filesystem::path gives the native ORTCHAR_T string
+        const std::filesystem::path model_path(iParams.modelPath);
+        const auto cache_path = OptimizedModelCachePath(iParams.modelPath, runtime, iParams.cudaEnable);
+        std::error_code ec;
+        if (!cache_path.empty() && std::filesystem::exists(cache_path, ec)) {
+            // Parsing and graph optimization were done when the cache was written
+            Ort::SessionOptions cacheOption = sessionOption.Clone();
+            cacheOption.AddConfigEntry("session.load_model_format", "ORT");
+            try {
+                mSession = new Ort::Session(env, cache_path.c_str(), cacheOption);
+                LOG_F(INFO, "Optimized model loaded from cache %s.", cache_path.string().c_str());
+            }
+            catch (const std::exception &e) {
+                LOG_F(WARNING, "Optimized model cache %s unusable, rebuilding: %s", cache_path.string().c_str(), e.what());
+                std::filesystem::remove(cache_path, ec);
+            }
+        }
+        if (mSession == nullptr) {
+            std::filesystem::path cache_tmp;
+            if (!cache_path.empty()) {
+                // Written next to the final name and renamed, so a power cut never leaves a half file
+                cache_tmp = cache_path;
+                cache_tmp += ".tmp";
+                sessionOption.SetOptimizedModelFilePath(cache_tmp.c_str());
+                sessionOption.AddConfigEntry("session.save_model_format", "ORT");
+            }
+            mSession = new Ort::Session(env, model_path.c_str(), sessionOption);
+            if (!cache_tmp.empty()) {
+                std::filesystem::rename(cache_tmp, cache_path, ec);
+                if (ec) {
+                    LOG_F(WARNING, "Save optimized model cache %s failed: %s", cache_path.string().c_str(),
+                          ec.message().c_str());
+                    std::filesystem::remove(cache_tmp, ec);
+                }
+                else {
+                    LOG_F(INFO, "Optimized model cached to %s.", cache_path.string().c_str());
+                }
+            }
+        }
         Ort::AllocatorWithDefaultOptions allocator;
         size_t inputNodesNum = mSession->GetInputCount();
         for (size_t i = 0; i < inputNodesNum; i++) {
@@ -225,6 +485,30 @@ bool TF::InferenceORT::CreateSession(DL_INIT_PARAM &iParams) {
 
         options = Ort::RunOptions{nullptr};
 
+        // [N, 3, H, W], a non-positive H/W means the model was exported with dynamic shape
+        auto in_shape = mSession->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        if (in_shape.size() == 4 && in_shape[2] > 0 && in_shape[3] > 0) {
+            mDynamicInput = false;
+            imgSize = {static_cast<int>(in_shape[3]), static_cast<int>(in_shape[2])};
+        }
+        else {
+            mDynamicInput = true;
+        }
+        LOG_F(INFO, "Model input %dx%d, %s shape.", imgSize.at(0), imgSize.at(1),
+              mDynamicInput ? "dynamic" : "fixed");
+
+        // The input element type decides the blob type, whatever model type was configured
+        const auto in_type = mSession->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType();
+        const bool half_io = in_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+        if (half_io && modelType < YOLO_DETECT_HALF) {
+            modelType = static_cast<MODEL_TYPE>(modelType + 4);
+        }
+        else if (!half_io && modelType >= YOLO_DETECT_HALF) {
+            modelType = static_cast<MODEL_TYPE>(modelType - 4);
+        }
+        mPrecision = ModelPrecision(*mSession, half_io);
+        LOG_F(INFO, "Model precision %s, %s I/O.", mPrecision.c_str(), half_io ? "FP16" : "FP32");
+
         auto out0_info = mSession->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo();
         auto out0_shape = out0_info.GetShape();  // [1, no, N]
         int64_t no = out0_shape[1];
@@ -260,15 +544,17 @@ bool TF::InferenceORT::CreateSession(DL_INIT_PARAM &iParams) {
 }
 
 void TF::InferenceORT::RunSession(cv::Mat &iImg, std::vector<DL_RESULT> &oResult) {
+    const auto stage_start = StageClock::now();
     mOriginalImgSize = iImg.size();
     if (modelType == YOLO_DETECT || modelType == YOLO_POSE || modelType == YOLO_CLS || modelType == YOLO_SEG) {
 #ifdef USE_CUDA
         Ort::Value inputTensor {nullptr};
-        PrepareInputTensor(iImg, inputTensor, TF_DETECT_IMG_SIZE, TF_DETECT_IMG_SIZE);
+        PrepareInputTensor(iImg, inputTensor, imgSize.at(0), imgSize.at(1));
         mResizeScales = iImg.cols / (float) imgSize.at(0);
         mResizeScaleX = static_cast<float>(mOriginalImgSize.width)  / imgSize.at(0);
         mResizeScaleY = static_cast<float>(mOriginalImgSize.height) / imgSize.at(1);
         std::vector<int64_t> inputNodeDims = {1, 3, imgSize.at(0), imgSize.at(1)};
+        mStageTimes.preprocessMs += ElapsedMs(stage_start);
         TensorProcess(inputTensor, inputNodeDims, oResult);
 #else
         cv::Mat processedImg;
@@ -276,17 +562,17 @@ void TF::InferenceORT::RunSession(cv::Mat &iImg, std::vector<DL_RESULT> &oResult
         float *blob = new float[processedImg.total() * 3];
         BlobFromImage(processedImg, blob);
         std::vector<int64_t> inputNodeDims = {1, 3, imgSize.at(0), imgSize.at(1)};
+        mStageTimes.preprocessMs += ElapsedMs(stage_start);
         TensorProcess(blob, inputNodeDims, oResult);
 #endif
     } else {
-#ifdef USE_CUDA
         cv::Mat processedImg;
         PreProcess(iImg, imgSize, processedImg);
-        half *blob = new half[processedImg.total() * 3];
+        HalfType *blob = new HalfType[processedImg.total() * 3];
         BlobFromImage(processedImg, blob);
         std::vector<int64_t> inputNodeDims = {1, 3, imgSize.at(0), imgSize.at(1)};
+        mStageTimes.preprocessMs += ElapsedMs(stage_start);
         TensorProcess(blob, inputNodeDims, oResult);
-#endif
     }
 }
 
@@ -298,13 +584,16 @@ bool TF::InferenceORT::TensorProcess(N &blob, std::vector<int64_t> &inputNodeDim
             Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU), blob, 3 * imgSize.at(0) * imgSize.at(1),
             inputNodeDims.data(), inputNodeDims.size());
 
+    const auto run_start = StageClock::now();
     auto outputTensor = mSession->Run(options, inputNodeNames.data(), &inputTensor, 1, outputNodeNames.data(),
                                       outputNodeNames.size());
+    mStageTimes.inferMs += ElapsedMs(run_start);
+    const auto decode_start = StageClock::now();
+    const double mask_before = mStageTimes.maskMs;
 
     Ort::TypeInfo typeInfo = outputTensor.front().GetTypeInfo();
     auto tensor_info = typeInfo.GetTensorTypeAndShapeInfo();
     std::vector<int64_t> outputNodeDims = tensor_info.GetShape();
-    auto output = outputTensor.front().GetTensorMutableData<typename std::remove_pointer<N>::type>();
     delete[] blob;
     switch (modelType) {
         case YOLO_DETECT:
@@ -317,15 +606,7 @@ bool TF::InferenceORT::TensorProcess(N &blob, std::vector<int64_t> &inputNodeDim
             std::vector<float> confidences;
             std::vector<cv::Rect> boxes;
             std::vector<cv::Mat> masks;
-            cv::Mat rawData;
-            if (modelType == YOLO_DETECT || modelType == YOLO_SEG) {
-                // FP32
-                rawData = cv::Mat(signalResultNum, strideNum, CV_32F, output);
-            } else {
-                // FP16
-                rawData = cv::Mat(signalResultNum, strideNum, CV_16F, output);
-                rawData.convertTo(rawData, CV_32F);
-            }
+            cv::Mat rawData = TensorAsFloatMat(outputTensor.front(), signalResultNum, strideNum);
             rawData = rawData.t();
             float *data = (float *) rawData.data;
 
@@ -336,8 +617,8 @@ bool TF::InferenceORT::TensorProcess(N &blob, std::vector<int64_t> &inputNodeDim
                 auto protoInfo = outputTensor[1].GetTensorTypeAndShapeInfo();
                 auto protoShape = protoInfo.GetShape();
                 protoHeight = static_cast<int>(protoShape[2]);
-                protoData = cv::Mat(static_cast<int>(protoShape[1]), protoHeight * static_cast<int>(protoShape[3]), CV_32F,
-                                    outputTensor[1].GetTensorMutableData<float>());
+                protoData = TensorAsFloatMat(outputTensor[1], static_cast<int>(protoShape[1]),
+                                             protoHeight * static_cast<int>(protoShape[3]));
             }
 
             for (int i = 0; i < strideNum; ++i) {
@@ -367,6 +648,7 @@ bool TF::InferenceORT::TensorProcess(N &blob, std::vector<int64_t> &inputNodeDim
                         int maskStart = 4 + nc_;
                         int maskDim = signalResultNum - maskStart;
                         if (maskDim > 0) {
+                            const auto mask_start = StageClock::now();
                             cv::Mat maskCoef(1, maskDim, CV_32F, data + maskStart);
                             cv::Mat mask = maskCoef * protoData;
                             mask = mask.reshape(1, protoHeight);
@@ -383,6 +665,7 @@ bool TF::InferenceORT::TensorProcess(N &blob, std::vector<int64_t> &inputNodeDim
                                 maskCrop.copyTo(boxMask(roi));
                             }
                             masks.push_back(boxMask);
+                            mStageTimes.maskMs += ElapsedMs(mask_start);
                         }
                     }
                 }
@@ -405,15 +688,7 @@ bool TF::InferenceORT::TensorProcess(N &blob, std::vector<int64_t> &inputNodeDim
         }
         case YOLO_CLS:
         case YOLO_CLS_HALF: {
-            cv::Mat rawData;
-            if (modelType == YOLO_CLS) {
-                // FP32
-                rawData = cv::Mat(1, this->classes.size(), CV_32F, output);
-            } else {
-                // FP16
-                rawData = cv::Mat(1, this->classes.size(), CV_16F, output);
-                rawData.convertTo(rawData, CV_32F);
-            }
+            cv::Mat rawData = TensorAsFloatMat(outputTensor.front(), 1, static_cast<int>(this->classes.size()));
             float *data = (float *) rawData.data;
 
             DL_RESULT result;
@@ -427,9 +702,35 @@ bool TF::InferenceORT::TensorProcess(N &blob, std::vector<int64_t> &inputNodeDim
         default:
             LOG_F(ERROR, "Not support model type.");
     }
+    mStageTimes.decodeMs += ElapsedMs(decode_start) - (mStageTimes.maskMs - mask_before);
+    return true;
+}
+
+
+bool TF::InferenceORT::setInputSize(int size) {
+    // YOLO strides need a multiple of 32
+    size = (size + 16) / 32 * 32;
+    if (size <= 0) {
+        return false;
+    }
+    if (size == imgSize.at(0) && size == imgSize.at(1)) {
+        return true;
+    }
+    if (!mDynamicInput) {
+        return false;
+    }
+    imgSize = {size, size};
     return true;
 }
 
+void TF::InferenceORT::setThresholds(float confidence, float iou) {
+    if (confidence > 0.0f) {
+        rectConfidenceThreshold = confidence;
+    }
+    if (iou > 0.0f) {
+        iouThreshold = iou;
+    }
+}
 
 void TF::InferenceORT::WarmUpSession() {
     cv::Mat iImg = cv::Mat(cv::Size(imgSize.at(0), imgSize.at(1)), CV_8UC3);
@@ -446,24 +747,24 @@ void TF::InferenceORT::WarmUpSession() {
                                             outputNodeNames.size());
         delete[] blob;
     } else {
-#ifdef USE_CUDA
-        half *blob = new half[iImg.total() * 3];
+        HalfType *blob = new HalfType[iImg.total() * 3];
         BlobFromImage(processedImg, blob);
         std::vector<int64_t> YOLO_input_node_dims = {1, 3, imgSize.at(0), imgSize.at(1)};
-        Ort::Value input_tensor = Ort::Value::CreateTensor<half>(
+        Ort::Value input_tensor = Ort::Value::CreateTensor<HalfType>(
                 Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU), blob, 3 * imgSize.at(0) * imgSize.at(1),
                 YOLO_input_node_dims.data(), YOLO_input_node_dims.size());
         auto output_tensors = mSession->Run(options, inputNodeNames.data(), &input_tensor, 1, outputNodeNames.data(),
                                             outputNodeNames.size());
         delete[] blob;
-#endif
     }
 }
 
 std::vector<TF::Detection> TF::InferenceORT::runInference(const cv::Mat &input) {
+    const auto stage_start = StageClock::now();
     // image
     cv::Mat frame = input.clone();
     cv::cvtColor(frame, frame, cv::COLOR_BGR2RGB);
+    mStageTimes.preprocessMs += ElapsedMs(stage_start);
 
     std::vector<int> class_ids;
     std::vector<float> confidences;
@@ -528,8 +829,12 @@ cv::Mat TF::InferenceORT::sigmoid(const cv::Mat &src) {
 
 bool TF::InferenceORT::TensorProcess(Ort::Value &inputTensor, std::vector<int64_t> &inputNodeDims,
                                        std::vector<DL_RESULT> &oResult) {
+    const auto run_start = StageClock::now();
     auto outputTensor = mSession->Run(options, inputNodeNames.data(), &inputTensor, 1, outputNodeNames.data(),
                                       outputNodeNames.size());
+    mStageTimes.inferMs += ElapsedMs(run_start);
+    const auto decode_start = StageClock::now();
+    const double mask_before = mStageTimes.maskMs;
 
 #ifdef USE_CUDA
     auto* devicePtr = inputTensor.GetTensorMutableData<float>();
@@ -587,6 +892,7 @@ bool TF::InferenceORT::TensorProcess(Ort::Value &inputTensor, std::vector<int64_
                 int maskStart = 4 + nc_;
                 int maskDim = signalResultNum - maskStart;
                 if (maskDim > 0) {
+                    const auto mask_start = StageClock::now();
                     cv::Mat maskCoef(1, maskDim, CV_32F, data + maskStart);
                     cv::Mat mask = maskCoef * protoData;
                     mask = mask.reshape(1, protoHeight);
@@ -603,6 +909,7 @@ bool TF::InferenceORT::TensorProcess(Ort::Value &inputTensor, std::vector<int64_
                         maskCrop.copyTo(boxMask(roi));
                     }
                     masks.push_back(boxMask);
+                    mStageTimes.maskMs += ElapsedMs(mask_start);
                 }
             }
         }
@@ -621,5 +928,6 @@ bool TF::InferenceORT::TensorProcess(Ort::Value &inputTensor, std::vector<int64_
         }
         oResult.push_back(result);
     }
+    mStageTimes.decodeMs += ElapsedMs(decode_start) - (mStageTimes.maskMs - mask_before);
     return true;
 }
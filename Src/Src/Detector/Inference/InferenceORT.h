@@ -43,6 +43,26 @@ namespace TF {
         YOLO_SEG_HALF = 8
     };
 
+    // Threading and execution provider of the ORT session, see [OrtRuntime] in the config
+    typedef struct _ORT_RUNTIME_PARAM {
+        std::string provider = "Auto";      // Auto (CUDA when built with USE_CUDA, else CPU), CPU, CUDA, XNNPACK
+        int intraOpThreads = 0;             // 0 lets ORT use one thread per physical core
+        int interOpThreads = 0;
+        bool parallelExecution = false;     // ORT_PARALLEL, only then interOpThreads matters
+        bool globalThreadPool = false;      // all sessions share the Env's pools (DisablePerSessionThreads)
+        bool allowSpinning = true;          // idle pool threads spin instead of sleeping
+        std::string intraOpAffinity;        // ORT affinity string, e.g. "1;2;3" for 4 threads
+        std::string graphOptLevel = "All"; // Disabled, Basic, Extended, All
+        std::string cacheDir;               // optimized ORT-format models, empty disables the cache
+    } ORT_RUNTIME_PARAM;
+
+    // Config values, overridden by the auto-tune result in OrtRuntime/TuneFile when it exists
+    ORT_RUNTIME_PARAM LoadOrtRuntimeParam();
+
+    bool SaveOrtTuneFile(const std::string &path, const ORT_RUNTIME_PARAM &param, double p50Ms);
+
+    std::string OrtRuntimeParamToString(const ORT_RUNTIME_PARAM &param);
+
     typedef struct _DL_INIT_PARAM {
         std::string modelPath;
         //MODEL_TYPE modelType = YOLO_DETECT;
@@ -53,7 +73,7 @@ namespace TF {
         int keyPointsNum = 2;
         bool cudaEnable = false;
         int logSeverityLevel = 3;
-        int intraOpNumThreads = 1;
+        ORT_RUNTIME_PARAM runtime;
     } DL_INIT_PARAM;
 
     typedef struct _DL_RESULT {
@@ -69,6 +89,8 @@ namespace TF {
     public:
         InferenceORT(const std::string &model_path);
 
+        InferenceORT(const std::string &model_path, const ORT_RUNTIME_PARAM &runtime);
+
         ~InferenceORT();
 
     public:
@@ -76,6 +98,8 @@ namespace TF {
 
         bool CreateSession(DL_INIT_PARAM &iParams);
 
+        bool ready() const { return mReady; }
+
         void RunSession(cv::Mat &iImg, std::vector<DL_RESULT> &oResult);
 
         void WarmUpSession();
@@ -91,6 +115,24 @@ namespace TF {
 
         void PreProcess(cv::Mat &iImg, std::vector<int> iImgSize, cv::Mat &oImg);
 
+        // Only a model exported with dynamic H/W accepts sizes other than its own
+        bool setInputSize(int size);
+
+        int inputSize() const { return imgSize.at(0); }
+
+        bool dynamicInput() const { return mDynamicInput; }
+
+        // Non-positive values keep the VisionMea thresholds
+        void setThresholds(float confidence, float iou);
+
+        // FP32, FP16 or the tag written by QuantizeModel.py (INT8)
+        const std::string &precision() const { return mPrecision; }
+
+        // Stage times are summed over runInference calls until reset
+        const InferStageTimes &stageTimes() const { return mStageTimes; }
+
+        void resetStageTimes() { mStageTimes = {}; }
+
     private:
         void analysisDetResults(int x_offset,
                                 const std::vector<DL_RESULT> &detect_rets,
@@ -119,8 +161,8 @@ namespace TF {
         };
 
     private:
-        Ort::Env mEnv;
-        Ort::Session *mSession;
+        Ort::Session *mSession {nullptr};
+        bool mReady {false};
         bool cudaEnable;
         Ort::RunOptions options;
         std::vector<const char *> inputNodeNames;
@@ -128,6 +170,9 @@ namespace TF {
 
         MODEL_TYPE modelType;
         std::vector<int> imgSize;
+        bool mDynamicInput {false};
+        std::string mPrecision {"FP32"};
+        InferStageTimes mStageTimes {};
         float rectConfidenceThreshold;
         float iouThreshold;
         float mResizeScales {1080.0f / 800.0f};
@@ -0,0 +1,211 @@
+/**************************************************************************
+
+           Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : SliceInference.cpp
+   Author : tao.jing
+   Date   : 2026.10.19
+   Brief  :
+**************************************************************************/
+#include "SliceInference.h"
+#include <algorithm>
+#include <numeric>
+
+#include <opencv2/imgproc.hpp>
+
+
+namespace TF {
+    static std::vector<int> SliceStarts(int length, int tileSize, int stride) {
+        std::vector<int> starts;
+        if (length <= tileSize) {
+            starts.push_back(0);
+            return starts;
+        }
+        for (int pos = 0; ; pos += stride) {
+            if (pos + tileSize >= length) {
+                starts.push_back(length - tileSize);
+                break;
+            }
+            starts.push_back(pos);
+        }
+        return starts;
+    }
+
+    std::vector<cv::Rect> MakeSliceTiles(const cv::Size& frameSize, int tileSize, int stride) {
+        std::vector<cv::Rect> tiles;
+        if (frameSize.width <= 0 || frameSize.height <= 0 || tileSize <= 0) {
+            return tiles;
+        }
+        stride = std::clamp(stride, 1, tileSize);
+
+        const auto xs = SliceStarts(frameSize.width, tileSize, stride);
+        const auto ys = SliceStarts(frameSize.height, tileSize, stride);
+        tiles.reserve(xs.size() * ys.size());
+        for (int y : ys) {
+            for (int x : xs) {
+                tiles.emplace_back(x, y,
+                                   std::min(tileSize, frameSize.width),
+                                   std::min(tileSize, frameSize.height));
+            }
+        }
+        return tiles;
+    }
+
+    std::vector<cv::Rect> MakeFocusRois(const std::vector<cv::Rect>& boxes,
+                                        const cv::Size& frameSize,
+                                        float expand,
+                                        int minSize) {
+        const cv::Rect frameRect(0, 0, frameSize.width, frameSize.height);
+        std::vector<cv::Rect> rois;
+        for (const auto& box : boxes) {
+            if (box.area() <= 0) continue;
+
+            int side = static_cast<int>(std::max(box.width, box.height) * std::max(1.0f, expand));
+            side = std::max(side, minSize);
+            side = std::min({side, frameSize.width, frameSize.height});
+
+            // Shift the crop back inside the frame instead of shrinking it
+            const cv::Point center(box.x + box.width / 2, box.y + box.height / 2);
+            const int x = std::clamp(center.x - side / 2, 0, frameSize.width - side);
+            const int y = std::clamp(center.y - side / 2, 0, frameSize.height - side);
+            rois.emplace_back(cv::Rect(x, y, side, side) & frameRect);
+        }
+
+        // Unite overlapping crops until stable
+        bool merged = true;
+        while (merged) {
+            merged = false;
+            for (size_t i = 0; i < rois.size() && !merged; ++i) {
+                for (size_t j = i + 1; j < rois.size(); ++j) {
+                    if ((rois[i] & rois[j]).area() > 0) {
+                        rois[i] |= rois[j];
+                        rois.erase(rois.begin() + static_cast<std::ptrdiff_t>(j));
+                        merged = true;
+                        break;
+                    }
+                }
+            }
+        }
+        return rois;
+    }
+
+    void ShiftDetectionToFrame(Detection& det, const cv::Rect& tile, const cv::Size& frameSize) {
+        if (det.mask.empty()) {
+            det.box.x += tile.x;
+            det.box.y += tile.y;
+            det.box &= cv::Rect(0, 0, frameSize.width, frameSize.height);
+            return;
+        }
+
+        // Tile masks are tile-sized, keep only the box region; it still refers to the tile mask
+        const cv::Rect frameInTile(-tile.x, -tile.y, frameSize.width, frameSize.height);
+        const cv::Rect local = det.box & cv::Rect(0, 0, det.mask.cols, det.mask.rows) & frameInTile;
+        det.mask = local.area() > 0 ? det.mask(local) : cv::Mat();
+        det.box = local + tile.tl();
+    }
+
+    void CropMaskToBox(Detection& det) {
+        if (det.mask.empty()) {
+            return;
+        }
+        det.box &= cv::Rect(0, 0, det.mask.cols, det.mask.rows);
+        det.mask = det.box.area() > 0 ? det.mask(det.box) : cv::Mat();
+    }
+
+    void ExpandMasksToFrame(std::vector<Detection>& detections, const cv::Size& frameSize) {
+        const cv::Rect frameRect(0, 0, frameSize.width, frameSize.height);
+        for (auto& det : detections) {
+            if (det.mask.empty() || det.mask.size() == frameSize) {
+                continue;
+            }
+            cv::Mat frameMask = cv::Mat::zeros(frameSize, CV_8UC1);
+            const cv::Rect dst = cv::Rect(det.box.tl(), det.mask.size()) & frameRect;
+            if (dst.area() > 0) {
+                det.mask(cv::Rect(dst.tl() - det.box.tl(), dst.size())).copyTo(frameMask(dst));
+            }
+            det.mask = std::move(frameMask);
+        }
+    }
+
+    void ScaleDetectionToFrame(Detection& det, const cv::Point2f& scale, const cv::Size& frameSize) {
+        const cv::Rect scaledBox = det.box;
+        const int x0 = cvFloor(static_cast<float>(scaledBox.x) * scale.x);
+        const int y0 = cvFloor(static_cast<float>(scaledBox.y) * scale.y);
+        const int x1 = cvCeil(static_cast<float>(scaledBox.br().x) * scale.x);
+        const int y1 = cvCeil(static_cast<float>(scaledBox.br().y) * scale.y);
+        det.box = cv::Rect(cv::Point(x0, y0), cv::Point(x1, y1)) & cv::Rect(0, 0, frameSize.width, frameSize.height);
+
+        if (!det.mask.empty()) {
+            cv::Mat frameMask = cv::Mat::zeros(frameSize, CV_8UC1);
+            const cv::Rect src = scaledBox & cv::Rect(0, 0, det.mask.cols, det.mask.rows);
+            if (src.area() > 0 && det.box.area() > 0) {
+                cv::Mat dst = frameMask(det.box);
+                cv::resize(det.mask(src), dst, dst.size(), 0, 0, cv::INTER_NEAREST);
+            }
+            det.mask = std::move(frameMask);
+        }
+    }
+
+    std::vector<Detection> MergeSliceDetections(std::vector<Detection> candidates,
+                                                float iouThreshold,
+                                                float iosThreshold) {
+        std::vector<size_t> order(candidates.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return candidates[a].confidence > candidates[b].confidence;
+        });
+
+        std::vector<bool> consumed(candidates.size(), false);
+        std::vector<Detection> merged;
+        for (size_t i = 0; i < order.size(); ++i) {
+            const size_t keepIdx = order[i];
+            if (consumed[keepIdx]) continue;
+            consumed[keepIdx] = true;
+
+            Detection keep = std::move(candidates[keepIdx]);
+            const cv::Rect seedBox = keep.box;
+            std::vector<size_t> group;
+            for (size_t j = i + 1; j < order.size(); ++j) {
+                const size_t idx = order[j];
+                if (consumed[idx]) continue;
+
+                const Detection& other = candidates[idx];
+                if (other.class_id != keep.class_id) continue;
+
+                // Compare against the seed box so that merging does not snowball
+                const float inter = static_cast<float>((seedBox & other.box).area());
+                if (inter <= 0.0f) continue;
+                const float uni = static_cast<float>(seedBox.area() + other.box.area()) - inter;
+                const float smaller = static_cast<float>(std::min(seedBox.area(), other.box.area()));
+                const float iou = uni > 0.0f ? inter / uni : 0.0f;
+                const float ios = smaller > 0.0f ? inter / smaller : 0.0f;
+                if (iou < iouThreshold && ios < iosThreshold) continue;
+
+                consumed[idx] = true;
+                group.push_back(idx);
+                keep.box |= other.box;
+            }
+
+            // One mask the size of the united box, each member's mask OR-ed in at its offset
+            const bool anyMask = !keep.mask.empty() || std::any_of(group.begin(), group.end(), [&](size_t idx) {
+                return !candidates[idx].mask.empty();
+            });
+            if (!group.empty() && anyMask) {
+                cv::Mat unitedMask = cv::Mat::zeros(keep.box.size(), CV_8UC1);
+                auto orInto = [&](const Detection& member, const cv::Rect& memberBox) {
+                    if (member.mask.empty() || member.mask.size() != memberBox.size()) return;
+                    cv::Mat dst = unitedMask(memberBox - keep.box.tl());
+                    cv::bitwise_or(dst, member.mask, dst);
+                };
+                orInto(keep, seedBox);
+                for (const size_t idx : group) {
+                    orInto(candidates[idx], candidates[idx].box);
+                }
+                keep.mask = std::move(unitedMask);
+            }
+            merged.emplace_back(std::move(keep));
+        }
+        return merged;
+    }
+};
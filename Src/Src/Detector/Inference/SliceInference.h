@@ -0,0 +1,54 @@
+/**************************************************************************
+
+           Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : SliceInference.h
+   Author : tao.jing
+   Date   : 2026.10.19
+   Brief  : Tile layout and cross-tile merging for sliced inference
+**************************************************************************/
+#ifndef FIREAPP_SLICEINFERENCE_H
+#define FIREAPP_SLICEINFERENCE_H
+
+#include "DetectDef.h"
+#include <vector>
+
+
+namespace TF {
+    // Overlapping tiles covering the frame, the last row/column is aligned to the
+    // frame edge; a frame no larger than one tile yields a single full-frame rect
+    std::vector<cv::Rect> MakeSliceTiles(const cv::Size& frameSize, int tileSize, int stride);
+
+    // Moves a detection produced on a tile into frame coordinates; the mask is cut down to
+    // the box (mask.size() == box.size()), ExpandMasksToFrame restores full-frame masks
+    void ShiftDetectionToFrame(Detection& det, const cv::Rect& tile, const cv::Size& frameSize);
+
+    // Cuts a full-frame mask down to the box, the layout MergeSliceDetections works on
+    void CropMaskToBox(Detection& det);
+
+    // Pastes box-sized masks into one full-frame mask per detection
+    void ExpandMasksToFrame(std::vector<Detection>& detections, const cv::Size& frameSize);
+
+    // Moves a detection produced on a downscaled copy of the frame into frame coordinates,
+    // frame = scaled * scale; only the box region of the mask is resized
+    void ScaleDetectionToFrame(Detection& det, const cv::Point2f& scale, const cv::Size& frameSize);
+
+    // Square crops centred on each flame box, expanded and clamped to the frame;
+    // overlapping crops are united so a region is never inferred twice
+    std::vector<cv::Rect> MakeFocusRois(const std::vector<cv::Rect>& boxes,
+                                        const cv::Size& frameSize,
+                                        float expand,
+                                        int minSize);
+
+    // Greedy non-maximum merging: the highest-confidence box absorbs same-class boxes
+    // whose IoU or intersection-over-smaller passes the thresholds; boxes are
+    // united and masks OR-ed so flames cut by tile borders come back as one.
+    // Masks are box-sized on input and output, so merging never touches a full frame
+    std::vector<Detection> MergeSliceDetections(std::vector<Detection> candidates,
+                                                float iouThreshold,
+                                                float iosThreshold);
+};
+
+
+#endif //FIREAPP_SLICEINFERENCE_H
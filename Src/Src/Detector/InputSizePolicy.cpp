@@ -0,0 +1,97 @@
+#include "InputSizePolicy.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "TLog.h"
+
+namespace TF {
+
+    namespace {
+        const float AvgAlpha = 0.2f;
+        // Runs to wait after a switch before judging the new size
+        const int SwitchCooldown = 10;
+        // Step up only when the smaller size leaves this much of the budget unused
+        const float StepUpRatio = 0.5f;
+    }
+
+    void InputSizePolicy::configure(const Params &params, const std::vector<int> &supported) {
+        mParams = params;
+
+        mLadder.clear();
+        for (int size : mParams.ladder) {
+            if (size <= 0) continue;
+            if (supported.empty() || std::find(supported.begin(), supported.end(), size) != supported.end()) {
+                mLadder.push_back(size);
+            }
+        }
+        if (mLadder.empty()) {
+            mLadder = supported.empty() ? std::vector<int>{mParams.defaultSize} : supported;
+        }
+        std::sort(mLadder.begin(), mLadder.end());
+        mLadder.erase(std::unique(mLadder.begin(), mLadder.end()), mLadder.end());
+        reset();
+    }
+
+    void InputSizePolicy::reset() {
+        mStreams.clear();
+    }
+
+    size_t InputSizePolicy::nearestIndex(int size) const {
+        size_t best = 0;
+        for (size_t i = 1; i < mLadder.size(); ++i) {
+            if (std::abs(mLadder[i] - size) < std::abs(mLadder[best] - size)) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    InputSizePolicy::StreamState &InputSizePolicy::stateFor(const std::string &stream) {
+        auto it = mStreams.find(stream);
+        if (it == mStreams.end()) {
+            const auto conf = mParams.streamSizes.find(stream);
+            const int size = conf != mParams.streamSizes.end() ? conf->second : mParams.defaultSize;
+            StreamState state;
+            state.maxIndex = nearestIndex(size);
+            state.index = state.maxIndex;
+            it = mStreams.emplace(stream, state).first;
+        }
+        return it->second;
+    }
+
+    int InputSizePolicy::sizeFor(const std::string &stream) {
+        // Not configured yet, the model is still loading
+        if (mLadder.empty()) {
+            return mParams.defaultSize;
+        }
+        return mLadder[stateFor(stream).index];
+    }
+
+    void InputSizePolicy::report(const std::string &stream, int costMs) {
+        if (!mParams.adaptive || costMs < 0 || mLadder.empty()) {
+            return;
+        }
+
+        auto &state = stateFor(stream);
+        state.avgMs = state.samples == 0 ? static_cast<float>(costMs)
+                                         : state.avgMs + AvgAlpha * (static_cast<float>(costMs) - state.avgMs);
+        if (++state.samples < SwitchCooldown) {
+            return;
+        }
+
+        size_t next = state.index;
+        if (state.avgMs > static_cast<float>(mParams.budgetMs) && state.index > 0) {
+            next = state.index - 1;
+        }
+        else if (state.avgMs < static_cast<float>(mParams.budgetMs) * StepUpRatio && state.index < state.maxIndex) {
+            next = state.index + 1;
+        }
+        if (next != state.index) {
+            LOG_F(INFO, "[InputSizePolicy] Stream %s input %d -> %d, avg %.1f ms, budget %d ms.",
+                  stream.c_str(), mLadder[state.index], mLadder[next], state.avgMs, mParams.budgetMs);
+            state.index = next;
+            state.samples = 0;
+        }
+    }
+}
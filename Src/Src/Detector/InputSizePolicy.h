@@ -0,0 +1,65 @@
+/**************************************************************************
+
+Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : InputSizePolicy.h
+   Author : tao.jing
+   Date   : 2026/10/19
+   Brief  : Per-stream model input resolution
+**************************************************************************/
+#ifndef FIREAPP_INPUTSIZEPOLICY_H
+#define FIREAPP_INPUTSIZEPOLICY_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace TF {
+
+    // Chooses the model input resolution per stream. Each stream starts at its
+    // configured size; with adaptive switching enabled a stream whose inference
+    // keeps exceeding the time budget steps down the size ladder, and steps back
+    // up (never above its configured size) once there is headroom again.
+    class InputSizePolicy {
+    public:
+        struct Params {
+            int defaultSize{640};                   // size for streams without an entry below
+            std::vector<int> ladder;                // candidate sizes, ascending
+            std::map<std::string, int> streamSizes; // source flag -> size
+            bool adaptive{false};
+            int budgetMs{100};                      // per-inference budget driving the switch
+        };
+
+        // supported: sizes the loaded model can run, empty means any
+        void configure(const Params &params, const std::vector<int> &supported);
+
+        const Params &params() const { return mParams; }
+
+        int sizeFor(const std::string &stream);
+
+        // Inference time of the last run on stream, may change its size
+        void report(const std::string &stream, int costMs);
+
+        void reset();
+
+    private:
+        struct StreamState {
+            size_t maxIndex{0};    // configured size, upper bound for stepping up
+            size_t index{0};
+            float avgMs{0.0f};
+            int samples{0};        // runs since the last switch
+        };
+
+        StreamState &stateFor(const std::string &stream);
+
+        size_t nearestIndex(int size) const;
+
+        Params mParams;
+        std::vector<int> mLadder;
+        std::map<std::string, StreamState> mStreams;
+    };
+}
+
+
+#endif //FIREAPP_INPUTSIZEPOLICY_H
@@ -0,0 +1,226 @@
+#include "LatencyTracer.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "TConfig.h"
+#include "TLog.h"
+
+namespace TF {
+
+    namespace {
+        constexpr int StageCount = static_cast<int>(TraceStage::Count);
+        constexpr int TracePid = 1;
+    }
+
+    void FrameTrace::mark(TraceStage stage) {
+        if (valid()) {
+            stamps[static_cast<int>(stage)] = LatencyTracer::nowUs();
+        }
+    }
+
+    void LatencyHistogram::add(int64_t us) {
+        ++mBuckets[HdrBuckets::indexOf(us)];
+        ++mCount;
+        mMaxUs = std::max(mMaxUs, us);
+    }
+
+    void LatencyHistogram::clear() {
+        mBuckets.fill(0);
+        mCount = 0;
+        mMaxUs = 0;
+    }
+
+    double LatencyHistogram::percentileMs(double p) const {
+        if (mCount == 0) {
+            return 0.0;
+        }
+        const auto rank = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(p * static_cast<double>(mCount))));
+        int64_t seen = 0;
+        for (int i = 0; i < HdrBuckets::Count; ++i) {
+            seen += mBuckets[i];
+            if (seen >= rank) {
+                return static_cast<double>(std::min(HdrBuckets::upperOf(i), mMaxUs)) / 1000.0;
+            }
+        }
+        return maxMs();
+    }
+
+    void LatencyTracer::init() {
+        mEnabled = GET_BOOL_CONFIG("VisionMea", "LatencyTrace");
+        mOverlay = GET_BOOL_CONFIG("VisionMea", "LatencyTraceOverlay");
+        mHistory = std::max(1, GET_INT_CONFIG("VisionMea", "LatencyTraceHistory"));
+        mTraceDir = QString::fromStdString(GET_STR_CONFIG("VisionMea", "LatencyTraceDir"));
+    }
+
+    int64_t LatencyTracer::nowUs() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    const char *LatencyTracer::stageName(TraceStage stage) {
+        // Each name covers the span that ends at the stage
+        static const char *names[StageCount] = {
+            "read", "decode", "convert", "gui", "queue", "infer", "post", "save", "publish"
+        };
+        return names[static_cast<int>(stage)];
+    }
+
+    FrameTrace LatencyTracer::begin(int64_t readUs, int64_t decodedUs, int64_t convertedUs) {
+        FrameTrace trace;
+        if (!mEnabled) {
+            return trace;
+        }
+        trace.id = mNextId.fetch_add(1);
+        trace.stamps[static_cast<int>(TraceStage::Read)] = readUs;
+        trace.stamps[static_cast<int>(TraceStage::Decoded)] = decodedUs;
+        trace.stamps[static_cast<int>(TraceStage::Converted)] = convertedUs;
+        return trace;
+    }
+
+    void LatencyTracer::finish(const FrameTrace &trace, const QString &sourceFlag) {
+        if (!mEnabled || !trace.valid()) {
+            return;
+        }
+
+        QMutexLocker locker(&mMutex);
+        int64_t first = 0;
+        int64_t previous = 0;
+        for (int i = 0; i < StageCount; ++i) {
+            const int64_t stamp = trace.stamps[i];
+            if (stamp <= 0) {
+                continue;
+            }
+            if (previous > 0) {
+                mStages[i].add(stamp - previous);
+            }
+            else {
+                first = stamp;
+            }
+            previous = stamp;
+        }
+        if (previous > first) {
+            mTotal.add(previous - first);
+        }
+
+        mRecent.push_back({trace, sourceFlag});
+        while (static_cast<int>(mRecent.size()) > mHistory) {
+            mRecent.pop_front();
+        }
+    }
+
+    void LatencyTracer::reset() {
+        QMutexLocker locker(&mMutex);
+        for (auto &stage : mStages) {
+            stage.clear();
+        }
+        mTotal.clear();
+        mRecent.clear();
+    }
+
+    QStringList LatencyTracer::summaryLines() const {
+        QStringList lines;
+        QMutexLocker locker(&mMutex);
+        const auto line = [](const QString &name, const LatencyHistogram &histogram) {
+            return QString("%1 p50 %2 p95 %3 p99 %4 max %5 ms")
+                .arg(name, -7)
+                .arg(histogram.percentileMs(0.50), 6, 'f', 1)
+                .arg(histogram.percentileMs(0.95), 6, 'f', 1)
+                .arg(histogram.percentileMs(0.99), 6, 'f', 1)
+                .arg(histogram.maxMs(), 6, 'f', 1);
+        };
+        for (int i = 0; i < StageCount; ++i) {
+            if (mStages[i].count() > 0) {
+                lines << line(stageName(static_cast<TraceStage>(i)), mStages[i]);
+            }
+        }
+        if (mTotal.count() > 0) {
+            lines << line("total", mTotal) + QString(" (%1 frames)").arg(mTotal.count());
+        }
+        return lines;
+    }
+
+    void LatencyTracer::exportTrace() {
+        if (!mEnabled) {
+            return;
+        }
+
+        for (const auto &line : summaryLines()) {
+            LOG_F(INFO, "Latency %s", line.toStdString().c_str());
+        }
+
+        const QString fileName = QString("latency_%1.json")
+            .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"));
+        exportChromeTrace(QDir(mTraceDir).filePath(fileName));
+    }
+
+    bool LatencyTracer::exportChromeTrace(const QString &filePath) const {
+        QJsonArray events;
+        // One track per stage, the spans of a frame are linked by the frame id in args
+        const auto metadata = [](const char *name, int tid, const QString &value) {
+            QJsonObject event;
+            event["name"] = name;
+            event["ph"] = "M";
+            event["pid"] = TracePid;
+            event["tid"] = tid;
+            event["args"] = QJsonObject{{"name", value}};
+            return event;
+        };
+        events.append(metadata("process_name", 0, QStringLiteral("detection pipeline")));
+        for (int i = 1; i < StageCount; ++i) {
+            events.append(metadata("thread_name", i, QString("%1 %2").arg(i).arg(stageName(static_cast<TraceStage>(i)))));
+        }
+
+        {
+            QMutexLocker locker(&mMutex);
+            if (mRecent.empty()) {
+                return false;
+            }
+            for (const auto &record : mRecent) {
+                int64_t previous = 0;
+                for (int i = 0; i < StageCount; ++i) {
+                    const int64_t stamp = record.trace.stamps[i];
+                    if (stamp <= 0) {
+                        continue;
+                    }
+                    if (previous > 0) {
+                        QJsonObject event;
+                        event["name"] = stageName(static_cast<TraceStage>(i));
+                        event["cat"] = "frame";
+                        event["ph"] = "X";
+                        event["ts"] = static_cast<qint64>(previous);
+                        event["dur"] = static_cast<qint64>(stamp - previous);
+                        event["pid"] = TracePid;
+                        event["tid"] = i;
+                        event["args"] = QJsonObject{{"frame", static_cast<qint64>(record.trace.id)},
+                                                    {"flag", record.sourceFlag}};
+                        events.append(event);
+                    }
+                    previous = stamp;
+                }
+            }
+        }
+
+        QDir().mkpath(QFileInfo(filePath).absolutePath());
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            LOG_F(ERROR, "Failed to write latency trace to %s", filePath.toStdString().c_str());
+            return false;
+        }
+        QJsonObject root;
+        root["traceEvents"] = events;
+        root["displayTimeUnit"] = "ms";
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        LOG_F(INFO, "Latency trace written to %s", filePath.toStdString().c_str());
+        return true;
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+
+#include "TSingleton.h"
+#include "MetricsRegistry.h"
+
+namespace TF {
+
+    // Points a detection frame passes on its way from the demuxer to the ZMQ publisher
+    enum class TraceStage : int {
+        Read = 0,       // av_read_frame returned the packet
+        Decoded,        // the decoder output the frame
+        Converted,      // converted to QImage on the decode thread
+        Queued,         // copied into the detection queue on the GUI thread
+        Dequeued,       // picked up by the detector thread
+        Inferred,       // inference finished
+        Processed,      // tracking, measurements and the result image are ready
+        Saved,          // sample images written by the save thread
+        Published,      // result handed to the ZMQ publisher
+        Count
+    };
+
+    // Per-frame stamps in microseconds of the steady clock, 0 = stage not reached. The decoder
+    // stamps with AbstractVideoThread::traceTime, which reads the same clock.
+    struct FrameTrace {
+        uint64_t id{0};
+        std::array<int64_t, static_cast<int>(TraceStage::Count)> stamps{};
+
+        [[nodiscard]] bool valid() const { return id != 0; }
+
+        void mark(TraceStage stage);
+    };
+
+    // Plain counterpart of MetricHistogram, used under the tracer lock and kept for the whole session
+    class LatencyHistogram {
+    public:
+        void add(int64_t us);
+
+        void clear();
+
+        [[nodiscard]] int64_t count() const { return mCount; }
+
+        // Upper edge of the bucket holding the p-th fraction of the samples, in milliseconds
+        [[nodiscard]] double percentileMs(double p) const;
+
+        [[nodiscard]] double maxMs() const { return static_cast<double>(mMaxUs) / 1000.0; }
+
+    private:
+        std::array<int64_t, HdrBuckets::Count> mBuckets{};
+        int64_t mCount{0};
+        int64_t mMaxUs{0};
+    };
+
+    // Collects finished frame traces into one histogram per stage (time since the previous
+    // reached stage) plus the end-to-end total, and keeps the most recent traces for export
+    // as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+    class LatencyTracer : public TBase::TSingleton<LatencyTracer> {
+    public:
+        void init();
+
+        [[nodiscard]] bool isEnabled() const { return mEnabled; }
+
+        [[nodiscard]] bool isOverlayEnabled() const { return mEnabled && mOverlay; }
+
+        static int64_t nowUs();
+
+        // Starts a trace from the decoder stamps, invalid when tracing is off
+        FrameTrace begin(int64_t readUs, int64_t decodedUs, int64_t convertedUs);
+
+        // Records a frame that will not be stamped any further
+        void finish(const FrameTrace &trace, const QString &sourceFlag);
+
+        // Drops the statistics of the previous detection session
+        void reset();
+
+        // One line per stage with p50/p95/p99, for the debug overlay
+        [[nodiscard]] QStringList summaryLines() const;
+
+        // Writes the recent traces to LatencyTraceDir and logs the summary
+        void exportTrace();
+
+        bool exportChromeTrace(const QString &filePath) const;
+
+        static const char *stageName(TraceStage stage);
+
+    private:
+        friend class TBase::TSingleton<LatencyTracer>;
+
+        LatencyTracer() = default;
+
+        struct Record {
+            FrameTrace trace;
+            QString sourceFlag;
+        };
+
+        bool mEnabled{false};
+        bool mOverlay{false};
+        int mHistory{2000};
+        QString mTraceDir;
+
+        std::atomic<uint64_t> mNextId{1};
+
+        mutable QMutex mMutex;
+        std::array<LatencyHistogram, static_cast<int>(TraceStage::Count)> mStages;
+        LatencyHistogram mTotal;
+        std::deque<Record> mRecent;
+    };
+}
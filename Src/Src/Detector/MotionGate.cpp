@@ -0,0 +1,84 @@
+#include "MotionGate.h"
+
+#include <algorithm>
+
+#include <opencv2/imgproc.hpp>
+
+namespace TF {
+
+    namespace {
+        const cv::Size ThumbSize(160, 90);
+        const int GridCols = 8;
+        const int GridRows = 6;
+    }
+
+    void MotionGate::configure(const Params &params) {
+        mParams = params;
+        reset();
+    }
+
+    void MotionGate::reset() {
+        mPrevThumb.release();
+        mLastScore = 0.0f;
+        mHasInferred = false;
+    }
+
+    bool MotionGate::shouldInfer(const cv::Mat &frame) {
+        if (!mParams.enabled || frame.empty()) {
+            return true;
+        }
+
+        cv::Mat thumb;
+        cv::resize(frame, thumb, ThumbSize, 0, 0, cv::INTER_AREA);
+        if (thumb.channels() == 3) {
+            cv::cvtColor(thumb, thumb, cv::COLOR_BGR2GRAY);
+        }
+        else if (thumb.channels() == 4) {
+            cv::cvtColor(thumb, thumb, cv::COLOR_BGRA2GRAY);
+        }
+
+        const auto now = Clock::now();
+        bool changed = true;
+        if (!mPrevThumb.empty()) {
+            mLastScore = changeScore(thumb);
+            changed = mLastScore >= mParams.blockChangeRatio;
+        }
+        mPrevThumb = thumb;
+
+        if (changed) {
+            mLastChange = now;
+        }
+
+        const bool inHold = now - mLastChange < std::chrono::milliseconds(mParams.holdMs);
+        const bool dueByRate = !mHasInferred || now - mLastInfer >= std::chrono::milliseconds(mParams.minIntervalMs);
+        if (changed || inHold || dueByRate) {
+            mHasInferred = true;
+            mLastInfer = now;
+            return true;
+        }
+        return false;
+    }
+
+    float MotionGate::changeScore(const cv::Mat &thumb) const {
+        cv::Mat diff;
+        cv::absdiff(thumb, mPrevThumb, diff);
+        cv::threshold(diff, diff, mParams.pixelDiffThreshold, 255, cv::THRESH_BINARY);
+
+        const int blockW = diff.cols / GridCols;
+        const int blockH = diff.rows / GridRows;
+        float maxRatio = 0.0f;
+        for (int r = 0; r < GridRows; ++r) {
+            for (int c = 0; c < GridCols; ++c) {
+                // The last row/column absorbs the remainder pixels
+                const int x = c * blockW;
+                const int y = r * blockH;
+                const int w = (c == GridCols - 1) ? diff.cols - x : blockW;
+                const int h = (r == GridRows - 1) ? diff.rows - y : blockH;
+                const cv::Rect block(x, y, w, h);
+                const float ratio = static_cast<float>(cv::countNonZero(diff(block))) / static_cast<float>(block.area());
+                maxRatio = std::max(maxRatio, ratio);
+            }
+        }
+        return maxRatio;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+
+#include <opencv2/core.hpp>
+
+namespace TF {
+
+    // Cheap scene-change detector in front of inference. Frames are reduced to a
+    // small gray thumbnail and compared block-wise with the previous one; a
+    // single changed block is enough to request inference so that small, far
+    // flames are not averaged away by a static background.
+    class MotionGate {
+    public:
+        struct Params {
+            bool enabled{false};
+            int pixelDiffThreshold{12};      // gray-level difference counted as changed
+            float blockChangeRatio{0.02f};   // changed-pixel ratio that marks a block as active
+            int minIntervalMs{1000};         // inference runs at least this often
+            int holdMs{2000};                // keep full rate this long after the last change
+        };
+
+        void configure(const Params &params);
+
+        const Params &params() const { return mParams; }
+
+        // Returns true when this frame should go through inference
+        bool shouldInfer(const cv::Mat &frame);
+
+        // Highest changed-pixel ratio over all blocks for the last frame
+        float lastScore() const { return mLastScore; }
+
+        void reset();
+
+    private:
+        float changeScore(const cv::Mat &thumb) const;
+
+        using Clock = std::chrono::steady_clock;
+
+        Params mParams;
+        cv::Mat mPrevThumb;
+        float mLastScore{0.0f};
+        bool mHasInferred{false};
+        Clock::time_point mLastInfer{};
+        Clock::time_point mLastChange{};
+    };
+}
@@ -14,24 +14,114 @@
 
 
 TF::InferenceTRT::InferenceTRT() {
-    init();
+    init(GET_STR_CONFIG("TrtYolo", "EnginePath"));
+}
+
+TF::InferenceTRT::InferenceTRT(const std::string &engine_path) {
+    init(engine_path);
 }
 
 TF::InferenceTRT::~InferenceTRT() {
 }
 
-void TF::InferenceTRT::init() {
-    mEnginePath = GET_STR_CONFIG("TrtYolo", "EnginePath");
+void TF::InferenceTRT::init(const std::string &engine_path) {
+    mEnginePath = engine_path;
+    mDefaultInputSize = GET_INT_CONFIG("TrtYolo", "InputSize");
+    if (mDefaultInputSize <= 0) {
+        mDefaultInputSize = TF_DETECT_IMG_SIZE;
+    }
 
     mOption.enableSwapRB();
-    mModel = std::make_unique<trtyolo::SegmentModel>(mEnginePath, mOption);
+    loadEngine(mEnginePath, mDefaultInputSize);
+    if (mEnginePath != GET_STR_CONFIG("TrtYolo", "EnginePath")) {
+        return;
+    }
+
+    // Optional engines for other resolutions, ExtraEnginePaths[i] is built for ExtraInputSizes[i]
+    std::size_t path_num = 0;
+    std::size_t size_num = 0;
+    TBase::TConfig::instance().getSeqNodeLen({"TrtYolo", "ExtraEnginePaths"}, path_num);
+    TBase::TConfig::instance().getSeqNodeLen({"TrtYolo", "ExtraInputSizes"}, size_num);
+    if (path_num != size_num) {
+        LOG_F(WARNING, "[InferenceTRT] ExtraEnginePaths (%zu) and ExtraInputSizes (%zu) differ, extra engines ignored.",
+              path_num, size_num);
+        return;
+    }
+    for (std::size_t i = 0; i < path_num; ++i) {
+        const auto path = GET_ARR_STR_CONFIG(i, "TrtYolo", "ExtraEnginePaths");
+        const int size = GET_ARR_INT_CONFIG(i, "TrtYolo", "ExtraInputSizes");
+        if (size <= 0 || mModels.count(size) > 0) {
+            LOG_F(WARNING, "[InferenceTRT] Skip engine %s, invalid or duplicated input size %d.", path.c_str(), size);
+            continue;
+        }
+        try {
+            loadEngine(path, size);
+        }
+        catch (const std::exception& ex) {
+            LOG_F(ERROR, "[InferenceTRT] Load engine %s failed, %s.", path.c_str(), ex.what());
+        }
+    }
+}
+
+void TF::InferenceTRT::loadEngine(const std::string& engine_path, int input_size) {
+    mModels[input_size] = std::make_unique<trtyolo::SegmentModel>(engine_path, mOption);
+    LOG_F(INFO, "[InferenceTRT] Engine %s loaded for input size %d.", engine_path.c_str(), input_size);
+}
+
+int TF::InferenceTRT::resolveInputSize(int input_size) const {
+    return mModels.count(input_size) > 0 ? input_size : mDefaultInputSize;
+}
+
+trtyolo::SegmentModel* TF::InferenceTRT::engineFor(int input_size) const {
+    return mModels.at(resolveInputSize(input_size)).get();
+}
+
+std::vector<int> TF::InferenceTRT::inputSizes() const {
+    std::vector<int> sizes;
+    for (const auto& [size, model] : mModels) {
+        sizes.push_back(size);
+    }
+    return sizes;
 }
 
-trtyolo::SegmentRes TF::InferenceTRT::runInference(const cv::Mat& input) {
-    auto frame = input.clone();
-    cv::resize(frame, frame, cv::Size(640, 640));
+trtyolo::SegmentRes TF::InferenceTRT::runInference(const cv::Mat& input, int input_size) {
+    const int size = resolveInputSize(input_size);
+    cv::Mat frame;
+    cv::resize(input, frame, cv::Size(size, size));
     trtyolo::Image img(frame.data, frame.cols, frame.rows);
 
-    auto result = mModel->predict(img);
+    auto result = engineFor(size)->predict(img);
     return result;
 }
+
+std::vector<trtyolo::SegmentRes> TF::InferenceTRT::runInference(const std::vector<cv::Mat>& inputs, int input_size) {
+    std::vector<trtyolo::SegmentRes> results;
+    results.reserve(inputs.size());
+    const int size = resolveInputSize(input_size);
+    auto* model = engineFor(size);
+
+    // trtyolo::Image only wraps the pixels, keep the resized frames alive until predict returns
+    std::vector<cv::Mat> frames;
+    frames.reserve(inputs.size());
+    for (const auto& input : inputs) {
+        cv::Mat frame;
+        cv::resize(input, frame, cv::Size(size, size));
+        frames.emplace_back(std::move(frame));
+    }
+
+    const size_t batch = static_cast<size_t>(std::max(1, model->batch_size()));
+    for (size_t begin = 0; begin < frames.size(); begin += batch) {
+        const size_t end = std::min(frames.size(), begin + batch);
+        std::vector<trtyolo::Image> images;
+        images.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            images.emplace_back(frames[i].data, frames[i].cols, frames[i].rows);
+        }
+
+        auto chunk = model->predict(images);
+        for (auto& res : chunk) {
+            results.emplace_back(std::move(res));
+        }
+    }
+    return results;
+}
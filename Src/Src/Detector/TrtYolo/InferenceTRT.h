@@ -12,9 +12,12 @@
 #define FIREAPP_INFERENCETRT_H
 
 #include <atomic>
+#include <map>
+#include <vector>
 #include <opencv2/opencv.hpp>
 
 #include "trtyolo.hpp"
+#include "DetectDef.h"
 
 
 namespace TF {
@@ -23,20 +26,41 @@ namespace TF {
     public:
         InferenceTRT();
 
+        // Loads engine_path as the default engine; the TrtYolo extra engines only come
+        // with the configured EnginePath, they were built from that model
+        explicit InferenceTRT(const std::string &engine_path);
+
         ~InferenceTRT();
 
     private:
-        void init();
+        void init(const std::string &engine_path);
+
+        void loadEngine(const std::string &engine_path, int input_size);
+
+        trtyolo::SegmentModel *engineFor(int input_size) const;
 
     public:
-        trtyolo::SegmentRes runInference(const cv::Mat &input);
+        // input_size picks the engine built for that resolution, 0 or an unknown size uses the default engine
+        trtyolo::SegmentRes runInference(const cv::Mat &input, int input_size = 0);
+
+        // Runs all inputs through the engine in chunks of its batch size
+        std::vector<trtyolo::SegmentRes> runInference(const std::vector<cv::Mat> &inputs, int input_size = 0);
+
+        // Resolution the engine for input_size actually runs at
+        int resolveInputSize(int input_size) const;
+
+        int defaultInputSize() const { return mDefaultInputSize; }
+
+        std::vector<int> inputSizes() const;
 
     private:
         std::atomic<bool> mInitialized {false};
         std::string mEnginePath {};
 
         trtyolo::InferOption mOption;
-        std::unique_ptr<trtyolo::SegmentModel> mModel;
+        // A TensorRT engine has a fixed input shape, one engine per supported resolution
+        std::map<int, std::unique_ptr<trtyolo::SegmentModel>> mModels;
+        int mDefaultInputSize {TF_DETECT_IMG_SIZE};
 
     };
 };
@@ -45,8 +45,11 @@ int main(int argc, char *argv[]) {
     if (dumpLayout) {
         a.processEvents();
         win.dumpLayoutDiagnostics();
+        TF::AppMonitor::shutdownApp();
         return 0;
     }
 
-    return QApplication::exec();
+    const int ret = QApplication::exec();
+    TF::AppMonitor::shutdownApp();
+    return ret;
 }
\ No newline at end of file
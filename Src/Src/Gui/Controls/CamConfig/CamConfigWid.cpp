@@ -21,9 +21,11 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QPoint>
+#include <QPointer>
 #include <QRect>
 #include <QPushButton>
 #include <QColor>
+#include <QCoreApplication>
 #include <QSizePolicy>
 #include <QShowEvent>
 #include <QVBoxLayout>
@@ -458,6 +460,7 @@ void TF::CamConfigWid::loadRanges() {
         qWarning("GetExposureRange failed: %s", error.c_str());
     }
 
+    client.SetZoomLimits(mFocusMinNormalized, mFocusMaxNormalized);
     mRangesLoaded = true;
     updateInfoDisplay();
 }
@@ -547,16 +550,14 @@ void TF::CamConfigWid::adjustFocus(double delta) {
         return;
     }
 
-    auto &client = HKCamZmqClient::instance();
-    std::string error;
-    QJsonObject raw;
-    if (client.ZoomStep(delta, std::nullopt, raw, error)) {
-        const auto zoom = readDoubleFromKeys(raw, {"value", "zoom"}, mFocusValue + delta);
-        mFocusValue = clampNormalized(zoom, mFocusMinNormalized, mFocusMaxNormalized);
-    } else {
-        qWarning("ZoomStep failed: %s", error.c_str());
-    }
+    // 连续步进在客户端合并为最新的绝对目标，界面先按目标值显示
+    mFocusValue = clampNormalized(mFocusValue + delta, mFocusMinNormalized, mFocusMaxNormalized);
     updateInfoDisplay();
+
+    QPointer<CamConfigWid> self(this);
+    HKCamZmqClient::instance().ZoomStepCoalesced(delta, std::nullopt, [self](const RpcCallResult &result) {
+        postToUi(self, result, &CamConfigWid::handleFocusResult);
+    });
 }
 
 void TF::CamConfigWid::setFocusNormalized(double value) {
@@ -564,16 +565,47 @@ void TF::CamConfigWid::setFocusNormalized(double value) {
         return;
     }
 
-    auto &client = HKCamZmqClient::instance();
     const double target = clampNormalized(value, mFocusMinNormalized, mFocusMaxNormalized);
-    std::string error;
-    QJsonObject raw;
-    if (client.SetZoomAbs(target, std::nullopt, raw, error)) {
-        const auto zoom = readDoubleFromKeys(raw, {"value", "zoom"}, target);
-        mFocusValue = clampNormalized(zoom, mFocusMinNormalized, mFocusMaxNormalized);
-    } else {
-        qWarning("SetZoomAbs failed: %s", error.c_str());
+    mFocusValue = target;
+    updateInfoDisplay();
+
+    QPointer<CamConfigWid> self(this);
+    HKCamZmqClient::instance().SubmitZoomTarget(target, std::nullopt, [self](const RpcCallResult &result) {
+        postToUi(self, result, &CamConfigWid::handleFocusResult);
+    });
+}
+
+void TF::CamConfigWid::postToUi(const QPointer<CamConfigWid> &self, const RpcCallResult &result,
+                                 void (CamConfigWid::*handler)(const RpcCallResult &)) {
+    // 在 ZMQ 线程上不能解引用控件（可能正在析构），借助 qApp 排队，到 GUI 线程再判断控件是否还在
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [self, result, handler]() {
+        if (self) {
+            (self.data()->*handler)(result);
+        }
+    }, Qt::QueuedConnection);
+}
+
+void TF::CamConfigWid::handleFocusResult(const RpcCallResult &result) {
+    if (!result.success) {
+        if (result.errorReason != QStringLiteral("Superseded")) {
+            qWarning("Zoom failed: %s", result.errorReason.toStdString().c_str());
+        }
+        return;
+    }
+
+    const auto zoom = readDoubleFromKeys(result.response.data, {"value", "zoom"}, mFocusValue);
+    mFocusValue = clampNormalized(zoom, mFocusMinNormalized, mFocusMaxNormalized);
+    updateInfoDisplay();
+}
+
+void TF::CamConfigWid::handleExposureResult(const RpcCallResult &result) {
+    if (!result.success) {
+        qWarning("SetExposureBySeconds failed: %s", result.errorReason.toStdString().c_str());
+        return;
     }
+
+    const auto exposure = readDoubleFromKeys(result.response.data, {"value", "exposure", "exposure_s"}, mExposureValue);
+    mExposureValue = clampNormalized(exposure, mExposureMinNormalized, mExposureMaxNormalized);
     updateInfoDisplay();
 }
 
@@ -591,19 +623,16 @@ void TF::CamConfigWid::setExposureNormalized(double value) {
         return;
     }
 
-    auto &client = HKCamZmqClient::instance();
     const double target = clampNormalized(value, mExposureMinNormalized, mExposureMaxNormalized);
     const double exposureSeconds = mapToDisplay(target, mExposureDisplayMin, mExposureDisplayMax);
-
-    std::string error;
-    QJsonObject raw;
-    if (client.SetExposureBySeconds(exposureSeconds, true, true, raw, error)) {
-        const auto exposure = readDoubleFromKeys(raw, {"value", "exposure", "exposure_s"}, target);
-        mExposureValue = clampNormalized(exposure, mExposureMinNormalized, mExposureMaxNormalized);
-    } else {
-        qWarning("SetExposureBySeconds failed: %s", error.c_str());
-    }
+    mExposureValue = target;
     updateInfoDisplay();
+
+    QPointer<CamConfigWid> self(this);
+    HKCamZmqClient::instance().SetExposureBySecondsAsync(exposureSeconds, true, true,
+                                                         [self](const RpcCallResult &result) {
+        postToUi(self, result, &CamConfigWid::handleExposureResult);
+    });
 }
 
 void TF::CamConfigWid::setExposureAutoInternal() {
@@ -18,6 +18,7 @@
 #include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QJsonObject>
+#include <QPointer>
 #include <initializer_list>
 
 class QLabel;
@@ -90,6 +91,12 @@ namespace TF {
         void setExposureNormalized(double value);
         void setExposureAutoInternal();
 
+        // 异步调用结果回到 GUI 线程后处理，控件是否还在也在 GUI 线程判断
+        static void postToUi(const QPointer<CamConfigWid> &self, const RpcCallResult &result,
+                             void (CamConfigWid::*handler)(const RpcCallResult &));
+        void handleFocusResult(const RpcCallResult &result);
+        void handleExposureResult(const RpcCallResult &result);
+
         double mapToDisplay(double normalized, double min, double max) const;
         double clampNormalized(double value, double min, double max) const;
         double readDoubleFromKeys(const QJsonObject &obj, const std::initializer_list<QString> &keys, double defaultValue) const;
@@ -15,6 +15,7 @@ Copyright(C), tao.jing All rights reserved
 #include <QProcess>
 #include <QToolButton>
 #include <QStringList>
+#include <QStyle>
 
 namespace TF {
 
@@ -46,6 +47,18 @@ namespace TF {
         }
     }
 
+    void FuSideTabBar::setStartupStatus(const QString &text, const QString &detail, const QString &state) {
+        auto *label = mUi->mStartupLabel;
+        if (label == nullptr) {
+            return;
+        }
+        label->setText(text);
+        label->setToolTip(detail);
+        label->setProperty("startupState", state);
+        label->style()->unpolish(label);
+        label->style()->polish(label);
+    }
+
     void FuSideTabBar::setupUi() {
         mUi = new FuSideTabBar_Ui();
         mUi->setupUi(this);
@@ -27,6 +27,9 @@ namespace TF {
         [[nodiscard]] int currentIndex() const;
         void setCurrentIndex(int index);
 
+        // Short startup summary under the brand, detail goes to the tooltip
+        void setStartupStatus(const QString &text, const QString &detail, const QString &state);
+
     signals:
         void tabSelected(int index);
         void cameraConfigRequested();
@@ -101,6 +101,10 @@ namespace TF {
         brandLabel->setAlignment(Qt::AlignCenter);
         brandLabel->setObjectName("SideBrand");
 
+        mStartupLabel = new QLabel(mWid);
+        mStartupLabel->setAlignment(Qt::AlignCenter);
+        mStartupLabel->setObjectName("SideSubBrand");
+
         auto *divider = new QFrame(mWid);
         divider->setObjectName("SideDivider");
         divider->setFrameShape(QFrame::HLine);
@@ -123,6 +127,7 @@ namespace TF {
         }
 
         mLayout->addWidget(brandLabel);
+        mLayout->addWidget(mStartupLabel);
         mLayout->addWidget(divider);
 
         for (auto *button : mButtons) {
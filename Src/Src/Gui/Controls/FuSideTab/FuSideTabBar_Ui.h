@@ -15,6 +15,7 @@ Copyright(C), tao.jing All rights reserved
 #include <QToolButton>
 #include <QVBoxLayout>
 #include <QList>
+#include <QLabel>
 
 namespace TF {
 
@@ -26,6 +27,7 @@ namespace TF {
     protected:
         QWidget *mWid {nullptr};
         QVBoxLayout *mLayout {nullptr};
+        QLabel *mStartupLabel {nullptr};
         QList<QToolButton*> mButtons {};
         QToolButton *mNewExperimentButton {nullptr};
         QToolButton *mCamConfigButton {nullptr};
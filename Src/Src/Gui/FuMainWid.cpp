@@ -12,8 +12,10 @@ Copyright(C), tao.jing All rights reserved
 #include "FuMainWid_Ui.h"
 #include "FuSideTabBar.h"
 #include "FuMainMeaPage.h"
+#include "FuStatusPage.h"
 #include "ExpInfoDialog.h"
 #include "ExperimentParamManager.h"
+#include "StartupSequencer.h"
 #include "TConfig.h"
 #include <QApplication>
 #include <QFile>
@@ -23,6 +25,7 @@ Copyright(C), tao.jing All rights reserved
 #include <QScreen>
 #include <QLayout>
 #include <QSizePolicy>
+#include <QtConcurrent/QtConcurrent>
 #include <algorithm>
 #include <vector>
 
@@ -186,9 +189,43 @@ void TF::FuMainWid::setupConnections() {
         }
     });
 
+    auto &startup = StartupSequencer::instance();
+    connect(&startup, &StartupSequencer::stageChanged, this, &FuMainWid::updateStartupStatus);
+    connect(&startup, &StartupSequencer::finished, this, &FuMainWid::updateStartupStatus);
+    updateStartupStatus();
+
     mUi->mSideTabBar->setCurrentIndex(0);
 }
 
+void TF::FuMainWid::updateStartupStatus() {
+    const auto stages = StartupSequencer::instance().stages();
+    int ready = 0;
+    int notReady = 0;
+    QStringList lines;
+    for (const auto &stage : stages) {
+        if (stage.state == StartupState::Ready) {
+            ++ready;
+        } else if (stage.state == StartupState::Failed || stage.state == StartupState::Skipped) {
+            ++notReady;
+        }
+        lines << QString("%1: %2").arg(stage.title, FuStatusPage::stateText(stage.state));
+    }
+
+    QString text;
+    QString state;
+    if (ready + notReady < stages.size()) {
+        text = tr("启动 %1/%2").arg(ready).arg(stages.size());
+        state = "running";
+    } else if (notReady > 0) {
+        text = tr("%1项异常").arg(notReady);
+        state = "failed";
+    } else {
+        text = tr("就绪");
+        state = "ready";
+    }
+    mUi->mSideTabBar->setStartupStatus(text, lines.join('\n'), state);
+}
+
 namespace {
     TF::HKCamServerConfig DefaultHKCamServerConfig()
     {
@@ -206,20 +243,27 @@ namespace {
         cfg.startPollIntervalMs = 200;
         cfg.createNoWindow = true;
         cfg.allowStopExternal = false;
+        cfg.keepAlive = GET_BOOL_CONFIG("Onvif", "keepAlive");
+        cfg.expectedVersion = GET_STR_CONFIG("Onvif", "expectedVersion");
         return cfg;
     }
 }
 
 void TF::FuMainWid::startHKCamPythonServer()
 {
-    std::string error;
-    if (!mCamPythonServer.StartBlocking(DefaultHKCamServerConfig(), error))
-    {
-        qWarning().noquote() << "Failed to start HKCam python server:" << QString::fromStdString(error);
-    }
+    // 启动握手可能持续数秒，放到后台执行，避免阻塞主界面显示
+    const auto cfg = DefaultHKCamServerConfig();
+    mCamServerFuture = QtConcurrent::run([this, cfg]() {
+        std::string error;
+        if (!mCamPythonServer.StartBlocking(cfg, error))
+        {
+            qWarning().noquote() << "Failed to start HKCam python server:" << QString::fromStdString(error);
+        }
+    });
 }
 
 void TF::FuMainWid::stopHKCamPythonServer()
 {
+    mCamServerFuture.waitForFinished();
     mCamPythonServer.Stop();
 }
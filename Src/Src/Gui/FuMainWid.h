@@ -12,6 +12,7 @@ Copyright(C), tao.jing All rights reserved
 #define FIREUI_FUMAINWID_H
 
 #include <QWidget>
+#include <QFuture>
 
 #include "HKCamPythonServer.h"
 
@@ -42,6 +43,8 @@ namespace TF {
 
         void initActions();
 
+        void updateStartupStatus();
+
         void startHKCamPythonServer();
         void stopHKCamPythonServer();
 
@@ -54,6 +57,7 @@ namespace TF {
     private:
         FuMainWid_Ui *mUi;
         HKCamPythonServer mCamPythonServer;
+        QFuture<void> mCamServerFuture;
 
     };
 
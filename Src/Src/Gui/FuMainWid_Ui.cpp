@@ -13,9 +13,9 @@ Copyright(C), tao.jing All rights reserved
 #include "ExperimentDataViewPage.h"
 #include "FuFlameCurvePage.h"
 #include "FuSideTabBar.h"
+#include "FuStatusPage.h"
 #include "TFMeaManager.h"
 
-#include <QLabel>
 #include <QObject>
 #include <QSizePolicy>
 #include <QStackedLayout>
@@ -51,28 +51,13 @@ void TF::FuMainWid_Ui::setupUi(QWidget *wid) {
     mFlameCurvePage->setObjectName("FlameCurvePage");
     mFlameCurvePage->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
-    auto createPage = [](const QString &title, const QString &desc) {
-        auto *page = new QWidget();
-        auto *layout = new QVBoxLayout(page);
-        layout->setAlignment(Qt::AlignCenter);
-
-        auto *titleLabel = new QLabel(title, page);
-        titleLabel->setAlignment(Qt::AlignCenter);
-        titleLabel->setProperty("title", true);
-
-        auto *descLabel = new QLabel(desc, page);
-        descLabel->setAlignment(Qt::AlignCenter);
-        descLabel->setProperty("description", true);
-
-        layout->addWidget(titleLabel);
-        layout->addWidget(descLabel);
-        return page;
-    };
+    mStatusPage = new FuStatusPage(mContentWidget);
+    mStatusPage->setObjectName("StatusPage");
 
     mPages.append(mMainMeaPage);
     mPages.append(mExperimentViewPage);
     mPages.append(mFlameCurvePage);
-    mPages.append(createPage(QObject::tr("状态"), QObject::tr("当前运行状态详情")));
+    mPages.append(mStatusPage);
 
     for (int i = 0; i < mPages.size(); ++i) {
         auto *page = mPages.at(i);
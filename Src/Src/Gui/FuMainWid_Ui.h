@@ -23,6 +23,7 @@ namespace TF {
     class FuCamPage;
     class FuFlameCurvePage;
     class ExperimentDataViewPage;
+    class FuStatusPage;
 
     class FuMainWid_Ui {
 
@@ -48,6 +49,7 @@ namespace TF {
         FuCamPage *mCamPage {nullptr};
         FuFlameCurvePage *mFlameCurvePage {nullptr};
         ExperimentDataViewPage *mExperimentViewPage {nullptr};
+        FuStatusPage *mStatusPage {nullptr};
     };
 
 };
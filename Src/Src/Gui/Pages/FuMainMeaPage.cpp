@@ -3,11 +3,13 @@
 #include "AppMonitor.h"
 #include "qthelper.h"
 #include "videohelper.h"
+#include "videoutil.h"
 #include "videowidgetx.h"
 #include "TConfig.h"
 #include "FuVideoButtons.h"
 #include "DetectManager.h"
 #include "AiResultSaveManager.h"
+#include "AnnotatedVideoManager.h"
 #include "ExperimentParamManager.h"
 #include "ThermalManager.h"
 #include "ThermalCamera.h"
@@ -106,6 +108,17 @@ void TF::FuMainMeaPage::initForm() {
     videoPara.connectTimeout = 2000;
     videoPara.decodeAudio = false;
     videoPara.playAudio = false;
+    videoPara.decodeThreads = GET_INT_CONFIG("RGBCam", "DecodeThreads");
+    videoPara.threadType = QString::fromStdString(GET_STR_CONFIG("RGBCam", "DecodeThreadType"));
+    videoPara.lowLatency = GET_BOOL_CONFIG("RGBCam", "DecodeLowLatency");
+    VideoUtil::setDecodeBudget(GET_INT_CONFIG("RGBCam", "DecodeThreadBudget"),
+                               GET_INT_CONFIG("RGBCam", "DecodeStreams"));
+    if (GET_BOOL_CONFIG("RGBCam", "EventRecord")) {
+        videoPara.eventPreTime = GET_INT_CONFIG("RGBCam", "EventPreSeconds");
+        videoPara.eventPostTime = GET_INT_CONFIG("RGBCam", "EventPostSeconds");
+        videoPara.eventPath = QDir(QDir::currentPath()).filePath(
+            QString::fromStdString(GET_STR_CONFIG("RGBCam", "EventRecordDir")));
+    }
     mUi->mVideoWid->setVideoPara(videoPara);
 
     mUi->mVideoWid->hideButtonAll();
@@ -329,12 +342,14 @@ void TF::FuMainMeaPage::onRecordingToggled(bool checked) {
         }
 
         AiResultSaveManager::instance().setEnabled(true);
+        AnnotatedVideoManager::instance().start(mgr.experimentDir());
         updateRecordingStatus(true);
         return;
     }
 
     ExperimentParamManager::instance().stopRecording();
     AiResultSaveManager::instance().setEnabled(false);
+    AnnotatedVideoManager::instance().stop();
     updateRecordingStatus(false);
 }
 
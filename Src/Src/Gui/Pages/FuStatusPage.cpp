@@ -0,0 +1,274 @@
+/**************************************************************************
+
+Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : FuStatusPage.cpp
+   Author : tao.jing
+   Date   : 2026/10/19
+   Brief  : 运行状态页面，显示各子系统的启动状态和耗时，以及检测模型的切换与耗时统计
+**************************************************************************/
+#include "FuStatusPage.h"
+#include "DetectManager.h"
+
+#include <QComboBox>
+#include <QCoreApplication>
+#include <QFrame>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QStyle>
+#include <QTimer>
+#include <QVBoxLayout>
+
+namespace TF {
+
+    FuStatusPage::FuStatusPage(QWidget *parent) : QWidget(parent) {
+        setupUi();
+
+        auto &startup = StartupSequencer::instance();
+        connect(&startup, &StartupSequencer::stageChanged, this, &FuStatusPage::onStageChanged);
+        connect(&startup, &StartupSequencer::finished, this, &FuStatusPage::onStartupFinished);
+
+        // GUI线程上的阶段在窗口创建前已经完成，后台阶段也可能已经结束
+        refreshRows();
+
+        // 模型在后台线程加载和切换，这里只轮询状态
+        mModelTimer = new QTimer(this);
+        mModelTimer->setInterval(1000);
+        connect(mModelTimer, &QTimer::timeout, this, &FuStatusPage::refreshModels);
+        mModelTimer->start();
+        refreshModels();
+    }
+
+    QString FuStatusPage::stateText(StartupState state) {
+        switch (state) {
+            case StartupState::Pending: return QCoreApplication::translate("Page", "等待");
+            case StartupState::Running: return QCoreApplication::translate("Page", "启动中");
+            case StartupState::Ready: return QCoreApplication::translate("Page", "就绪");
+            case StartupState::Failed: return QCoreApplication::translate("Page", "失败");
+            case StartupState::Skipped: return QCoreApplication::translate("Page", "未启动");
+        }
+        return QStringLiteral("---");
+    }
+
+    void FuStatusPage::setupUi() {
+        setObjectName("StatusPage");
+
+        auto *mainLayout = new QVBoxLayout(this);
+        mainLayout->setContentsMargins(12, 12, 12, 12);
+        mainLayout->setSpacing(8);
+
+        auto *titleLabel = new QLabel(QCoreApplication::translate("Page", "启动状态"), this);
+        titleLabel->setObjectName("PanelTitle");
+        titleLabel->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+
+        auto *frame = new QFrame(this);
+        frame->setObjectName("StatisticsFrame");
+        auto *gridLayout = new QGridLayout(frame);
+        gridLayout->setContentsMargins(12, 12, 12, 12);
+        gridLayout->setHorizontalSpacing(24);
+        gridLayout->setVerticalSpacing(6);
+
+        const auto stages = StartupSequencer::instance().stages();
+        for (int i = 0; i < stages.size(); ++i) {
+            const auto &stage = stages.at(i);
+
+            auto *nameLabel = new QLabel(stage.title, frame);
+            nameLabel->setObjectName("CurveNameLabel");
+
+            StageRow row;
+            row.stateLabel = new QLabel(frame);
+            row.stateLabel->setObjectName("StartupStateLabel");
+            row.timeLabel = new QLabel(frame);
+            row.timeLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
+            gridLayout->addWidget(nameLabel, i, 0);
+            gridLayout->addWidget(row.stateLabel, i, 1);
+            gridLayout->addWidget(row.timeLabel, i, 2);
+            mRows.insert(stage.name, row);
+        }
+        gridLayout->setColumnStretch(3, 1);
+        gridLayout->setRowStretch(static_cast<int>(stages.size()), 1);
+
+        mSummaryLabel = new QLabel(frame);
+        mSummaryLabel->setObjectName("CurveNameLabel");
+
+        auto *modelTitleLabel = new QLabel(QCoreApplication::translate("Page", "检测模型"), this);
+        modelTitleLabel->setObjectName("PanelTitle");
+        modelTitleLabel->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+
+        mainLayout->addWidget(titleLabel);
+        mainLayout->addWidget(mSummaryLabel);
+        mainLayout->addWidget(frame, 1);
+        mainLayout->addWidget(modelTitleLabel);
+        mainLayout->addWidget(createModelPanel());
+    }
+
+    QWidget *FuStatusPage::createModelPanel() {
+        auto *frame = new QFrame(this);
+        frame->setObjectName("StatisticsFrame");
+        auto *layout = new QVBoxLayout(frame);
+        layout->setContentsMargins(12, 12, 12, 12);
+        layout->setSpacing(6);
+
+        mModelCombo = new QComboBox(frame);
+        mModelCombo->setMinimumWidth(160);
+        for (const auto &name : TFDetectManager::instance().registeredModels()) {
+            mModelCombo->addItem(QString::fromStdString(name));
+        }
+
+        mSwapModelButton = new QPushButton(QCoreApplication::translate("Page", "切换"), frame);
+        mSwapModelButton->setObjectName(QStringLiteral("PrimaryButton"));
+        mRollbackModelButton = new QPushButton(QCoreApplication::translate("Page", "回滚"), frame);
+        mRollbackModelButton->setObjectName(QStringLiteral("AccentButton"));
+        connect(mSwapModelButton, &QPushButton::clicked, this, &FuStatusPage::onSwapModelClicked);
+        connect(mRollbackModelButton, &QPushButton::clicked, this, &FuStatusPage::onRollbackModelClicked);
+
+        mModelStateLabel = new QLabel(frame);
+        mModelStateLabel->setObjectName("CurveNameLabel");
+
+        auto *controlLayout = new QHBoxLayout();
+        controlLayout->setSpacing(8);
+        controlLayout->addWidget(mModelCombo);
+        controlLayout->addWidget(mSwapModelButton);
+        controlLayout->addWidget(mRollbackModelButton);
+        controlLayout->addWidget(mModelStateLabel, 1);
+
+        mModelStatsLayout = new QGridLayout();
+        mModelStatsLayout->setHorizontalSpacing(24);
+        mModelStatsLayout->setVerticalSpacing(6);
+        const QStringList headers {
+            QCoreApplication::translate("Page", "模型"),
+            QCoreApplication::translate("Page", "帧数"),
+            QCoreApplication::translate("Page", "平均"),
+            QCoreApplication::translate("Page", "最大"),
+            QCoreApplication::translate("Page", "最近"),
+        };
+        for (int i = 0; i < headers.size(); ++i) {
+            auto *header = new QLabel(headers.at(i), frame);
+            header->setObjectName("CurveNameLabel");
+            mModelStatsLayout->addWidget(header, 0, i, i == 0 ? Qt::AlignLeft : Qt::AlignRight);
+        }
+        mModelStatsLayout->setColumnStretch(headers.size(), 1);
+
+        layout->addLayout(controlLayout);
+        layout->addLayout(mModelStatsLayout);
+        return frame;
+    }
+
+    void FuStatusPage::refreshModels() {
+        auto &detect = TFDetectManager::instance();
+        const bool ready = detect.loadState() == DetectorLoadState::Ready;
+        const bool swapping = detect.isSwapLoading();
+        mSwapModelButton->setEnabled(ready && !swapping);
+        mRollbackModelButton->setEnabled(ready && !swapping);
+
+        if (!ready) {
+            mModelStateLabel->setText(QCoreApplication::translate("Page", "模型未就绪"));
+        } else if (swapping) {
+            mModelStateLabel->setText(QCoreApplication::translate("Page", "当前 %1，新模型加载中…")
+                                          .arg(QString::fromStdString(detect.activeModelName())));
+        } else {
+            mModelStateLabel->setText(QCoreApplication::translate("Page", "当前 %1")
+                                          .arg(QString::fromStdString(detect.activeModelName())));
+        }
+
+        const auto msText = [](double ms) {
+            return QCoreApplication::translate("Page", "%1 ms").arg(ms, 0, 'f', 1);
+        };
+        for (const auto &stat : detect.modelLatencyStats()) {
+            const auto name = QString::fromStdString(stat.name);
+            auto it = mModelStatsRows.find(name);
+            if (it == mModelStatsRows.end()) {
+                auto *parent = mModelStatsLayout->parentWidget();
+                const int row = mModelStatsLayout->rowCount();
+                ModelStatsRow statsRow;
+                statsRow.framesLabel = new QLabel(parent);
+                statsRow.meanLabel = new QLabel(parent);
+                statsRow.maxLabel = new QLabel(parent);
+                statsRow.lastLabel = new QLabel(parent);
+                mModelStatsLayout->addWidget(new QLabel(name, parent), row, 0);
+                mModelStatsLayout->addWidget(statsRow.framesLabel, row, 1, Qt::AlignRight);
+                mModelStatsLayout->addWidget(statsRow.meanLabel, row, 2, Qt::AlignRight);
+                mModelStatsLayout->addWidget(statsRow.maxLabel, row, 3, Qt::AlignRight);
+                mModelStatsLayout->addWidget(statsRow.lastLabel, row, 4, Qt::AlignRight);
+                it = mModelStatsRows.insert(name, statsRow);
+            }
+            it->framesLabel->setText(QString::number(stat.frames));
+            it->meanLabel->setText(msText(stat.meanMs));
+            it->maxLabel->setText(msText(stat.maxMs));
+            it->lastLabel->setText(msText(stat.lastMs));
+        }
+    }
+
+    void FuStatusPage::onSwapModelClicked() {
+        const auto name = mModelCombo->currentText();
+        if (!TFDetectManager::instance().swapModelAsync(name.toStdString())) {
+            mModelStateLabel->setText(QCoreApplication::translate("Page", "切换到 %1 失败").arg(name));
+            return;
+        }
+        refreshModels();
+    }
+
+    void FuStatusPage::onRollbackModelClicked() {
+        if (!TFDetectManager::instance().rollbackModel()) {
+            mModelStateLabel->setText(QCoreApplication::translate("Page", "没有可回滚的模型"));
+            return;
+        }
+        refreshModels();
+    }
+
+    void FuStatusPage::refreshRows() {
+        const auto &startup = StartupSequencer::instance();
+        int notReady = 0;
+        for (const auto &stage : startup.stages()) {
+            if (stage.state != StartupState::Ready) {
+                ++notReady;
+            }
+
+            const auto it = mRows.constFind(stage.name);
+            if (it == mRows.constEnd()) {
+                continue;
+            }
+
+            auto *stateLabel = it->stateLabel;
+            stateLabel->setText(stateText(stage.state));
+            stateLabel->setToolTip(stage.error);
+            stateLabel->setProperty("startupState", StartupSequencer::stateName(stage.state));
+            stateLabel->style()->unpolish(stateLabel);
+            stateLabel->style()->polish(stateLabel);
+
+            if (stage.durationMs >= 0) {
+                it->timeLabel->setText(QCoreApplication::translate("Page", "%1 ms").arg(stage.durationMs));
+            } else {
+                it->timeLabel->setText(QStringLiteral("---"));
+            }
+        }
+
+        if (!startup.isFinished()) {
+            mSummaryLabel->setText(QCoreApplication::translate("Page", "启动中…"));
+            return;
+        }
+
+        auto text = QCoreApplication::translate("Page", "启动完成，用时 %1 ms").arg(startup.elapsedMs());
+        if (notReady > 0) {
+            text += QCoreApplication::translate("Page", "，%1 项未就绪").arg(notReady);
+        }
+        mSummaryLabel->setText(text);
+    }
+
+    void FuStatusPage::onStageChanged(const QString &name, int state) {
+        Q_UNUSED(name)
+        Q_UNUSED(state)
+        refreshRows();
+    }
+
+    void FuStatusPage::onStartupFinished(qint64 totalMs, int failedCount) {
+        Q_UNUSED(totalMs)
+        Q_UNUSED(failedCount)
+        refreshRows();
+    }
+
+} // TF
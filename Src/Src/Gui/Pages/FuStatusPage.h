@@ -0,0 +1,82 @@
+/**************************************************************************
+
+Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : FuStatusPage.h
+   Author : tao.jing
+   Date   : 2026/10/19
+   Brief  : 运行状态页面，显示各子系统的启动状态和耗时，以及检测模型的切换与耗时统计
+**************************************************************************/
+#ifndef FIREAPP_FUSTATUSPAGE_H
+#define FIREAPP_FUSTATUSPAGE_H
+
+#include <QMap>
+#include <QWidget>
+
+#include "StartupSequencer.h"
+
+class QComboBox;
+class QGridLayout;
+class QLabel;
+class QPushButton;
+class QTimer;
+
+namespace TF {
+
+    class FuStatusPage : public QWidget {
+        Q_OBJECT
+
+    public:
+        explicit FuStatusPage(QWidget *parent = nullptr);
+        ~FuStatusPage() override = default;
+
+        static QString stateText(StartupState state);
+
+    private slots:
+        void onStageChanged(const QString &name, int state);
+
+        void onStartupFinished(qint64 totalMs, int failedCount);
+
+        void onSwapModelClicked();
+
+        void onRollbackModelClicked();
+
+        // 当前模型、切换状态和各模型推理耗时，定时刷新
+        void refreshModels();
+
+    private:
+        void setupUi();
+
+        QWidget *createModelPanel();
+
+        void refreshRows();
+
+    private:
+        struct StageRow {
+            QLabel *stateLabel {nullptr};
+            QLabel *timeLabel {nullptr};
+        };
+
+        struct ModelStatsRow {
+            QLabel *framesLabel {nullptr};
+            QLabel *meanLabel {nullptr};
+            QLabel *maxLabel {nullptr};
+            QLabel *lastLabel {nullptr};
+        };
+
+        QMap<QString, StageRow> mRows;
+        QLabel *mSummaryLabel {nullptr};
+
+        QComboBox *mModelCombo {nullptr};
+        QPushButton *mSwapModelButton {nullptr};
+        QPushButton *mRollbackModelButton {nullptr};
+        QLabel *mModelStateLabel {nullptr};
+        QGridLayout *mModelStatsLayout {nullptr};
+        QMap<QString, ModelStatsRow> mModelStatsRows;
+        QTimer *mModelTimer {nullptr};
+    };
+
+} // TF
+
+#endif //FIREAPP_FUSTATUSPAGE_H
@@ -0,0 +1,313 @@
+#include "HKCamMockServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int kMaxPollMs = 50;
+
+    struct ScheduledReply
+    {
+        Clock::time_point due;
+        std::vector<std::string> envelope;
+        std::string payload;
+
+        bool operator>(const ScheduledReply &other) const { return due > other.due; }
+    };
+
+    struct MockDeviceState
+    {
+        double zoom = 0.0;
+        double exposure = 0.01;
+        bool autoExposure = true;
+    };
+
+    std::string ToPayload(const QJsonObject &obj)
+    {
+        return QJsonDocument(obj).toJson(QJsonDocument::Compact).toStdString();
+    }
+
+    QJsonObject OkReply(int id, const QJsonObject &data)
+    {
+        QJsonObject reply;
+        reply.insert("id", id);
+        reply.insert("ok", true);
+        reply.insert("data", data);
+        return reply;
+    }
+
+    QJsonObject ErrorReply(int id, const QString &type, const QString &message)
+    {
+        QJsonObject error;
+        error.insert("type", type);
+        error.insert("message", message);
+        error.insert("trace", QString());
+
+        QJsonObject reply;
+        reply.insert("id", id);
+        reply.insert("ok", false);
+        reply.insert("error", error);
+        return reply;
+    }
+
+    double Clamp01(double value)
+    {
+        return std::clamp(value, 0.0, 1.0);
+    }
+
+    // 按 op 更新模拟设备状态并构造应答；返回 false 表示未知操作
+    bool HandleOp(const std::string &op, const QJsonObject &params, MockDeviceState &state, QJsonObject &outData)
+    {
+        if (op == "ping") {
+            outData.insert("pong", true);
+        }
+        else if (op == "reconnect") {
+            outData.insert("connected", true);
+        }
+        else if (op == "device_info") {
+            outData.insert("manufacturer", "Mock");
+            outData.insert("model", "HKCam-Mock");
+            outData.insert("firmware", "0.0.0");
+        }
+        else if (op == "get_zoom") {
+            outData.insert("value", state.zoom);
+        }
+        else if (op == "get_zoom_range") {
+            outData.insert("min", 0.0);
+            outData.insert("max", 1.0);
+        }
+        else if (op == "zoom_step" || op == "zoom_step_af") {
+            state.zoom = Clamp01(state.zoom + params.value("step").toDouble());
+            outData.insert("value", state.zoom);
+            if (op == "zoom_step_af") {
+                outData.insert("focused", true);
+            }
+        }
+        else if (op == "set_zoom_abs") {
+            state.zoom = Clamp01(params.value("zoom").toDouble(state.zoom));
+            outData.insert("value", state.zoom);
+        }
+        else if (op == "get_exposure") {
+            outData.insert("value", state.exposure);
+            outData.insert("auto", state.autoExposure);
+        }
+        else if (op == "get_exposure_range") {
+            outData.insert("min", 0.0);
+            outData.insert("max", 1.0);
+        }
+        else if (op == "set_exposure") {
+            if (params.value("shutter").toString() == QStringLiteral("auto")) {
+                state.autoExposure = true;
+            }
+            else if (params.contains("exposure_s")) {
+                state.autoExposure = false;
+                state.exposure = Clamp01(params.value("exposure_s").toDouble());
+            }
+            else if (params.contains("exposure_us")) {
+                state.autoExposure = false;
+                state.exposure = Clamp01(params.value("exposure_us").toDouble() / 1e6);
+            }
+            outData.insert("value", state.exposure);
+            outData.insert("auto", state.autoExposure);
+        }
+        else if (op == "autofocus_once") {
+            outData.insert("focused", true);
+        }
+        else if (op == "shutdown") {
+            // 模拟服务不随 shutdown 退出，便于反复测试
+            outData.insert("shutdown", true);
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+}
+
+namespace TF
+{
+    HKCamMockServer::~HKCamMockServer()
+    {
+        Stop();
+    }
+
+    bool HKCamMockServer::Start(const HKCamMockConfig &cfg, std::string &outError)
+    {
+        Stop();
+        m_config = cfg;
+
+        try {
+            m_context = std::make_unique<zmq::context_t>(1);
+            m_socket = std::make_unique<zmq::socket_t>(*m_context, zmq::socket_type::router);
+            m_socket->set(zmq::sockopt::linger, 0);
+            m_socket->bind(m_config.endpoint);
+        }
+        catch (const zmq::error_t &e) {
+            outError = "Mock server bind failed: " + std::string(e.what());
+            m_socket.reset();
+            m_context.reset();
+            return false;
+        }
+
+        m_running.store(true);
+        m_thread = std::thread(&HKCamMockServer::ServeLoop, this);
+        return true;
+    }
+
+    void HKCamMockServer::Stop()
+    {
+        if (!m_running.exchange(false)) {
+            return;
+        }
+
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+
+        if (m_socket) {
+            try {
+                m_socket->close();
+            }
+            catch (...) {
+            }
+            m_socket.reset();
+        }
+        m_context.reset();
+    }
+
+    void HKCamMockServer::SetLatency(int latencyMs, int jitterMs)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_config.latencyMs = std::max(0, latencyMs);
+        m_config.jitterMs = std::max(0, jitterMs);
+    }
+
+    void HKCamMockServer::SetErrorRate(double errorRate, double dropRate)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_config.errorRate = std::clamp(errorRate, 0.0, 1.0);
+        m_config.dropRate = std::clamp(dropRate, 0.0, 1.0);
+    }
+
+    std::map<std::string, int> HKCamMockServer::OpCounts() const
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_opCounts;
+    }
+
+    void HKCamMockServer::ResetOpCounts()
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_opCounts.clear();
+    }
+
+    void HKCamMockServer::ServeLoop()
+    {
+        std::mt19937 rng(m_config.seed);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::priority_queue<ScheduledReply, std::vector<ScheduledReply>, std::greater<>> replies;
+        MockDeviceState state;
+        auto busyUntil = Clock::now();
+
+        while (m_running.load()) {
+            auto timeout = std::chrono::milliseconds(kMaxPollMs);
+            if (!replies.empty()) {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(replies.top().due - Clock::now());
+                timeout = std::clamp(left, std::chrono::milliseconds(0), timeout);
+            }
+
+            std::vector<zmq::pollitem_t> items = {{static_cast<void *>(*m_socket), 0, ZMQ_POLLIN, 0}};
+            try {
+                zmq::poll(items, timeout);
+            }
+            catch (const zmq::error_t &) {
+                continue;
+            }
+
+            while (items[0].revents & ZMQ_POLLIN) {
+                std::vector<std::string> frames;
+                zmq::message_t part;
+                if (!m_socket->recv(part, zmq::recv_flags::dontwait).has_value()) {
+                    break;
+                }
+                frames.emplace_back(static_cast<char *>(part.data()), part.size());
+                while (part.more() && m_socket->recv(part, zmq::recv_flags::none).has_value()) {
+                    frames.emplace_back(static_cast<char *>(part.data()), part.size());
+                }
+                if (frames.size() < 2) {
+                    continue;
+                }
+
+                ScheduledReply reply;
+                reply.envelope.assign(frames.begin(), frames.end() - 1);
+                const auto doc = QJsonDocument::fromJson(QByteArray::fromStdString(frames.back()));
+                const auto req = doc.object();
+                const int id = req.value("id").toInt();
+                const auto op = req.value("op").toString().toStdString();
+
+                HKCamMockConfig cfg;
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    ++m_opCounts[op];
+                    cfg = m_config;
+                }
+
+                const int jitter = cfg.jitterMs > 0 ? static_cast<int>(unit(rng) * cfg.jitterMs) : 0;
+                const auto latency = std::chrono::milliseconds(cfg.latencyMs + jitter);
+                const auto now = Clock::now();
+                if (cfg.serial) {
+                    busyUntil = std::max(now, busyUntil) + latency;
+                    reply.due = busyUntil;
+                }
+                else {
+                    reply.due = now + latency;
+                }
+
+                if (unit(rng) < cfg.dropRate) {
+                    continue;
+                }
+
+                QJsonObject data;
+                if (!doc.isObject()) {
+                    reply.payload = ToPayload(ErrorReply(id, "ParseError", "Request is not a JSON object"));
+                }
+                else if (unit(rng) < cfg.errorRate) {
+                    reply.payload = ToPayload(ErrorReply(id, "MockError", "Injected error"));
+                }
+                else if (HandleOp(op, req.value("params").toObject(), state, data)) {
+                    reply.payload = ToPayload(OkReply(id, data));
+                }
+                else {
+                    reply.payload = ToPayload(ErrorReply(id, "UnknownOp", QString::fromStdString("Unknown op " + op)));
+                }
+                replies.push(std::move(reply));
+            }
+
+            const auto now = Clock::now();
+            while (!replies.empty() && replies.top().due <= now) {
+                const auto &reply = replies.top();
+                try {
+                    for (const auto &frame : reply.envelope) {
+                        m_socket->send(zmq::buffer(frame), zmq::send_flags::sndmore);
+                    }
+                    m_socket->send(zmq::buffer(reply.payload), zmq::send_flags::none);
+                }
+                catch (const zmq::error_t &) {
+                }
+                replies.pop();
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <zmq.hpp>
+
+namespace TF
+{
+    struct HKCamMockConfig
+    {
+        std::string endpoint = "tcp://127.0.0.1:5555";
+        int latencyMs = 20;           // 每个请求的基础处理时延
+        int jitterMs = 10;            // 时延上叠加的均匀抖动 [0, jitterMs]
+        double errorRate = 0.0;       // 返回 ok=false 的概率
+        double dropRate = 0.0;        // 不回复的概率，用于测试客户端超时
+        bool serial = true;           // 按顺序逐个处理，模拟单线程 Python REP 服务
+        uint32_t seed = 12345;
+    };
+
+    // 进程内 ONVIF RPC 模拟服务：ROUTER 套接字，与 Python 服务相同的 JSON 协议
+    // (id/op/params -> id/ok/data|error)，维护变焦、曝光状态并统计各 op 调用次数。
+    class HKCamMockServer
+    {
+    public:
+        HKCamMockServer() = default;
+        ~HKCamMockServer();
+
+        bool Start(const HKCamMockConfig &cfg, std::string &outError);
+        void Stop();
+        bool IsRunning() const { return m_running.load(); }
+
+        void SetLatency(int latencyMs, int jitterMs);
+        void SetErrorRate(double errorRate, double dropRate);
+
+        std::map<std::string, int> OpCounts() const;
+        void ResetOpCounts();
+
+    private:
+        void ServeLoop();
+
+    private:
+        HKCamMockConfig m_config;
+        mutable std::mutex m_mutex;
+        std::map<std::string, int> m_opCounts;
+        std::unique_ptr<zmq::context_t> m_context;
+        std::unique_ptr<zmq::socket_t> m_socket;
+        std::atomic<bool> m_running{false};
+        std::thread m_thread;
+    };
+}
@@ -1,6 +1,8 @@
 #include "HKCamPythonServer.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
 #include <sstream>
 #include <thread>
 #include <vector>
@@ -11,12 +13,16 @@
 #include <Windows.h>
 #else
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <signal.h>
 #include <string.h>
 #include <sys/prctl.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
+
+extern char **environ;
 #endif
 
 namespace
@@ -53,6 +59,31 @@ namespace
         return result;
     }
 
+    // Copy of this process's environment with name=value set, passed as lpEnvironment so the
+    // variable never shows up in the environment other threads spawn processes with
+    std::vector<wchar_t> BuildEnvironmentBlock(const std::wstring &name, const std::wstring &value)
+    {
+        std::vector<wchar_t> block;
+        const std::wstring prefix = name + L"=";
+        LPWCH strings = GetEnvironmentStringsW();
+        if (strings)
+        {
+            for (LPWCH entry = strings; *entry; entry += wcslen(entry) + 1)
+            {
+                if (_wcsnicmp(entry, prefix.c_str(), prefix.size()) != 0)
+                {
+                    block.insert(block.end(), entry, entry + wcslen(entry) + 1);
+                }
+            }
+            FreeEnvironmentStringsW(strings);
+        }
+        const std::wstring assignment = prefix + value;
+        block.insert(block.end(), assignment.begin(), assignment.end());
+        block.push_back(L'\0');
+        block.push_back(L'\0');
+        return block;
+    }
+
     std::string JoinArgs(const std::vector<std::string> &args)
     {
         std::ostringstream oss;
@@ -80,9 +111,54 @@ namespace
         }
         return oss.str();
     }
+
+    // Copy of environ with name=value set. Built before fork(): the child of a multithreaded
+    // process may only make async-signal-safe calls, which rules out setenv and allocation
+    std::vector<std::string> BuildEnvironment(const std::string &name, const std::string &value)
+    {
+        std::vector<std::string> env;
+        const std::string prefix = name + "=";
+        for (char **entry = environ; entry && *entry; ++entry)
+        {
+            if (strncmp(*entry, prefix.c_str(), prefix.size()) != 0)
+            {
+                env.emplace_back(*entry);
+            }
+        }
+        env.push_back(prefix + value);
+        return env;
+    }
 #endif
 }
 
+namespace
+{
+    constexpr int kInitialReadyBackoffMs = 20;
+    constexpr const char *kReadyPrefix = "READY";
+
+    // Extracts the version from a complete "READY <version>" line, if one is buffered
+    bool ParseReadyLine(std::string &buffer, std::string &outVersion)
+    {
+        const auto eol = buffer.find('\n');
+        if (eol == std::string::npos)
+        {
+            return false;
+        }
+        std::string line = buffer.substr(0, eol);
+        buffer.erase(0, eol + 1);
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.rfind(kReadyPrefix, 0) != 0)
+        {
+            return false;
+        }
+        outVersion = line.size() > 6 ? line.substr(6) : std::string();
+        return true;
+    }
+}
+
 namespace TF
 {
 HKCamPythonServer::HKCamPythonServer() = default;
@@ -108,14 +184,20 @@ bool HKCamPythonServer::StartBlocking(const HKCamServerConfig &cfg, std::string
     Stop();
     m_config = cfg;
     m_external = false;
+    m_serverVersion.clear();
     outError.clear();
 
-    if (CheckExistingServer(outError))
+    const int existing = CheckExistingServer(outError);
+    if (existing > 0)
     {
         m_running.store(true);
         m_external = true;
         return true;
     }
+    if (existing < 0)
+    {
+        return false;
+    }
 
     if (!outError.empty())
     {
@@ -129,44 +211,129 @@ bool HKCamPythonServer::StartBlocking(const HKCamServerConfig &cfg, std::string
     }
 
     m_running.store(true);
-/*
-    if (!WaitForReady(outError))
+
+    if (m_config.waitForReady && !WaitForReady(outError))
     {
+        // A server that never became ready is not worth keeping alive
+        m_config.keepAlive = false;
         Stop();
         return false;
     }
-*/
+
+    CloseReadyPipe();
     return true;
 }
 
-bool HKCamPythonServer::CheckExistingServer(std::string &outError)
+bool HKCamPythonServer::ProbeServer(int timeoutMs, std::string &outVersion, std::string &outError)
+{
+    auto &client = HKCamZmqClient::instance();
+    const auto result = client.CallAsync("ping", QJsonObject(), timeoutMs).get();
+    if (!result.success)
+    {
+        outError = result.errorReason.toStdString();
+        return false;
+    }
+    outVersion = result.response.data.value("version").toString().toStdString();
+    return true;
+}
+
+int HKCamPythonServer::CheckExistingServer(std::string &outError)
 {
     auto &client = HKCamZmqClient::instance();
     client.Configure(m_config.endpoint, m_config.timeoutMs);
 
-    TF::RpcResponse resp;
-    if (client.Ping(resp, outError))
+    // Short probe: when nothing is listening we should not wait the full RPC timeout
+    std::string version;
+    if (!ProbeServer(m_config.probeTimeoutMs, version, outError))
     {
-        return true;
+        return 0;
     }
-    return false;
+
+    if (m_config.expectedVersion.empty() || version == m_config.expectedVersion)
+    {
+        m_serverVersion = version;
+        return 1;
+    }
+
+    std::ostringstream oss;
+    oss << "Existing server version mismatch. expected=" << m_config.expectedVersion << " actual=" << version
+        << " endpoint=" << m_config.endpoint;
+    if (!m_config.allowStopExternal)
+    {
+        // Not ours to stop, and a second server cannot bind the same endpoint
+        oss << ", stopping external servers is not allowed";
+        outError = oss.str();
+        return -1;
+    }
+
+    // Stale server from an older deployment: ask it to exit and launch a fresh one
+    outError = oss.str();
+
+    QJsonObject shutdownData;
+    std::string shutdownErr;
+    client.Shutdown(shutdownData, shutdownErr);
+
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(m_config.timeoutMs))
+    {
+        std::string probeErr;
+        if (!ProbeServer(m_config.probeTimeoutMs, version, probeErr))
+        {
+            outError.clear();
+            return 0;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(m_config.startPollIntervalMs));
+    }
+
+    outError += ", server did not exit after shutdown";
+    return -1;
 }
 
 bool HKCamPythonServer::WaitForReady(std::string &outError)
 {
     auto &client = HKCamZmqClient::instance();
     client.Configure(m_config.endpoint, m_config.timeoutMs);
-    TF::RpcResponse resp;
+
+    const auto budget = std::chrono::milliseconds(
+        static_cast<long long>(m_config.startRetries) * m_config.startPollIntervalMs);
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    auto backoff = std::chrono::milliseconds(std::min(kInitialReadyBackoffMs, m_config.startPollIntervalMs));
 
     std::string lastError;
-    for (int i = 0; i < m_config.startRetries; ++i)
+    while (std::chrono::steady_clock::now() < deadline)
     {
-        if (client.Ping(resp, lastError))
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        const auto wait = std::max(std::chrono::milliseconds(0), std::min(backoff, left));
+
+        // Event-driven path: returns as soon as the script reports READY
+        std::string version;
+        const int signal = m_config.readyHandshake ? WaitReadySignal(wait, version) : 0;
+        if (signal > 0)
         {
+            m_serverVersion = version;
             outError.clear();
             return true;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(m_config.startPollIntervalMs));
+        if (signal == 0 && !m_config.readyHandshake)
+        {
+            std::this_thread::sleep_for(wait);
+        }
+        if (!IsChildAlive())
+        {
+            lastError = "python process exited during startup";
+            break;
+        }
+
+        // Fallback for scripts without the handshake
+        if (ProbeServer(m_config.probeTimeoutMs, version, lastError))
+        {
+            m_serverVersion = version;
+            outError.clear();
+            return true;
+        }
+
+        backoff = std::min(backoff * 2, std::chrono::milliseconds(m_config.startPollIntervalMs));
     }
 
     std::ostringstream oss;
@@ -177,6 +344,132 @@ bool HKCamPythonServer::WaitForReady(std::string &outError)
     return false;
 }
 
+int HKCamPythonServer::WaitReadySignal(std::chrono::milliseconds timeout, std::string &outVersion)
+{
+#ifdef _WIN32
+    if (!m_readyRead)
+    {
+        std::this_thread::sleep_for(timeout);
+        return 0;
+    }
+
+    // Anonymous pipes are not waitable on Windows; peek in short slices
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true)
+    {
+        DWORD available = 0;
+        if (!PeekNamedPipe(static_cast<HANDLE>(m_readyRead), nullptr, 0, nullptr, &available, nullptr))
+        {
+            // ERROR_BROKEN_PIPE: every copy of the write end is closed
+            CloseReadyPipe();
+            return -1;
+        }
+        if (available > 0)
+        {
+            char buf[128];
+            DWORD readBytes = 0;
+            if (!ReadFile(static_cast<HANDLE>(m_readyRead), buf,
+                          std::min<DWORD>(available, static_cast<DWORD>(sizeof(buf))), &readBytes, nullptr))
+            {
+                CloseReadyPipe();
+                return -1;
+            }
+            m_readyBuffer.append(buf, readBytes);
+            if (ParseReadyLine(m_readyBuffer, outVersion))
+            {
+                return 1;
+            }
+            continue;
+        }
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return 0;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+#else
+    if (m_readyFd < 0)
+    {
+        std::this_thread::sleep_for(timeout);
+        return 0;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true)
+    {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        pollfd pfd{m_readyFd, POLLIN, 0};
+        const int ret = poll(&pfd, 1, static_cast<int>(std::max<long long>(0, left.count())));
+        if (ret < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ret <= 0)
+        {
+            return 0;
+        }
+
+        char buf[128];
+        const ssize_t n = read(m_readyFd, buf, sizeof(buf));
+        if (n <= 0)
+        {
+            // EOF: every copy of the write end is closed, i.e. the child exited
+            CloseReadyPipe();
+            return -1;
+        }
+        m_readyBuffer.append(buf, static_cast<size_t>(n));
+        if (ParseReadyLine(m_readyBuffer, outVersion))
+        {
+            return 1;
+        }
+    }
+#endif
+}
+
+bool HKCamPythonServer::IsChildAlive()
+{
+#ifdef _WIN32
+    if (!m_processHandle)
+    {
+        return false;
+    }
+    return WaitForSingleObject(static_cast<HANDLE>(m_processHandle), 0) == WAIT_TIMEOUT;
+#else
+    if (m_childPid <= 0)
+    {
+        return false;
+    }
+    int status = 0;
+    const pid_t res = waitpid(m_childPid, &status, WNOHANG);
+    if (res == m_childPid)
+    {
+        m_childPid = -1;
+        m_childPgid = -1;
+        return false;
+    }
+    return true;
+#endif
+}
+
+void HKCamPythonServer::CloseReadyPipe()
+{
+#ifdef _WIN32
+    if (m_readyRead)
+    {
+        CloseHandle(static_cast<HANDLE>(m_readyRead));
+        m_readyRead = nullptr;
+    }
+#else
+    if (m_readyFd >= 0)
+    {
+        close(m_readyFd);
+        m_readyFd = -1;
+    }
+#endif
+    m_readyBuffer.clear();
+}
+
 bool HKCamPythonServer::LaunchProcess(std::string &outError)
 {
     std::vector<std::string> args = {
@@ -206,28 +499,84 @@ bool HKCamPythonServer::LaunchProcess(std::string &outError)
     std::vector<wchar_t> cmdBuffer(wideCmd.begin(), wideCmd.end());
     cmdBuffer.push_back(L'\0');
 
-    STARTUPINFOW si;
+    STARTUPINFOEXW si;
     ZeroMemory(&si, sizeof(si));
-    si.cb = sizeof(si);
+    si.StartupInfo.cb = sizeof(si);
     if (m_config.createNoWindow)
     {
-        si.dwFlags |= STARTF_USESHOWWINDOW;
-        si.wShowWindow = SW_HIDE;
+        si.StartupInfo.dwFlags |= STARTF_USESHOWWINDOW;
+        si.StartupInfo.wShowWindow = SW_HIDE;
     }
 
     PROCESS_INFORMATION pi;
     ZeroMemory(&pi, sizeof(pi));
 
-    DWORD creationFlags = 0;
+    DWORD creationFlags = CREATE_UNICODE_ENVIRONMENT;
     if (m_config.createNoWindow)
     {
         creationFlags |= CREATE_NO_WINDOW;
     }
 
-    const BOOL created = CreateProcessW(wideExe.c_str(), cmdBuffer.data(), nullptr, nullptr, FALSE, creationFlags, nullptr, nullptr,
-                                        &si, &pi);
+    // Ready pipe: the child inherits the write end and reports "READY <version>" on it.
+    // The handle list limits inheritance to that one handle, the handle value reaches the
+    // child through its own environment block
+    HANDLE readyRead = nullptr;
+    HANDLE readyWrite = nullptr;
+    std::vector<wchar_t> environment;
+    std::vector<char> attributeBuffer;
+    LPPROC_THREAD_ATTRIBUTE_LIST attributes = nullptr;
+    if (m_config.readyHandshake && CreatePipe(&readyRead, &readyWrite, nullptr, 0))
+    {
+        SIZE_T attributeSize = 0;
+        InitializeProcThreadAttributeList(nullptr, 1, 0, &attributeSize);
+        attributeBuffer.resize(attributeSize);
+        attributes = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attributeBuffer.data());
+        if (!InitializeProcThreadAttributeList(attributes, 1, 0, &attributeSize))
+        {
+            attributes = nullptr;
+        }
+        else if (!SetHandleInformation(readyWrite, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT) ||
+                 !UpdateProcThreadAttribute(attributes, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST, &readyWrite,
+                                            sizeof(readyWrite), nullptr, nullptr))
+        {
+            DeleteProcThreadAttributeList(attributes);
+            attributes = nullptr;
+        }
+
+        if (attributes)
+        {
+            si.lpAttributeList = attributes;
+            creationFlags |= EXTENDED_STARTUPINFO_PRESENT;
+            environment = BuildEnvironmentBlock(L"HKCAM_READY_HANDLE",
+                                                std::to_wstring(reinterpret_cast<uintptr_t>(readyWrite)));
+        }
+        else
+        {
+            // Without a handle list the child would inherit every inheritable handle; fall back to ping polling
+            CloseHandle(readyRead);
+            CloseHandle(readyWrite);
+            readyRead = nullptr;
+            readyWrite = nullptr;
+        }
+    }
+
+    const BOOL created = CreateProcessW(wideExe.c_str(), cmdBuffer.data(), nullptr, nullptr, readyWrite ? TRUE : FALSE,
+                                        creationFlags, environment.empty() ? nullptr : environment.data(), nullptr,
+                                        &si.StartupInfo, &pi);
+    if (attributes)
+    {
+        DeleteProcThreadAttributeList(attributes);
+    }
+    if (readyWrite)
+    {
+        CloseHandle(readyWrite);
+    }
     if (!created)
     {
+        if (readyRead)
+        {
+            CloseHandle(readyRead);
+        }
         const DWORD errCode = GetLastError();
         std::ostringstream oss;
         oss << "CreateProcess failed. cmd=" << commandLine << " endpoint=" << m_config.endpoint
@@ -236,7 +585,10 @@ bool HKCamPythonServer::LaunchProcess(std::string &outError)
         return false;
     }
 
-    HANDLE hJob = CreateJobObjectW(nullptr, nullptr);
+    m_readyRead = readyRead;
+
+    // keepAlive servers must outlive this process, so they are not bound to a kill-on-close job
+    HANDLE hJob = m_config.keepAlive ? nullptr : CreateJobObjectW(nullptr, nullptr);
     if (hJob)
     {
         JOBOBJECT_EXTENDED_LIMIT_INFORMATION jeli = {};
@@ -249,9 +601,47 @@ bool HKCamPythonServer::LaunchProcess(std::string &outError)
     m_processHandle = pi.hProcess;
     m_threadHandle = pi.hThread;
 #else
+    // Both ends close-on-exec, so processes other threads spawn meanwhile never inherit them;
+    // the child clears the flag on its write end only
+    int readyPipe[2] = {-1, -1};
+    if (m_config.readyHandshake && pipe2(readyPipe, O_CLOEXEC) != 0)
+    {
+        readyPipe[0] = -1;
+        readyPipe[1] = -1;
+    }
+
+    // argv and envp are prepared here, the child only calls async-signal-safe functions
+    std::vector<char *> argv;
+    argv.reserve(args.size() + 1);
+    for (const auto &arg : args)
+    {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    std::vector<std::string> env;
+    std::vector<char *> envp;
+    if (readyPipe[1] >= 0)
+    {
+        env = BuildEnvironment("HKCAM_READY_FD", std::to_string(readyPipe[1]));
+        envp.reserve(env.size() + 1);
+        for (auto &entry : env)
+        {
+            envp.push_back(entry.data());
+        }
+        envp.push_back(nullptr);
+    }
+    char **childEnv = envp.empty() ? environ : envp.data();
+    const bool searchPath = m_config.pythonExe.find('/') == std::string::npos;
+
     pid_t child = fork();
     if (child < 0)
     {
+        if (readyPipe[0] >= 0)
+        {
+            close(readyPipe[0]);
+            close(readyPipe[1]);
+        }
         std::ostringstream oss;
         oss << "fork failed. cmd=" << commandLine << " endpoint=" << m_config.endpoint
             << " errno=" << errno << " message=" << strerror(errno);
@@ -262,27 +652,31 @@ bool HKCamPythonServer::LaunchProcess(std::string &outError)
     if (child == 0)
     {
         setpgid(0, 0);
-        prctl(PR_SET_PDEATHSIG, SIGTERM);
-
-        std::vector<char *> argv;
-        argv.reserve(args.size() + 1);
-        for (const auto &arg : args)
+        if (!m_config.keepAlive)
+        {
+            prctl(PR_SET_PDEATHSIG, SIGTERM);
+        }
+        if (readyPipe[1] >= 0)
         {
-            argv.push_back(const_cast<char *>(arg.c_str()));
+            fcntl(readyPipe[1], F_SETFD, 0);
         }
-        argv.push_back(nullptr);
 
-        if (m_config.pythonExe.find('/') != std::string::npos)
+        if (searchPath)
         {
-            execv(m_config.pythonExe.c_str(), argv.data());
+            execvpe(argv[0], argv.data(), childEnv);
         }
         else
         {
-            execvp(m_config.pythonExe.c_str(), argv.data());
+            execve(argv[0], argv.data(), childEnv);
         }
         _exit(127);
     }
 
+    if (readyPipe[1] >= 0)
+    {
+        close(readyPipe[1]);
+        m_readyFd = readyPipe[0];
+    }
     m_childPid = child;
     m_childPgid = child;
 #endif
@@ -290,8 +684,21 @@ bool HKCamPythonServer::LaunchProcess(std::string &outError)
     return true;
 }
 
+void HKCamPythonServer::ReapDetachedChildren()
+{
+#ifndef _WIN32
+    m_detachedPids.erase(std::remove_if(m_detachedPids.begin(), m_detachedPids.end(), [](pid_t pid) {
+        int status = 0;
+        const pid_t res = waitpid(pid, &status, WNOHANG);
+        return res == pid || res < 0;
+    }), m_detachedPids.end());
+#endif
+}
+
 void HKCamPythonServer::Stop()
 {
+    CloseReadyPipe();
+    ReapDetachedChildren();
     if (!m_running.load())
     {
         return;
@@ -303,6 +710,32 @@ void HKCamPythonServer::Stop()
         return;
     }
 
+    if (!m_external && m_config.keepAlive)
+    {
+        // Detach only: the next StartBlocking finds the server through CheckExistingServer
+#ifdef _WIN32
+        for (void **handle : {&m_threadHandle, &m_processHandle, &m_jobHandle})
+        {
+            if (*handle)
+            {
+                CloseHandle(static_cast<HANDLE>(*handle));
+                *handle = nullptr;
+            }
+        }
+#else
+        // IsChildAlive reaps a child that already exited; a running one stays our child and is
+        // reaped by a later Stop() once it exits, or by init after this process is gone
+        if (IsChildAlive())
+        {
+            m_detachedPids.push_back(m_childPid);
+        }
+        m_childPid = -1;
+        m_childPgid = -1;
+#endif
+        m_running.store(false);
+        return;
+    }
+
     auto &client = HKCamZmqClient::instance();
     client.Configure(m_config.endpoint, m_config.timeoutMs);
     QJsonObject shutdownData;
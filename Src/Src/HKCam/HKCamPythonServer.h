@@ -1,7 +1,9 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <string>
+#include <vector>
 
 #include "HKCamZmqClient.h"
 
@@ -20,10 +22,20 @@ struct HKCamServerConfig
     int timeoutMs = 3000;
     int startRetries = 30;
     int startPollIntervalMs = 200;
+    int probeTimeoutMs = 300;    // timeout of the ping used to detect an already running server
+    bool waitForReady = true;
+    bool readyHandshake = true;  // wait for "READY <version>" on the inherited ready pipe
+    bool keepAlive = false;      // leave the server running on Stop() so the next launch can reuse it
+    std::string expectedVersion; // reuse an existing server only when its reported version matches
     bool createNoWindow = true;
     bool allowStopExternal = false;
 };
 
+// Readiness handshake: the launched script finds the write end of a pipe in the
+// HKCAM_READY_FD (POSIX fd) or HKCAM_READY_HANDLE (Windows handle) environment
+// variable and writes "READY <version>\n" once its socket is bound. Scripts that
+// do not support it are still detected by ping polling with exponential backoff.
+
 class HKCamPythonServer
 {
 public:
@@ -33,11 +45,20 @@ public:
     bool StartBlocking(const HKCamServerConfig &cfg, std::string &outError);
     void Stop();
     bool IsRunning() const;
+    const std::string &ServerVersion() const { return m_serverVersion; }
 
 private:
-    bool CheckExistingServer(std::string &outError);
+    // Returns 1 when a matching server is running, 0 when none is, -1 on a version
+    // mismatch with a server that may not be stopped or did not exit
+    int CheckExistingServer(std::string &outError);
+    bool ProbeServer(int timeoutMs, std::string &outVersion, std::string &outError);
     bool LaunchProcess(std::string &outError);
     bool WaitForReady(std::string &outError);
+    // Returns 1 when READY was read, 0 on timeout, -1 when the pipe closed (child exited)
+    int WaitReadySignal(std::chrono::milliseconds timeout, std::string &outVersion);
+    bool IsChildAlive();
+    void CloseReadyPipe();
+    void ReapDetachedChildren();
 
 private:
     HKCamServerConfig m_config;
@@ -49,10 +70,15 @@ private:
     void *m_jobHandle = nullptr;
     void *m_processHandle = nullptr;
     void *m_threadHandle = nullptr;
+    void *m_readyRead = nullptr;
 #else
     pid_t m_childPid = -1;
     pid_t m_childPgid = -1;
+    int m_readyFd = -1;
+    std::vector<pid_t> m_detachedPids; // keepAlive children still running when detached, reaped once they exit
 #endif
+    std::string m_readyBuffer;
+    std::string m_serverVersion;
 };
 }
 
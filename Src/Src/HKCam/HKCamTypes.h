@@ -2,6 +2,7 @@
 
 #include <QString>
 #include <QJsonObject>
+#include <functional>
 #include <optional>
 
 namespace TF
@@ -23,5 +24,8 @@ namespace TF
         QString errorReason;
         RpcResponse response;
     };
+
+    // 异步调用完成回调，在客户端 I/O 线程中执行，不可在回调中发起同步调用
+    using RpcCallback = std::function<void(const RpcCallResult &)>;
 }
 
@@ -1,8 +1,11 @@
 #include "HKCamZmqClient.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cerrno>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include <QByteArray>
 #include <QJsonArray>
@@ -14,6 +17,31 @@ namespace {
         const auto json = QJsonDocument(obj).toJson(pretty ? QJsonDocument::Indented : QJsonDocument::Compact);
         return QString::fromUtf8(json);
     }
+
+    constexpr const char *kWakeEndpoint = "inproc://hkcam-zmq-client-wake";
+    constexpr int kIdlePollMs = 1000;
+
+    void InvokeCallback(const TF::RpcCallback& callback, const TF::RpcCallResult& result) {
+        if (!callback) {
+            return;
+        }
+        try {
+            callback(result);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "HKCamZmqClient callback threw: " << e.what() << std::endl;
+        }
+        catch (...) {
+            std::cerr << "HKCamZmqClient callback threw" << std::endl;
+        }
+    }
+
+    TF::RpcCallResult MakeFailure(const QString& reason) {
+        TF::RpcCallResult result;
+        result.success = false;
+        result.errorReason = reason;
+        return result;
+    }
 }
 
 namespace TF {
@@ -22,16 +50,66 @@ namespace TF {
     }
 
     HKCamZmqClient::~HKCamZmqClient() {
-        ResetSocket();
+        StopIoThread();
     }
 
     void HKCamZmqClient::Configure(const std::string& endpoint, int timeoutMs)
     {
-        std::lock_guard<std::mutex> guard(m_mutex);
-        m_endpoint = endpoint;
-        m_timeoutMs = timeoutMs;
-        m_requestId = 1;
-        ResetSocket();
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_endpoint = endpoint;
+            m_timeoutMs = timeoutMs;
+            m_resetRequested = true;
+        }
+        Wake();
+    }
+
+    void HKCamZmqClient::EnsureIoThread() {
+        if (m_ioRunning.load()) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(m_wakeMutex);
+        if (m_ioRunning.load()) {
+            return;
+        }
+
+        m_wakeRx = std::make_unique<zmq::socket_t>(*m_context, zmq::socket_type::pair);
+        m_wakeRx->set(zmq::sockopt::linger, 0);
+        m_wakeRx->bind(kWakeEndpoint);
+        m_wakeTx = std::make_unique<zmq::socket_t>(*m_context, zmq::socket_type::pair);
+        m_wakeTx->set(zmq::sockopt::linger, 0);
+        m_wakeTx->connect(kWakeEndpoint);
+
+        m_ioRunning.store(true);
+        m_ioThread = std::thread(&HKCamZmqClient::IoLoop, this);
+    }
+
+    void HKCamZmqClient::StopIoThread() {
+        if (!m_ioRunning.exchange(false)) {
+            return;
+        }
+
+        Wake();
+        if (m_ioThread.joinable()) {
+            m_ioThread.join();
+        }
+
+        std::lock_guard<std::mutex> guard(m_wakeMutex);
+        m_wakeTx.reset();
+        m_wakeRx.reset();
+    }
+
+    void HKCamZmqClient::Wake() {
+        std::lock_guard<std::mutex> guard(m_wakeMutex);
+        if (!m_wakeTx) {
+            return;
+        }
+        try {
+            m_wakeTx->send(zmq::message_t(), zmq::send_flags::dontwait);
+        }
+        catch (const zmq::error_t&) {
+        }
     }
 
     void HKCamZmqClient::ResetSocket() {
@@ -46,20 +124,20 @@ namespace TF {
     }
 
     bool HKCamZmqClient::EnsureSocket(std::string& outError) {
-        if (!m_context) {
-            m_context = std::make_unique<zmq::context_t>(1);
-        }
-
         if (m_socket) {
             return true;
         }
 
+        std::string endpoint;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            endpoint = m_endpoint;
+        }
+
         try {
-            m_socket = std::make_unique<zmq::socket_t>(*m_context, zmq::socket_type::req);
-            m_socket->set(zmq::sockopt::rcvtimeo, m_timeoutMs);
-            m_socket->set(zmq::sockopt::sndtimeo, m_timeoutMs);
+            m_socket = std::make_unique<zmq::socket_t>(*m_context, zmq::socket_type::dealer);
             m_socket->set(zmq::sockopt::linger, 0);
-            m_socket->connect(m_endpoint);
+            m_socket->connect(endpoint);
         }
         catch (const zmq::error_t& e) {
             outError = "Failed to create/connect socket: " + std::string(e.what());
@@ -75,6 +153,183 @@ namespace TF {
         return true;
     }
 
+    void HKCamZmqClient::FailInflight(const QString& reason) {
+        auto inflight = std::move(m_inflight);
+        m_inflight.clear();
+        for (auto& [id, call] : inflight) {
+            InvokeCallback(call.callback, MakeFailure(reason));
+        }
+    }
+
+    void HKCamZmqClient::IoLoop() {
+        while (m_ioRunning.load()) {
+            bool resetRequested = false;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                std::swap(resetRequested, m_resetRequested);
+            }
+            if (resetRequested) {
+                ResetSocket();
+                FailInflight(QStringLiteral("Socket reset by reconfigure"));
+            }
+
+            DispatchOutbox();
+
+            auto timeout = std::chrono::milliseconds(kIdlePollMs);
+            const auto now = std::chrono::steady_clock::now();
+            for (const auto& [id, call] : m_inflight) {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(call.deadline - now);
+                timeout = std::min(timeout, std::max(left, std::chrono::milliseconds(0)));
+            }
+
+            std::vector<zmq::pollitem_t> items;
+            items.push_back({static_cast<void*>(*m_wakeRx), 0, ZMQ_POLLIN, 0});
+            if (m_socket) {
+                items.push_back({static_cast<void*>(*m_socket), 0, ZMQ_POLLIN, 0});
+            }
+
+            try {
+                zmq::poll(items, timeout);
+            }
+            catch (const zmq::error_t& e) {
+                if (e.num() != EINTR) {
+                    std::cerr << "HKCamZmqClient poll failed: " << e.what() << std::endl;
+                }
+            }
+
+            if (items[0].revents & ZMQ_POLLIN) {
+                zmq::message_t wake;
+                while (m_wakeRx->recv(wake, zmq::recv_flags::dontwait).has_value()) {
+                }
+            }
+
+            if (items.size() > 1 && (items[1].revents & ZMQ_POLLIN)) {
+                ReceiveReplies();
+            }
+
+            ExpireInflight();
+        }
+
+        ResetSocket();
+        FailInflight(QStringLiteral("Client stopped"));
+
+        std::deque<PendingCall> outbox;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            outbox.swap(m_outbox);
+        }
+        for (auto& call : outbox) {
+            InvokeCallback(call.callback, MakeFailure(QStringLiteral("Client stopped")));
+        }
+    }
+
+    void HKCamZmqClient::DispatchOutbox() {
+        std::deque<PendingCall> outbox;
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            outbox.swap(m_outbox);
+        }
+        if (outbox.empty()) {
+            return;
+        }
+
+        std::string socketError;
+        const bool socketOk = EnsureSocket(socketError);
+
+        for (auto& call : outbox) {
+            if (!socketOk) {
+                InvokeCallback(call.callback, MakeFailure(QString::fromStdString(socketError)));
+                continue;
+            }
+
+            try {
+                // 空分隔帧兼容服务端 REP/ROUTER 信封格式
+                zmq::message_t delimiter;
+                zmq::message_t reqMsg(call.payload.begin(), call.payload.end());
+                const auto sentDelim = m_socket->send(delimiter, zmq::send_flags::sndmore | zmq::send_flags::dontwait);
+                const auto sent = sentDelim.has_value()
+                    ? m_socket->send(reqMsg, zmq::send_flags::dontwait)
+                    : zmq::send_result_t{};
+                if (!sent.has_value()) {
+                    InvokeCallback(call.callback, MakeFailure(QStringLiteral("Failed to send request")));
+                    continue;
+                }
+            }
+            catch (const zmq::error_t& e) {
+                InvokeCallback(call.callback, MakeFailure(QString::fromLatin1(e.what())));
+                continue;
+            }
+
+            const int id = call.id;
+            m_inflight.emplace(id, std::move(call));
+        }
+    }
+
+    void HKCamZmqClient::ReceiveReplies() {
+        while (m_socket) {
+            std::string payload;
+            try {
+                zmq::message_t part;
+                if (!m_socket->recv(part, zmq::recv_flags::dontwait).has_value()) {
+                    return;
+                }
+                // 取信封中最后一帧作为应答内容
+                payload.assign(static_cast<char*>(part.data()), part.size());
+                while (part.more()) {
+                    if (!m_socket->recv(part, zmq::recv_flags::none).has_value()) {
+                        break;
+                    }
+                    payload.assign(static_cast<char*>(part.data()), part.size());
+                }
+            }
+            catch (const zmq::error_t& e) {
+                std::cerr << "HKCamZmqClient receive failed: " << e.what() << std::endl;
+                return;
+            }
+
+            bool parseOk = false;
+            std::string parseError;
+            auto resp = ParseResponse(payload, parseOk, parseError);
+            if (!parseOk) {
+                std::cerr << "HKCamZmqClient dropped reply: " << parseError << std::endl;
+                continue;
+            }
+
+            auto it = m_inflight.find(resp.id);
+            if (it == m_inflight.end()) {
+                // 已超时或已被重置的请求，迟到应答直接丢弃
+                continue;
+            }
+            auto call = std::move(it->second);
+            m_inflight.erase(it);
+
+            RpcCallResult callResult;
+            callResult.response = resp;
+            if (!resp.ok) {
+                callResult.success = false;
+                callResult.errorReason = QStringLiteral("Server error: ") + resp.errorMessage;
+            }
+            else {
+                callResult.success = true;
+            }
+            InvokeCallback(call.callback, callResult);
+        }
+    }
+
+    void HKCamZmqClient::ExpireInflight() {
+        const auto now = std::chrono::steady_clock::now();
+        for (auto it = m_inflight.begin(); it != m_inflight.end();) {
+            if (it->second.deadline <= now) {
+                auto call = std::move(it->second);
+                it = m_inflight.erase(it);
+                InvokeCallback(call.callback, MakeFailure(QStringLiteral("Timeout during request")));
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
     QJsonObject HKCamZmqClient::BuildRequestObject(const std::string& op, const QJsonObject& params,
                                                    int requestId) const {
         QJsonObject req;
@@ -126,88 +381,161 @@ namespace TF {
         return result;
     }
 
-    RpcCallResult HKCamZmqClient::Call(const std::string& op, const QJsonObject& params) {
-        RpcCallResult callResult;
-        std::lock_guard<std::mutex> guard(m_mutex);
+    void HKCamZmqClient::CallAsync(const std::string& op, const QJsonObject& params, RpcCallback callback,
+                                   int timeoutMs) {
+        EnsureIoThread();
 
-        std::string socketError;
-        if (!EnsureSocket(socketError)) {
-            callResult.success = false;
-            callResult.errorReason = QString::fromStdString(socketError);
-            return callResult;
+        PendingCall call;
+        call.id = m_requestId.fetch_add(1);
+        call.payload = JsonToString(BuildRequestObject(op, params, call.id)).toStdString();
+        call.callback = std::move(callback);
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            const int effectiveTimeout = timeoutMs > 0 ? timeoutMs : m_timeoutMs;
+            call.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(effectiveTimeout);
+            m_outbox.push_back(std::move(call));
         }
+        Wake();
+    }
 
-        const int requestId = m_requestId++;
-        const auto reqObj = BuildRequestObject(op, params, requestId);
-        const auto reqString = JsonToString(reqObj).toStdString();
+    std::future<RpcCallResult> HKCamZmqClient::CallAsync(const std::string& op, const QJsonObject& params,
+                                                         int timeoutMs) {
+        auto promise = std::make_shared<std::promise<RpcCallResult>>();
+        auto future = promise->get_future();
+        CallAsync(op, params, [promise](const RpcCallResult& result) {
+            promise->set_value(result);
+        }, timeoutMs);
+        return future;
+    }
 
-        try {
-            zmq::message_t reqMsg(reqString.begin(), reqString.end());
-            const auto sent = m_socket->send(reqMsg, zmq::send_flags::none);
-            if (!sent.has_value()) {
-                callResult.errorReason = QStringLiteral("Failed to send request");
-                ResetSocket();
-                return callResult;
-            }
+    RpcCallResult HKCamZmqClient::Call(const std::string& op, const QJsonObject& params) {
+        if (m_ioRunning.load() && std::this_thread::get_id() == m_ioThread.get_id()) {
+            return MakeFailure(QStringLiteral("Synchronous call from client callback is not allowed"));
+        }
+        return CallAsync(op, params).get();
+    }
 
-            zmq::message_t reply;
-            const auto received = m_socket->recv(reply, zmq::recv_flags::none);
-            if (!received.has_value()) {
-                callResult.errorReason = QStringLiteral("Failed to receive reply");
-                ResetSocket();
-                return callResult;
-            }
+    void HKCamZmqClient::SetZoomLimits(double minZoom, double maxZoom) {
+        std::lock_guard<std::mutex> guard(m_zoomMutex);
+        m_zoomLimits = std::make_pair(std::min(minZoom, maxZoom), std::max(minZoom, maxZoom));
+    }
 
-            const std::string payload(static_cast<char*>(reply.data()), reply.size());
-            bool parseOk = false;
-            std::string parseError;
-            auto resp = ParseResponse(payload, parseOk, parseError);
-            if (!parseOk) {
-                callResult.errorReason = QString::fromStdString(parseError);
-                ResetSocket();
-                return callResult;
+    void HKCamZmqClient::SubmitZoomTarget(double zoom, std::optional<double> speed, RpcCallback callback) {
+        ZoomRequest request{zoom, speed, std::move(callback)};
+        RpcCallback superseded;
+        bool sendNow = false;
+        {
+            std::lock_guard<std::mutex> guard(m_zoomMutex);
+            if (m_zoomLimits.has_value()) {
+                request.zoom = std::clamp(request.zoom, m_zoomLimits->first, m_zoomLimits->second);
+            }
+            if (m_zoomInFlight) {
+                if (m_pendingZoom.has_value()) {
+                    superseded = std::move(m_pendingZoom->callback);
+                }
+                m_pendingZoom = std::move(request);
             }
+            else {
+                m_zoomInFlight = true;
+                m_zoomInFlightTarget = request.zoom;
+                sendNow = true;
+            }
+        }
 
-            if (resp.id != requestId) {
-                callResult.errorReason = QStringLiteral("Mismatched response id");
-                ResetSocket();
-                return callResult;
+        InvokeCallback(superseded, MakeFailure(QStringLiteral("Superseded")));
+        if (sendNow) {
+            SendZoomRequest(std::move(request));
+        }
+    }
+
+    void HKCamZmqClient::ZoomStepCoalesced(double step, std::optional<double> speed, RpcCallback callback) {
+        std::optional<double> base;
+        {
+            std::lock_guard<std::mutex> guard(m_zoomMutex);
+            if (m_pendingZoom.has_value()) {
+                base = m_pendingZoom->zoom;
+            }
+            else if (m_zoomInFlight) {
+                base = m_zoomInFlightTarget;
+            }
+            else {
+                base = m_lastZoom;
             }
+        }
 
-            if (!resp.ok) {
-                callResult.errorReason = QStringLiteral("Server error: ") + resp.errorMessage;
-                callResult.response = resp;
-                callResult.success = false;
-                return callResult;
+        if (!base.has_value()) {
+            QJsonObject params;
+            params.insert("step", step);
+            if (speed.has_value()) {
+                params.insert("speed", speed.value());
             }
+            CallAsync("zoom_step", params, [this, callback = std::move(callback)](const RpcCallResult& result) {
+                if (result.success) {
+                    UpdateLastZoom(result.response.data, std::nullopt);
+                }
+                InvokeCallback(callback, result);
+            });
+            return;
+        }
 
-            callResult.success = true;
-            callResult.response = resp;
+        SubmitZoomTarget(base.value() + step, speed, std::move(callback));
+    }
+
+    void HKCamZmqClient::SendZoomRequest(ZoomRequest request) {
+        QJsonObject params;
+        params.insert("zoom", request.zoom);
+        if (request.speed.has_value()) {
+            params.insert("speed", request.speed.value());
         }
-        catch (const zmq::error_t& e) {
-            if (e.num() == EAGAIN) {
-                callResult.errorReason = QStringLiteral("Timeout during request, socket reset");
-                ResetSocket();
+
+        const double target = request.zoom;
+        CallAsync("set_zoom_abs", params,
+                  [this, target, callback = std::move(request.callback)](const RpcCallResult& result) {
+                      OnZoomFinished(target, result, callback);
+                  });
+    }
+
+    void HKCamZmqClient::OnZoomFinished(double target, const RpcCallResult& result, const RpcCallback& callback) {
+        if (result.success) {
+            UpdateLastZoom(result.response.data, target);
+        }
+
+        std::optional<ZoomRequest> next;
+        {
+            std::lock_guard<std::mutex> guard(m_zoomMutex);
+            if (m_pendingZoom.has_value()) {
+                next = std::move(m_pendingZoom);
+                m_pendingZoom.reset();
+                m_zoomInFlightTarget = next->zoom;
             }
             else {
-                callResult.errorReason = QString::fromLatin1(e.what());
+                m_zoomInFlight = false;
             }
         }
-        catch (const std::exception& e) {
-            callResult.errorReason = QString::fromLatin1(e.what());
+
+        InvokeCallback(callback, result);
+        if (next.has_value()) {
+            SendZoomRequest(std::move(next.value()));
+        }
+    }
+
+    void HKCamZmqClient::UpdateLastZoom(const QJsonObject& data, std::optional<double> fallback) {
+        std::optional<double> zoom = fallback;
+        if (data.contains("value") && data.value("value").isDouble()) {
+            zoom = data.value("value").toDouble();
+        }
+        else if (data.contains("zoom") && data.value("zoom").isDouble()) {
+            zoom = data.value("zoom").toDouble();
         }
 
-        return callResult;
+        if (zoom.has_value()) {
+            std::lock_guard<std::mutex> guard(m_zoomMutex);
+            m_lastZoom = zoom;
+        }
     }
 
     bool HKCamZmqClient::Connect(const std::string& endpoint, int timeoutMs, int retries, std::string& outError) {
-        {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            m_endpoint = endpoint;
-            m_timeoutMs = timeoutMs;
-            m_requestId = 1;
-            ResetSocket();
-        }
+        Configure(endpoint, timeoutMs);
 
         for (int i = 0; i < retries; ++i) {
             RpcResponse resp;
@@ -286,6 +614,7 @@ namespace TF {
         else {
             zoom = 0.0;
         }
+        UpdateLastZoom(result.response.data, std::nullopt);
         return true;
     }
 
@@ -313,6 +642,7 @@ namespace TF {
             return false;
         }
         outRaw = result.response.data;
+        UpdateLastZoom(result.response.data, std::nullopt);
         return true;
     }
 
@@ -330,6 +660,7 @@ namespace TF {
             return false;
         }
         outRaw = result.response.data;
+        UpdateLastZoom(result.response.data, zoom);
         return true;
     }
 
@@ -385,6 +716,16 @@ namespace TF {
         return true;
     }
 
+    void HKCamZmqClient::SetExposureBySecondsAsync(double exposureSeconds, bool persist, bool clamp,
+                                                   RpcCallback callback) {
+        QJsonObject params;
+        params.insert("exposure_s", exposureSeconds);
+        params.insert("persist", persist);
+        params.insert("clamp", clamp);
+
+        CallAsync("set_exposure", params, std::move(callback));
+    }
+
     bool HKCamZmqClient::SetExposureByMicroseconds(double exposureMicroseconds, bool persist, bool clamp,
                                                    QJsonObject& outRaw, std::string& outError) {
         QJsonObject params;
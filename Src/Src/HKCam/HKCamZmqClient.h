@@ -1,8 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 #include <QJsonObject>
 
@@ -14,12 +20,26 @@
 
 namespace TF
 {
+    // DEALER 客户端：所有请求由单个 I/O 线程收发，可同时挂起多个请求，按 id 匹配应答。
+    // 同步接口内部等待异步结果，互不串行阻塞；超时只结束对应请求，不重置套接字。
     class HKCamZmqClient : public TBase::TSingleton<HKCamZmqClient>
     {
     public:
         void Configure(const std::string &endpoint, int timeoutMs);
         bool Connect(const std::string &endpoint, int timeoutMs, int retries, std::string &outError);
 
+        // timeoutMs <= 0 时使用 Configure 设置的默认超时
+        std::future<RpcCallResult> CallAsync(const std::string &op, const QJsonObject &params, int timeoutMs = 0);
+        void CallAsync(const std::string &op, const QJsonObject &params, RpcCallback callback, int timeoutMs = 0);
+
+        // 变焦合并：同一时刻只有一个 set_zoom_abs 在途，期间提交的目标只保留最新一个，
+        // 被覆盖的回调以 "Superseded" 失败结束
+        void SubmitZoomTarget(double zoom, std::optional<double> speed, RpcCallback callback);
+        // 相对步进换算为绝对目标后走合并通道；尚未获取过当前变焦值时退化为 zoom_step
+        void ZoomStepCoalesced(double step, std::optional<double> speed, RpcCallback callback);
+        void SetZoomLimits(double minZoom, double maxZoom);
+        void SetExposureBySecondsAsync(double exposureSeconds, bool persist, bool clamp, RpcCallback callback);
+
         bool Ping(RpcResponse &outResponse, std::string &outError);
         bool ReconnectDevice(RpcResponse &outResponse, std::string &outError);
         bool GetDeviceInfo(QJsonObject &outInfo, std::string &outError);
@@ -42,8 +62,36 @@ namespace TF
         HKCamZmqClient();
         ~HKCamZmqClient();
 
+        struct PendingCall
+        {
+            int id = 0;
+            std::string payload;
+            std::chrono::steady_clock::time_point deadline;
+            RpcCallback callback;
+        };
+
+        struct ZoomRequest
+        {
+            double zoom = 0.0;
+            std::optional<double> speed;
+            RpcCallback callback;
+        };
+
+        void EnsureIoThread();
+        void StopIoThread();
+        void Wake();
+        void IoLoop();
         bool EnsureSocket(std::string &outError);
         void ResetSocket();
+        void FailInflight(const QString &reason);
+        void DispatchOutbox();
+        void ReceiveReplies();
+        void ExpireInflight();
+
+        void SendZoomRequest(ZoomRequest request);
+        void OnZoomFinished(double target, const RpcCallResult &result, const RpcCallback &callback);
+        void UpdateLastZoom(const QJsonObject &data, std::optional<double> fallback);
+
         RpcCallResult Call(const std::string &op, const QJsonObject &params);
         RpcResponse ParseResponse(const std::string &payload, bool &parseOk, std::string &parseError) const;
         QJsonObject BuildRequestObject(const std::string &op, const QJsonObject &params, int requestId) const;
@@ -51,10 +99,30 @@ namespace TF
     private:
         std::mutex m_mutex;
         std::unique_ptr<zmq::context_t> m_context;
-        std::unique_ptr<zmq::socket_t> m_socket;
         std::string m_endpoint;
         int m_timeoutMs = 3000;
-        int m_requestId = 1;
+        std::atomic<int> m_requestId{1};
+
+        // 以下由 m_mutex 保护
+        std::deque<PendingCall> m_outbox;
+        bool m_resetRequested = false;
+
+        // 以下仅由 I/O 线程访问
+        std::unique_ptr<zmq::socket_t> m_socket;
+        std::unordered_map<int, PendingCall> m_inflight;
+
+        std::thread m_ioThread;
+        std::atomic<bool> m_ioRunning{false};
+        std::mutex m_wakeMutex;
+        std::unique_ptr<zmq::socket_t> m_wakeTx;
+        std::unique_ptr<zmq::socket_t> m_wakeRx;
+
+        // 变焦合并状态，由 m_zoomMutex 保护
+        std::mutex m_zoomMutex;
+        bool m_zoomInFlight = false;
+        double m_zoomInFlightTarget = 0.0;
+        std::optional<ZoomRequest> m_pendingZoom;
+        std::optional<double> m_lastZoom;
+        std::optional<std::pair<double, double>> m_zoomLimits;
     };
 }
-
@@ -10,14 +10,12 @@
 **************************************************************************/
 #include "BmsWorker.h"
 #include "TConfig.h"
+#include "MetricsRegistry.h"
 #include <QSerialPortInfo>
 #include <QVector>
 #include <QTimer>
 
 
-static inline quint8 u8(char c) { return static_cast<quint8>(static_cast<unsigned char>(c)); }
-
-
 TF::BmsWorker::BmsWorker(QObject* parent) : QObject(parent) {
 }
 
@@ -31,6 +29,7 @@ void TF::BmsWorker::onInitialize() {
     mPortName = GET_STR_CONFIG("Battery", "PortName").c_str();
     mBaudRate = GET_INT_CONFIG("Battery", "Baud");
     mSlaveId = GET_INT_CONFIG("Battery", "SlaveId");
+    mParser.header().address = mSlaveId;
 
     if (!mSerial) {
         mSerial = new QSerialPort(this);
@@ -133,7 +132,7 @@ bool TF::BmsWorker::openPortSafely() {
     }
 
     mSerial->clear(QSerialPort::AllDirections);
-    mRx.clear();
+    mParser.reset();
     mAwaitingResponse = false;
     mConsecutiveErrors = 0;
 
@@ -151,7 +150,7 @@ void TF::BmsWorker::closePortSafely(const QString& reason) {
         emit logMessage(QString("串口已关闭: %1 (%2)").arg(mPortName, reason));
     }
 
-    mRx.clear();
+    mParser.reset();
     mAwaitingResponse = false;
 
     emit connectionStateChanged(false);
@@ -178,7 +177,7 @@ void TF::BmsWorker::sendReadRequest() {
     const QByteArray req = buildRead03(mSlaveId, mReadStart, mReadCount);
 
     // Parse only current request's response, reduce noise interference.
-    mRx.clear();
+    mParser.reset();
     const qint64 n = mSerial->write(req);
 
     if (n != req.size()) {
@@ -196,129 +195,97 @@ void TF::BmsWorker::sendReadRequest() {
 
 void TF::BmsWorker::onReadyRead() {
     if (!mSerial) return;
-    mRx.append(mSerial->readAll());
-    parseRxBuffer();
-}
 
-void TF::BmsWorker::parseRxBuffer() {
     // Expected:
     // Normal： [addr][0x03][byteCount][data...][crcLo][crcHi]
     // Abnormal： [addr][0x83][excCode][crcLo][crcHi]
-    while (mRx.size() >= 5) {
-        // 1) First align slave address.
-        while (!mRx.isEmpty() && u8(mRx.at(0)) != mSlaveId) {
-            mRx.remove(0, 1);
-        }
-        if (mRx.size() < 5) return;
-
-        const quint8 func = u8(mRx.at(1));
-
-        // 2) Exceptional response
-        if (func == (0x03 | 0x80)) {
-            if (mRx.size() < 5) return;
-            const QByteArray frame = mRx.left(5);
-
-            const quint16 crcRecv = static_cast<quint16>(u8(frame.at(3)) | (u8(frame.at(4)) << 8));
-            const quint16 crcCalc = crc16Modbus(frame.left(3));
-            if (crcRecv != crcCalc) {
-                // CRC error: discard 1 byte and resynchronize.
-                mRx.remove(0, 1);
-                continue;
-            }
-
-            const quint8 exc = u8(frame.at(2));
-            mRx.remove(0, 5);
-
-            if (mResponseTimer) mResponseTimer->stop();
-            mAwaitingResponse = false;
-
-            BmsStatus st;
-            st.mTimestamp = QDateTime::currentDateTime();
-            st.ok = false;
-            st.error = QString("从机异常响应: func=0x%1 exc=0x%2")
-                       .arg(func, 2, 16, QLatin1Char('0'))
-                       .arg(exc, 2, 16, QLatin1Char('0'));
-            emit statusUpdated(st);
-
-            mConsecutiveErrors++;
-            return;
-        }
+    const uint64_t crcErrorsBefore = mParser.checkErrors();
+    const QByteArray data = mSerial->readAll();
+    mParser.feed(reinterpret_cast<const uint8_t*>(data.constData()), static_cast<size_t>(data.size()),
+                 [this](const uint8_t* frame, size_t len) { handleFrame(frame, len); });
+
+    if (mParser.checkErrors() != crcErrorsBefore) {
+        // CRC error: the parser already resynchronized, count it once per read.
+        mConsecutiveErrors++;
+        static auto& crcErrors = MetricsRegistry::instance().counter("serial.bms.crc_errors");
+        crcErrors.add();
+    }
+}
 
-        // 3) Normal response
-        if (func == 0x03) {
-            if (mRx.size() < 3) return;
-            const quint8 byteCount = u8(mRx.at(2));
-            const int frameLen = 3 + byteCount + 2;
-
-            if (mRx.size() < frameLen) return; // Wait for more data
-
-            const QByteArray frame = mRx.left(frameLen);
-            const quint16 crcRecv =
-                static_cast<quint16>(u8(frame.at(frameLen - 2)) | (u8(frame.at(frameLen - 1)) << 8));
-            const quint16 crcCalc = crc16Modbus(frame.left(frameLen - 2));
-
-            if (crcRecv != crcCalc) {
-                // CRC error: discard 1 byte and resynchronize.
-                mRx.remove(0, 1);
-                mConsecutiveErrors++;
-                return;
-            }
-
-            if ((byteCount % 2) != 0) {
-                mRx.remove(0, frameLen);
-                mConsecutiveErrors++;
-                return;
-            }
-
-            const int regCount = byteCount / 2;
-            QVector<quint16> regs;
-            regs.reserve(regCount);
-
-            for (int i = 0; i < regCount; ++i) {
-                const int off = 3 + i * 2;
-                const quint16 v = static_cast<quint16>((u8(frame.at(off)) << 8) | u8(frame.at(off + 1)));
-                regs.push_back(v);
-            }
-
-            mRx.remove(0, frameLen);
-
-            if (mResponseTimer) mResponseTimer->stop();
-            mAwaitingResponse = false;
-            mConsecutiveErrors = 0;
-
-            // Address mapping: start=18
-            if (regs.size() < static_cast<int>(mReadCount)) {
-                // Incomplete data frame (should not happen in theory) — mark as an error.
-                BmsStatus st;
-                st.mTimestamp = QDateTime::currentDateTime();
-                st.ok = false;
-                st.error = QString("寄存器数量不足: got=%1 need=%2").arg(regs.size()).arg(mReadCount);
-                emit statusUpdated(st);
-                return;
-            }
-
-            const quint16 rawV = regs.at(0); // 18
-            const quint16 rawI = regs.at(1); // 19
-            const quint16 rawAh = regs.at(2); // 20
-            const quint16 rawT1 = regs.at(37 - 18); // 37
-            const quint16 rawT2 = regs.at(38 - 18); // 38
-
-            BmsStatus st;
-            st.mTimestamp = QDateTime::currentDateTime();
-            st.ok = true;
-            st.mTotalVoltage_V = decodeTotalVoltageV(rawV);
-            st.mCurrent_A = decodeCurrentA(rawI);
-            st.mRemainCapacity_Ah = decodeCapacityAh(rawAh);
-            st.mTemp1_C = decodeTempC(rawT1);
-            st.mTemp2_C = decodeTempC(rawT2);
-
-            emit statusUpdated(st);
-            return;
-        }
+void TF::BmsWorker::handleFrame(const uint8_t* frame, size_t len) {
+    static auto& frames = MetricsRegistry::instance().counter("serial.bms.frames");
+    frames.add();
+
+    const quint8 func = frame[1];
+
+    // 1) Exceptional response
+    if (func == (0x03 | 0x80)) {
+        const quint8 exc = frame[2];
+
+        if (mResponseTimer) mResponseTimer->stop();
+        mAwaitingResponse = false;
+
+        BmsStatus st;
+        st.mTimestamp = QDateTime::currentDateTime();
+        st.ok = false;
+        st.error = QString("从机异常响应: func=0x%1 exc=0x%2")
+                   .arg(func, 2, 16, QLatin1Char('0'))
+                   .arg(exc, 2, 16, QLatin1Char('0'));
+        emit statusUpdated(st);
+
+        mConsecutiveErrors++;
+        return;
+    }
+
+    // 2) Normal response
+    const quint8 byteCount = frame[2];
+    if ((byteCount % 2) != 0) {
+        mConsecutiveErrors++;
+        return;
+    }
 
-        // 4) Unexpected func code: drop 1 byte, resync.
-        mRx.remove(0, 1);
+    const int regCount = byteCount / 2;
+    QVector<quint16> regs;
+    regs.reserve(regCount);
+
+    for (int i = 0; i < regCount; ++i) {
+        const size_t off = 3 + i * 2;
+        if (off + 1 >= len) break;
+        const quint16 v = static_cast<quint16>((frame[off] << 8) | frame[off + 1]);
+        regs.push_back(v);
     }
+
+    if (mResponseTimer) mResponseTimer->stop();
+    mAwaitingResponse = false;
+    mConsecutiveErrors = 0;
+
+    // Address mapping: start=18
+    if (regs.size() < static_cast<int>(mReadCount)) {
+        // Incomplete data frame (should not happen in theory) — mark as an error.
+        BmsStatus st;
+        st.mTimestamp = QDateTime::currentDateTime();
+        st.ok = false;
+        st.error = QString("寄存器数量不足: got=%1 need=%2").arg(regs.size()).arg(mReadCount);
+        emit statusUpdated(st);
+        return;
+    }
+
+    const quint16 rawV = regs.at(0); // 18
+    const quint16 rawI = regs.at(1); // 19
+    const quint16 rawAh = regs.at(2); // 20
+    const quint16 rawT1 = regs.at(37 - 18); // 37
+    const quint16 rawT2 = regs.at(38 - 18); // 38
+
+    BmsStatus st;
+    st.mTimestamp = QDateTime::currentDateTime();
+    st.ok = true;
+    st.mTotalVoltage_V = decodeTotalVoltageV(rawV);
+    st.mCurrent_A = decodeCurrentA(rawI);
+    st.mRemainCapacity_Ah = decodeCapacityAh(rawAh);
+    st.mTemp1_C = decodeTempC(rawT1);
+    st.mTemp2_C = decodeTempC(rawT2);
+
+    emit statusUpdated(st);
 }
 
 void TF::BmsWorker::onResponseTimeout() {
@@ -396,26 +363,13 @@ QByteArray TF::BmsWorker::buildRead03(quint8 slave, quint16 startAddr, quint16 c
     pdu.append(char((count >> 8) & 0xFF));
     pdu.append(char(count & 0xFF));
 
-    const quint16 crc = crc16Modbus(pdu);
+    const quint16 crc = ModbusCrc16::compute(reinterpret_cast<const uint8_t*>(pdu.constData()),
+                                             static_cast<size_t>(pdu.size()));
     pdu.append(char(crc & 0xFF)); // CRC Lo
     pdu.append(char((crc >> 8) & 0xFF)); // CRC Hi
     return pdu;
 }
 
-quint16 TF::BmsWorker::crc16Modbus(const QByteArray& data) {
-    quint16 crc = 0xFFFF;
-    for (char c : data) {
-        crc ^= static_cast<quint16>(u8(c));
-        for (int i = 0; i < 8; ++i) {
-            if (crc & 0x0001)
-                crc = (crc >> 1) ^ 0xA001;
-            else
-                crc >>= 1;
-        }
-    }
-    return crc;
-}
-
 // -------- 换算（与说明书一致） --------
 double TF::BmsWorker::decodeTotalVoltageV(quint16 raw) { return raw * 0.01; } // 10mV -> 0.01V
 double TF::BmsWorker::decodeCapacityAh(quint16 raw) { return raw * 0.01; } // 10mAh -> 0.01Ah
@@ -12,6 +12,7 @@
 #define FIREAPP_BMSWORKER_H
 
 #include "BmsData.h"
+#include "SerialFrameParser.h"
 #include <QSerialPort>
 
 
@@ -50,10 +51,11 @@ namespace TF {
         void closePortSafely(const QString& reason = QString());
 
         void sendReadRequest();
-        void parseRxBuffer();
+        void handleFrame(const uint8_t* frame, size_t len);
 
         QByteArray buildRead03(quint8 slave, quint16 startAddr, quint16 count) const;
-        static quint16 crc16Modbus(const QByteArray& data);
+
+        using BmsFrameParser = SerialFrameParser<AddressHeader, ModbusReadLength, ModbusCrc16>;
 
         static double decodeTotalVoltageV(quint16 raw);
         static double decodeCapacityAh(quint16 raw);
@@ -70,7 +72,7 @@ namespace TF {
         QTimer* mReconnectTimer = nullptr;
         QTimer* mResponseTimer = nullptr;
 
-        QByteArray mRx;
+        BmsFrameParser mParser;
         bool mAwaitingResponse = false;
         int mConsecutiveErrors = 0;
 
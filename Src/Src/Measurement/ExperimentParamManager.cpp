@@ -94,6 +94,10 @@ namespace TF {
     }
 
     bool ExperimentParamManager::experimentNameExists(const QString &name) const {
+        // 数据库在启动线程上打开，打开前不查询
+        if (!DbManager::instance().isOpen()) {
+            return false;
+        }
         return DbManager::instance().ExperimentNameExists(name.toStdString());
     }
 
@@ -103,6 +107,10 @@ namespace TF {
             if (error) *error = tr("实验名称不能为空");
             return false;
         }
+        if (!DbManager::instance().isOpen()) {
+            if (error) *error = tr("数据库尚未就绪");
+            return false;
+        }
 
         int expId = DbManager::instance().FindExperimentIdByName(trimmed.toStdString());
         if (expId >= 0) {
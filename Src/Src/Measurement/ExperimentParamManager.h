@@ -71,6 +71,7 @@ namespace TF {
 
         [[nodiscard]] bool isRecording() const { return mRecording.load(); }
         [[nodiscard]] QString currentExperimentName() const { return mExperimentName; }
+        [[nodiscard]] QString experimentDir() const { return buildImageDir(); }
 
         bool startRecording(const QString &name, QString *error = nullptr);
         void stopRecording();
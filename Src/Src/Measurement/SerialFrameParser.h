@@ -0,0 +1,256 @@
+/**************************************************************************
+
+           Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : SerialFrameParser.h
+   Author : tao.jing
+   Date   : 2026.10.19
+   Brief  : Frame-sync parser for serial sensors, parameterized on
+            header / length / check policies
+**************************************************************************/
+#ifndef FIREAPP_SERIALFRAMEPARSER_H
+#define FIREAPP_SERIALFRAMEPARSER_H
+
+#include "SpscByteRing.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+namespace TF {
+    // ---------------- Header policies ----------------
+    // find() returns the offset of the first candidate header in [data, data + len),
+    // or len when none is found.
+
+    template <uint8_t... Bytes>
+    struct FixedHeader
+    {
+        static constexpr size_t kSize = sizeof...(Bytes);
+        static constexpr std::array<uint8_t, kSize> kBytes{Bytes...};
+
+        size_t find(const uint8_t* data, size_t len) const {
+            size_t pos = 0;
+            while (pos < len) {
+                const void* hit = std::memchr(data + pos, kBytes[0], len - pos);
+                if (!hit) return len;
+                pos = static_cast<const uint8_t*>(hit) - data;
+                // A partial header at the tail is still a candidate
+                const size_t cmp = std::min(kSize, len - pos);
+                if (std::memcmp(data + pos, kBytes.data(), cmp) == 0) return pos;
+                ++pos;
+            }
+            return len;
+        }
+    };
+
+    // Single runtime byte, e.g. the Modbus slave address
+    struct AddressHeader
+    {
+        uint8_t address = 1;
+
+        size_t find(const uint8_t* data, size_t len) const {
+            const void* hit = std::memchr(data, address, len);
+            return hit ? static_cast<size_t>(static_cast<const uint8_t*>(hit) - data) : len;
+        }
+    };
+
+    // ---------------- Length policies ----------------
+    // frameLength() returns the full frame length, 0 when more bytes are needed to
+    // decide, or -1 when the candidate is not a valid frame start.
+
+    template <int N>
+    struct FixedLength
+    {
+        static constexpr int kMaxFrame = N;
+
+        int frameLength(const uint8_t*, size_t) const { return N; }
+    };
+
+    // Modbus RTU read response: [addr][func][byteCount][data...][crcLo][crcHi]
+    // or the exception form:     [addr][func|0x80][excCode][crcLo][crcHi]
+    struct ModbusReadLength
+    {
+        static constexpr int kMaxFrame = 3 + 255 + 2;
+        uint8_t func = 0x03;
+
+        int frameLength(const uint8_t* data, size_t len) const {
+            if (len < 2) return 0;
+            if (data[1] == (func | 0x80)) return 5;
+            if (data[1] != func) return -1;
+            if (len < 3) return 0;
+            return 3 + data[2] + 2;
+        }
+    };
+
+    // ---------------- Check policies ----------------
+
+    // Modbus / RTU CRC16 (poly 0xA001, init 0xFFFF), stored little endian at the frame tail
+    struct ModbusCrc16
+    {
+        static uint16_t compute(const uint8_t* data, size_t len) {
+            static const std::array<uint16_t, 256> table = [] {
+                std::array<uint16_t, 256> t{};
+                for (uint16_t i = 0; i < 256; ++i) {
+                    uint16_t crc = i;
+                    for (int b = 0; b < 8; ++b)
+                        crc = (crc & 1) ? static_cast<uint16_t>((crc >> 1) ^ 0xA001) : static_cast<uint16_t>(crc >> 1);
+                    t[i] = crc;
+                }
+                return t;
+            }();
+
+            uint16_t crc = 0xFFFF;
+            for (size_t i = 0; i < len; ++i)
+                crc = static_cast<uint16_t>((crc >> 8) ^ table[(crc ^ data[i]) & 0xFF]);
+            return crc;
+        }
+
+        bool verify(const uint8_t* frame, size_t len) const {
+            if (len < 3) return false;
+            const uint16_t recv = static_cast<uint16_t>(frame[len - 2] | (frame[len - 1] << 8));
+            return compute(frame, len - 2) == recv;
+        }
+    };
+
+    // 8-bit additive checksum over all bytes but the last
+    struct SumChecksum8
+    {
+        bool verify(const uint8_t* frame, size_t len) const {
+            if (len < 2) return false;
+            uint8_t sum = 0;
+            for (size_t i = 0; i + 1 < len; ++i)
+                sum = static_cast<uint8_t>(sum + frame[i]);
+            return sum == frame[len - 1];
+        }
+    };
+
+    // ---------------- Parser ----------------
+
+    // Accumulates bytes in a linear work buffer and emits every frame that passes
+    // header, length and check validation. Bytes are consumed by advancing an
+    // offset, the buffer is only compacted once per feed, so resynchronizing after
+    // noise costs O(n) instead of the O(n^2) of erasing from the front.
+    template <typename Header, typename Length, typename Check>
+    class SerialFrameParser
+    {
+    public:
+        explicit SerialFrameParser(Header header = {}, Length length = {}, Check check = {},
+                                   size_t maxBuffered = 4096)
+            : mHeader(header), mLength(length), mCheck(check),
+              mMaxBuffered(std::max<size_t>(maxBuffered, 2 * Length::kMaxFrame)) {
+            mBuf.reserve(mMaxBuffered);
+        }
+
+        Header& header() { return mHeader; }
+        Length& length() { return mLength; }
+
+        // onFrame(const uint8_t* frame, size_t len); returns the number of frames emitted
+        template <typename OnFrame>
+        size_t feed(const uint8_t* data, size_t len, OnFrame&& onFrame) {
+            append(data, len);
+            return scan(onFrame);
+        }
+
+        // Drains everything currently in the ring (consumer side of the ring)
+        template <typename OnFrame>
+        size_t feed(SpscByteRing& ring, OnFrame&& onFrame) {
+            size_t frames = 0;
+            uint8_t chunk[512];
+            size_t n = 0;
+            while ((n = ring.read(chunk, sizeof(chunk))) > 0) {
+                append(chunk, n);
+                frames += scan(onFrame);
+            }
+            return frames;
+        }
+
+        void reset() {
+            mBuf.clear();
+            mBegin = 0;
+        }
+
+        size_t buffered() const { return mBuf.size() - mBegin; }
+        uint64_t frameCount() const { return mFrames; }
+        uint64_t checkErrors() const { return mCheckErrors; }
+        uint64_t discardedBytes() const { return mDiscarded; }
+
+    private:
+        void append(const uint8_t* data, size_t len) {
+            if (mBegin > 0) {
+                mBuf.erase(mBuf.begin(), mBuf.begin() + static_cast<std::ptrdiff_t>(mBegin));
+                mBegin = 0;
+            }
+            mBuf.insert(mBuf.end(), data, data + len);
+            if (mBuf.size() > mMaxBuffered) {
+                // Consumer fell far behind: keep the newest bytes only
+                const size_t drop = mBuf.size() - mMaxBuffered;
+                mBuf.erase(mBuf.begin(), mBuf.begin() + static_cast<std::ptrdiff_t>(drop));
+                mDiscarded += drop;
+            }
+        }
+
+        template <typename OnFrame>
+        size_t scan(OnFrame& onFrame) {
+            size_t frames = 0;
+            while (mBegin < mBuf.size()) {
+                const uint8_t* p = mBuf.data() + mBegin;
+                const size_t avail = mBuf.size() - mBegin;
+
+                const size_t pos = mHeader.find(p, avail);
+                if (pos == avail) {
+                    mDiscarded += avail;
+                    mBegin = mBuf.size();
+                    break;
+                }
+                if (pos > 0) {
+                    mDiscarded += pos;
+                    mBegin += pos;
+                    continue;
+                }
+
+                const int frameLen = mLength.frameLength(p, avail);
+                if (frameLen == 0) break;
+                if (frameLen < 0) {
+                    ++mDiscarded;
+                    ++mBegin;
+                    continue;
+                }
+                if (avail < static_cast<size_t>(frameLen)) break;
+
+                if (!mCheck.verify(p, static_cast<size_t>(frameLen))) {
+                    // Resync one byte later, a real header may be inside this candidate
+                    ++mCheckErrors;
+                    ++mDiscarded;
+                    ++mBegin;
+                    continue;
+                }
+
+                onFrame(p, static_cast<size_t>(frameLen));
+                mBegin += static_cast<size_t>(frameLen);
+                ++mFrames;
+                ++frames;
+            }
+            return frames;
+        }
+
+    private:
+        Header mHeader;
+        Length mLength;
+        Check mCheck;
+
+        std::vector<uint8_t> mBuf;
+        size_t mBegin = 0;
+        size_t mMaxBuffered;
+
+        uint64_t mFrames = 0;
+        uint64_t mCheckErrors = 0;
+        uint64_t mDiscarded = 0;
+    };
+};
+
+
+#endif //FIREAPP_SERIALFRAMEPARSER_H
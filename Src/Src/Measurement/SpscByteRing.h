@@ -0,0 +1,100 @@
+/**************************************************************************
+
+           Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : SpscByteRing.h
+   Author : tao.jing
+   Date   : 2026.10.19
+   Brief  : Lock-free single-producer / single-consumer byte ring
+**************************************************************************/
+#ifndef FIREAPP_SPSCBYTERING_H
+#define FIREAPP_SPSCBYTERING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+
+namespace TF {
+    // Exactly one thread may call write() and exactly one thread may call read().
+    // Capacity is rounded up to a power of two; bytes that do not fit are dropped
+    // and counted, so a stalled consumer never blocks the serial reader.
+    class SpscByteRing
+    {
+    public:
+        explicit SpscByteRing(size_t capacity = 4096) {
+            size_t cap = 1;
+            while (cap < capacity) cap <<= 1;
+            mCapacity = cap;
+            mMask = cap - 1;
+            mBuf = std::make_unique<uint8_t[]>(cap);
+        }
+
+        SpscByteRing(const SpscByteRing&) = delete;
+        SpscByteRing& operator=(const SpscByteRing&) = delete;
+
+        // Producer side
+        size_t write(const uint8_t* data, size_t len) {
+            const size_t head = mHead.load(std::memory_order_relaxed);
+            const size_t tail = mTail.load(std::memory_order_acquire);
+            const size_t space = mCapacity - (head - tail);
+            const size_t n = std::min(len, space);
+            if (n < len) {
+                mDropped.fetch_add(len - n, std::memory_order_relaxed);
+            }
+            if (n == 0) return 0;
+
+            const size_t off = head & mMask;
+            const size_t first = std::min(n, mCapacity - off);
+            std::memcpy(mBuf.get() + off, data, first);
+            std::memcpy(mBuf.get(), data + first, n - first);
+            mHead.store(head + n, std::memory_order_release);
+            return n;
+        }
+
+        // Consumer side
+        size_t read(uint8_t* dst, size_t maxLen) {
+            const size_t tail = mTail.load(std::memory_order_relaxed);
+            const size_t head = mHead.load(std::memory_order_acquire);
+            const size_t n = std::min(maxLen, head - tail);
+            if (n == 0) return 0;
+
+            const size_t off = tail & mMask;
+            const size_t first = std::min(n, mCapacity - off);
+            std::memcpy(dst, mBuf.get() + off, first);
+            std::memcpy(dst + first, mBuf.get(), n - first);
+            mTail.store(tail + n, std::memory_order_release);
+            return n;
+        }
+
+        // Consumer side; drops everything currently buffered
+        void clear() {
+            mTail.store(mHead.load(std::memory_order_acquire), std::memory_order_release);
+        }
+
+        size_t size() const {
+            return mHead.load(std::memory_order_acquire) - mTail.load(std::memory_order_acquire);
+        }
+
+        bool empty() const { return size() == 0; }
+        size_t capacity() const { return mCapacity; }
+        uint64_t droppedBytes() const { return mDropped.load(std::memory_order_relaxed); }
+
+    private:
+        std::unique_ptr<uint8_t[]> mBuf;
+        size_t mCapacity = 0;
+        size_t mMask = 0;
+
+        // Monotonic counters, wrap-around is harmless for unsigned arithmetic
+        alignas(64) std::atomic<size_t> mHead{0};
+        alignas(64) std::atomic<size_t> mTail{0};
+        std::atomic<uint64_t> mDropped{0};
+    };
+};
+
+
+#endif //FIREAPP_SPSCBYTERING_H
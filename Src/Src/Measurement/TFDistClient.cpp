@@ -11,6 +11,7 @@
 #include "TFDistClient.h"
 #include "TFMeaManager.h"
 #include "TConfig.h"
+#include "MetricsRegistry.h"
 #include "TFException.h"
 #include <QTimer>
 #include <QDebug>
@@ -60,10 +61,26 @@ qint64 TF::DistRecvWorker::sendRaw(const QByteArray& bytes) {
     return mPort->write(bytes);
 }
 
+void TF::DistRecvWorker::setSink(SpscByteRing *ring, std::function<void()> notify) {
+    mRing = ring;
+    mNotify = std::move(notify);
+}
+
 void TF::DistRecvWorker::onReadyRead() {
-    QByteArray data = mPort->readAll();
-    if (!data.isEmpty())
-        emit bytesArrived(data);
+    if (!mRing) {
+        mPort->readAll();
+        return;
+    }
+
+    char buf[512];
+    qint64 total = 0;
+    qint64 n = 0;
+    while ((n = mPort->read(buf, sizeof(buf))) > 0) {
+        mRing->write(reinterpret_cast<const uint8_t*>(buf), static_cast<size_t>(n));
+        total += n;
+    }
+    if (total > 0 && mNotify)
+        mNotify();
 }
 
 
@@ -80,6 +97,8 @@ bool TF::TFDistClient::open() {
     mMode = GET_STR_CONFIG("Distance", "Mode");
 
     mFilter.reset();
+    mRing.clear();
+    mParser.reset();
 
     DistSettings s;
     s.portName = GET_STR_CONFIG("Distance", "Port").c_str();
@@ -91,8 +110,7 @@ bool TF::TFDistClient::open() {
     connect(&mRecvThread, &QThread::finished,
         mWorker, &QObject::deleteLater);
 
-    connect(mWorker, &DistRecvWorker::bytesArrived,
-        this, &TFDistClient::onBytesArrived, Qt::QueuedConnection);
+    mWorker->setSink(&mRing, [this] { notifyBytes(); });
 
     mRecvThread.start();
 
@@ -162,13 +180,7 @@ void TF::TFDistClient::close() {
             mParseThread.join();
     }
 
-    // 3) Clear data queue
-    {
-        std::lock_guard<std::mutex> lk(mMtx);
-        mQueue.clear();
-    }
-
-    // 4) Close port + Stop receiving thread
+    // 3) Close port + Stop receiving thread
     if (mWorker) {
         QMetaObject::invokeMethod(mWorker, &DistRecvWorker::closePort, Qt::BlockingQueuedConnection);
         mRecvThread.quit();
@@ -176,108 +188,55 @@ void TF::TFDistClient::close() {
         mWorker = nullptr;
     }
 
+    // 4) Clear data ring (both ends are stopped now)
+    mRing.clear();
+    mParser.reset();
+
     mFilter.reset();
 }
 
-void TF::TFDistClient::onBytesArrived(const QByteArray& bytes) {
-    {
-        std::lock_guard<std::mutex> lk(mMtx);
-        for (auto ch : bytes) {
-            mQueue.push_back(static_cast<uint8_t>(ch));
-        }
-    }
+void TF::TFDistClient::notifyBytes() {
+    // Empty critical section orders the ring write before the wait predicate check,
+    // so the wake-up can not be lost; no per-byte locking is needed
+    { std::lock_guard<std::mutex> lk(mMtx); }
     mCv.notify_one();
 }
 
 void TF::TFDistClient::parseLoop() {
-while (mRunning.load()) {
-        std::unique_lock<std::mutex> lk(mMtx);
-        mCv.wait(lk, [&] { return !mRunning.load() || !mQueue.empty(); });
-        if (!mRunning.load()) break;
-
-        // Header is longer than 3
-        if (mQueue.size() < 3) continue;
-
-        auto findHeader = [&]() -> int {
-            const int n = static_cast<int>(mQueue.size());
-            for (int i = 0; i <= n - 3; ++i) {
-                if (mQueue[i] == H0 && mQueue[i + 1] == H1 && mQueue[i + 2] == H2)
-                    return i;
-            }
-            return -1;
-        };
-
-        int idx = findHeader();
-        if (idx < 0) {
-            // No header found, keep the last 2 bytes
-            while (mQueue.size() > 2) mQueue.pop_front();
-            continue;
-        }
-
-        // Discard the noisy headers
-        for (int i = 0; i < idx; ++i) mQueue.pop_front();
-
-        // Got 01 03 04, but may not enough 9 bytes
-        if (mQueue.size() < 9) {
-            // Wait for more data
-            mCv.wait_for(lk, std::chrono::milliseconds(50), [&] { return !mRunning.load() || mQueue.size() >= 9; });
-            continue;
-        }
-
-        uint8_t frame[9];
-        for (int i = 0; i < 9; ++i) frame[i] = mQueue[i];
-
-        if (!checkFrameCrc9(frame)) {
-            // CRC check failed
-            for (int i = 0; i < 3 && !mQueue.empty(); ++i) mQueue.pop_front();
-            continue;
+    while (mRunning.load()) {
+        {
+            std::unique_lock<std::mutex> lk(mMtx);
+            mCv.wait(lk, [&] { return !mRunning.load() || !mRing.empty(); });
         }
+        if (!mRunning.load()) break;
 
-        // CRC passed, pop this frame
-        for (int i = 0; i < 9; ++i) mQueue.pop_front();
-        lk.unlock();
-
-        // Parse data: 01 03 04 [D0 D1 D2 D3] CRC_L CRC_H
-        const uint32_t raw =
-            (static_cast<uint32_t>(frame[3]) << 24) |
-            (static_cast<uint32_t>(frame[4]) << 16) |
-            (static_cast<uint32_t>(frame[5]) << 8)  |
-            (static_cast<uint32_t>(frame[6]) << 0);
-
-        const float meters = static_cast<float>(raw) / 10000.0;
-
-        if (auto filtered = mFilter.update(meters)) {
-            //qDebug() << QString("LDS distance = %1 m (raw=%2)").arg(meters, 0, 'f', 4).arg(raw);
-            //emit distanceUpdated(*filtered);
-            TFMeaManager::instance().updateCurDist(meters);
-        } else {
-            // Discard this sample
-        }
+        mParser.feed(mRing, [this](const uint8_t* frame, size_t len) {
+            handleFrame(frame, len);
+        });
     }
 }
 
-uint16_t TF::TFDistClient::crc16Rtu(const uint8_t* data, size_t len) {
-    // RTU CRC16：0xA001, initial value 0xFFFF
-    uint16_t crc = 0xFFFF;
-    for (size_t i = 0; i < len; ++i) {
-        crc ^= data[i];
-        for (int b = 0; b < 8; ++b) {
-            if (crc & 1) {
-                crc >>= 1;
-                crc ^= 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
+void TF::TFDistClient::handleFrame(const uint8_t* frame, size_t len) {
+    (void)len;
+    static auto& frames = MetricsRegistry::instance().counter("serial.dist.frames");
+    frames.add();
+
+    // Parse data: 01 03 04 [D0 D1 D2 D3] CRC_L CRC_H
+    const uint32_t raw =
+        (static_cast<uint32_t>(frame[3]) << 24) |
+        (static_cast<uint32_t>(frame[4]) << 16) |
+        (static_cast<uint32_t>(frame[5]) << 8)  |
+        (static_cast<uint32_t>(frame[6]) << 0);
+
+    const float meters = static_cast<float>(raw) / 10000.0;
+
+    if (auto filtered = mFilter.update(meters)) {
+        //qDebug() << QString("LDS distance = %1 m (raw=%2)").arg(meters, 0, 'f', 4).arg(raw);
+        //emit distanceUpdated(*filtered);
+        TFMeaManager::instance().updateCurDist(meters);
+    } else {
+        // Discard this sample
     }
-    return crc;
-}
-
-bool TF::TFDistClient::checkFrameCrc9(const uint8_t frame[9]) {
-    // frame[0..6] CRC, frame[7]=CRC_L, frame[8]=CRC_H
-    const uint16_t crcCalc = crc16Rtu(frame, 7);
-    const uint16_t crcRecv = static_cast<uint16_t>(frame[7]) | (static_cast<uint16_t>(frame[8]) << 8);
-    return crcCalc == crcRecv;
 }
 
 QByteArray TF::TFDistClient::cmdOpenContinuous() {
@@ -11,9 +11,10 @@
 #ifndef FIREAPP_TFDISTCLIENT_H
 #define FIREAPP_TFDISTCLIENT_H
 
+#include "SerialFrameParser.h"
 #include <QThread>
 #include <QtSerialPort/QSerialPort>
-#include <deque>
+#include <functional>
 
 
 namespace TF {
@@ -93,14 +94,17 @@ namespace TF {
 
         Q_INVOKABLE qint64 sendRaw(const QByteArray &bytes);
 
-    signals:
-        void bytesArrived(const QByteArray& bytes);
+        // Received bytes are written straight into ring from the receiving thread,
+        // then notify is called to wake the consumer
+        void setSink(SpscByteRing *ring, std::function<void()> notify);
 
     private slots:
         void onReadyRead();
 
     private:
         QSerialPort *mPort {nullptr};
+        SpscByteRing *mRing {nullptr};
+        std::function<void()> mNotify;
     };
 
     class TFDistClient : public QObject
@@ -117,20 +121,15 @@ namespace TF {
     signals:
         void distanceUpdated(float meters);
 
-    private slots:
-        void onBytesArrived(const QByteArray& bytes);
-
     private:
         bool triggerOnceReadDistance();
 
+        void notifyBytes();
         void parseLoop();
+        void handleFrame(const uint8_t* frame, size_t len);
 
-        static uint16_t crc16Rtu(const uint8_t* data, size_t len);
-        static bool checkFrameCrc9(const uint8_t frame[9]);
-
-        static constexpr uint8_t H0 = 0x01;
-        static constexpr uint8_t H1 = 0x03;
-        static constexpr uint8_t H2 = 0x04;
+        // 01 03 04 [D0 D1 D2 D3] CRC_L CRC_H
+        using DistFrameParser = SerialFrameParser<FixedHeader<0x01, 0x03, 0x04>, FixedLength<9>, ModbusCrc16>;
 
         static QByteArray cmdOpenContinuous();   // 01 06 00 11 00 02 58 0E
         static QByteArray cmdReadDistanceOnce(); // 01 03 00 15 00 02 D5 CF
@@ -143,10 +142,11 @@ namespace TF {
         QThread mRecvThread;
         DistRecvWorker* mWorker = nullptr;
 
-        // byte queue (producer-consumer)
+        // byte ring (producer: receiving thread, consumer: parsing thread)
+        SpscByteRing mRing {4096};
+        DistFrameParser mParser;
         std::mutex mMtx;
         std::condition_variable mCv;
-        std::deque<uint8_t> mQueue;
 
         std::atomic_bool mRunning{false};
         std::thread mParseThread;
@@ -11,14 +11,12 @@
 #include "WitImuSerial.h"
 #include "TFMeaManager.h"
 #include "TConfig.h"
+#include "MetricsRegistry.h"
 #include <QtEndian>
 #include <QDateTime>
 #include <QMutexLocker>
 
 
-constexpr int kFrameSize = 11;
-constexpr quint8 kHeader = 0x55;
-
 constexpr quint8 kTypeAcc = 0x51;
 constexpr quint8 kTypeGyro = 0x52;
 constexpr quint8 kTypeAngle = 0x53;
@@ -28,10 +26,6 @@ constexpr float kAccScale = 16.0f / 32768.0f;
 constexpr float kGyroScale = 2000.0f / 32768.0f;
 constexpr float kAngleScale = 180.0f / 32768.0f;
 
-inline quint8 u8(char c) {
-    return static_cast<quint8>(static_cast<unsigned char>(c));
-}
-
 Q_DECLARE_METATYPE(WitImuData);
 
 
@@ -40,6 +34,8 @@ TF::WitImuSerial::WitImuSerial(QObject* parent)
     qRegisterMetaType<WitImuData>("WitImuData");
 
     mSerial = new QSerialPort(this);
+    // 200 Hz * 4 frames * 11 bytes is ~9 KB/s; keep the driver buffer bounded
+    mSerial->setReadBufferSize(16 * 1024);
 
     connect(mSerial, &QSerialPort::readyRead, this, &WitImuSerial::onReadyRead);
     connect(mSerial, &QSerialPort::errorOccurred, this, &WitImuSerial::onPortError);
@@ -67,7 +63,7 @@ bool TF::WitImuSerial::open() {
         return false;
     }
 
-    mRecvArray.clear();
+    mParser.reset();
 
     {
         QMutexLocker locker(&mMtx);
@@ -81,7 +77,7 @@ void TF::WitImuSerial::close() {
     if (mSerial->isOpen())
         mSerial->close();
 
-    mRecvArray.clear();
+    mParser.reset();
 }
 
 bool TF::WitImuSerial::isOpen() const {
@@ -102,11 +98,13 @@ void TF::WitImuSerial::onRequestWitImuClose() {
 }
 
 void TF::WitImuSerial::onReadyRead() {
-    mRecvArray.append(mSerial->readAll());
-    parseRxBuffer();
-
-    if (mRecvArray.size() > 8192)
-        mRecvArray.remove(0, mRecvArray.size() - 2048);
+    // Parser keeps its own bounded buffer, so no trimming is needed here
+    char buf[1024];
+    qint64 n = 0;
+    while ((n = mSerial->read(buf, sizeof(buf))) > 0) {
+        mParser.feed(reinterpret_cast<const uint8_t*>(buf), static_cast<size_t>(n),
+                     [this](const uint8_t* frame, size_t) { handleFrame11(frame); });
+    }
 }
 
 void TF::WitImuSerial::onPortError(QSerialPort::SerialPortError error) {
@@ -114,21 +112,13 @@ void TF::WitImuSerial::onPortError(QSerialPort::SerialPortError error) {
     emit serialError(mSerial->errorString());
 }
 
-bool TF::WitImuSerial::checkFrame11(const QByteArray& frame) {
-    if (frame.size() != kFrameSize) return false;
-    if (u8(frame[0]) != kHeader) return false;
-
-    quint8 sum = 0;
-    for (int i = 0; i < 10; ++i)
-        sum = static_cast<quint8>(sum + u8(frame[i]));
-
-    return sum == u8(frame[10]);
-}
+void TF::WitImuSerial::handleFrame11(const uint8_t* frame) {
+    static auto& frames = MetricsRegistry::instance().counter("serial.imu.frames");
+    frames.add();
 
-void TF::WitImuSerial::handleFrame11(const QByteArray& frame) {
-    const quint8 type = u8(frame[1]);
+    const quint8 type = frame[1];
 
-    const uchar* p = reinterpret_cast<const uchar*>(frame.constData() + 2);
+    const uchar* p = frame + 2;
     const qint16 v0 = qFromLittleEndian<qint16>(p + 0);
     const qint16 v1 = qFromLittleEndian<qint16>(p + 2);
     const qint16 v2 = qFromLittleEndian<qint16>(p + 4);
@@ -179,27 +169,3 @@ void TF::WitImuSerial::handleFrame11(const QByteArray& frame) {
     //emit dataUpdated(snapshot);
     TFMeaManager::instance().updateWitImuData(snapshot);
 }
-
-void TF::WitImuSerial::parseRxBuffer() {
-    while (true) {
-        const int idx = mRecvArray.indexOf(char(kHeader));
-        if (idx < 0) {
-            mRecvArray.clear();
-            return;
-        }
-        if (idx > 0)
-            mRecvArray.remove(0, idx);
-
-        if (mRecvArray.size() < kFrameSize)
-            return;
-
-        const QByteArray frame = mRecvArray.left(kFrameSize);
-        if (!checkFrame11(frame)) {
-            mRecvArray.remove(0, 1);
-            continue;
-        }
-
-        handleFrame11(frame);
-        mRecvArray.remove(0, kFrameSize);
-    }
-}
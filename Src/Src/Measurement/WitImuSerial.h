@@ -12,8 +12,8 @@
 #define FIREAPP_WITIMUSERIAL_H
 
 #include "WitImuData.h"
+#include "SerialFrameParser.h"
 #include <QSerialPort>
-#include <QByteArray>
 #include <QMutex>
 
 
@@ -47,14 +47,15 @@ namespace TF {
         void onPortError(QSerialPort::SerialPortError error);
 
     private:
-        void parseRxBuffer();
-        static bool checkFrame11(const QByteArray& frame);
-        void handleFrame11(const QByteArray& frame);
+        void handleFrame11(const uint8_t* frame);
+
+        // 0x55 [type] [8 data bytes] [sum]
+        using ImuFrameParser = SerialFrameParser<FixedHeader<0x55>, FixedLength<11>, SumChecksum8>;
 
     private:
         mutable QMutex mMtx;
         QSerialPort *mSerial {nullptr};
-        QByteArray mRecvArray;
+        ImuFrameParser mParser;
 
         WitImuData mData;
     };
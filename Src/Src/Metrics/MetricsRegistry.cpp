@@ -0,0 +1,288 @@
+/**************************************************************************
+
+           Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : MetricsRegistry.cpp
+   Author : tao.jing
+   Date   : 2026.10.19
+   Brief  : In-process counters, gauges and latency histograms
+**************************************************************************/
+#include "MetricsRegistry.h"
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include "TConfig.h"
+#include "TLog.h"
+#include "DataPubZmqManager.h"
+
+
+namespace TF {
+
+    namespace {
+        std::atomic<int> sNextShard{0};
+
+        int64_t currentTimestampMs() {
+            auto now = std::chrono::system_clock::now();
+            return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+        }
+
+        int64_t percentile(const std::array<int64_t, HdrBuckets::Count> &buckets, int64_t count, double p,
+                           int64_t max) {
+            const auto rank = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(p * static_cast<double>(count))));
+            int64_t seen = 0;
+            for (int i = 0; i < HdrBuckets::Count; ++i) {
+                seen += buckets[i];
+                if (seen >= rank) {
+                    return std::min(HdrBuckets::upperOf(i), max);
+                }
+            }
+            return max;
+        }
+
+        void appendFormat(std::string &out, const char *format, ...) {
+            char buf[256];
+            va_list args;
+            va_start(args, format);
+            const int len = std::vsnprintf(buf, sizeof(buf), format, args);
+            va_end(args);
+            if (len > 0) {
+                out.append(buf, std::min<std::size_t>(static_cast<std::size_t>(len), sizeof(buf) - 1));
+            }
+        }
+    }
+
+    int HdrBuckets::indexOf(int64_t value) {
+        if (value < Linear) {
+            return static_cast<int>(std::max<int64_t>(value, 0));
+        }
+        // Top three bits of the value: the power of two and one of four steps inside it
+        const int exponent = std::bit_width(static_cast<uint64_t>(value)) - 1;
+        const int step = static_cast<int>((value >> (exponent - 2)) & 3);
+        return std::min(Linear + (exponent - 4) * 4 + step, Count - 1);
+    }
+
+    int64_t HdrBuckets::upperOf(int index) {
+        if (index < Linear) {
+            return index;
+        }
+        const int exponent = 4 + (index - Linear) / 4;
+        const int step = (index - Linear) % 4;
+        return (static_cast<int64_t>(4 + step + 1) << (exponent - 2)) - 1;
+    }
+
+    int MetricCounter::shardIndex() {
+        thread_local const int index = sNextShard.fetch_add(1, std::memory_order_relaxed) % ShardCount;
+        return index;
+    }
+
+    int64_t MetricCounter::value() const {
+        int64_t total = 0;
+        for (const auto &shard : mShards) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void MetricHistogram::record(int64_t us) {
+        mBuckets[HdrBuckets::indexOf(us)].fetch_add(1, std::memory_order_relaxed);
+        mSum.fetch_add(us, std::memory_order_relaxed);
+        int64_t max = mMax.load(std::memory_order_relaxed);
+        while (us > max && !mMax.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    HistogramSnapshot MetricHistogram::take() {
+        // Samples racing with the reset land in this or the next interval, none are lost
+        std::array<int64_t, HdrBuckets::Count> buckets{};
+        HistogramSnapshot snapshot;
+        for (int i = 0; i < HdrBuckets::Count; ++i) {
+            buckets[i] = mBuckets[i].exchange(0, std::memory_order_relaxed);
+            snapshot.count += buckets[i];
+        }
+        const int64_t sum = mSum.exchange(0, std::memory_order_relaxed);
+        snapshot.max = mMax.exchange(0, std::memory_order_relaxed);
+        if (snapshot.count == 0) {
+            return snapshot;
+        }
+
+        snapshot.mean = static_cast<double>(sum) / static_cast<double>(snapshot.count);
+        snapshot.p50 = percentile(buckets, snapshot.count, 0.50, snapshot.max);
+        snapshot.p95 = percentile(buckets, snapshot.count, 0.95, snapshot.max);
+        snapshot.p99 = percentile(buckets, snapshot.count, 0.99, snapshot.max);
+        return snapshot;
+    }
+
+    MetricsRegistry::~MetricsRegistry() {
+        shutdown();
+    }
+
+    void MetricsRegistry::init() {
+        if (mRunning.load()) {
+            return;
+        }
+
+        if (!GET_BOOL_CONFIG("Metrics", "Enabled")) {
+            return;
+        }
+        mIntervalSec = std::max(1, GET_INT_CONFIG("Metrics", "IntervalSec"));
+        mFilePath = GET_STR_CONFIG("Metrics", "FilePath");
+        mMaxFileBytes = static_cast<int64_t>(std::max(1, GET_INT_CONFIG("Metrics", "MaxFileKB"))) * 1024;
+        mFileCount = std::max(1, GET_INT_CONFIG("Metrics", "FileCount"));
+        mZmqEnabled = GET_BOOL_CONFIG("Metrics", "ZmqEnabled");
+
+        std::error_code ec;
+        const auto dir = std::filesystem::path(mFilePath).parent_path();
+        if (!dir.empty()) {
+            std::filesystem::create_directories(dir, ec);
+        }
+
+        mLastExport = std::chrono::steady_clock::now();
+        mRunning.store(true);
+        mExportThread = std::thread(&MetricsRegistry::exportThreadFunc, this);
+
+        LOG_F(INFO, "MetricsRegistry exporting every %d s to %s%s", mIntervalSec, mFilePath.c_str(),
+              mZmqEnabled ? " and ZMQ" : "");
+    }
+
+    void MetricsRegistry::shutdown() {
+        if (!mRunning.exchange(false)) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mWaitMutex);
+        }
+        mCond.notify_all();
+
+        if (mExportThread.joinable()) {
+            mExportThread.join();
+        }
+
+        // Last partial interval goes to the file only, the publisher may already be down
+        writeLine(snapshotJson());
+    }
+
+    MetricCounter &MetricsRegistry::counter(const std::string &name) {
+        std::lock_guard<std::mutex> lock(mRegistryMutex);
+        auto &metric = mCounters[name];
+        if (!metric) {
+            metric = std::make_unique<MetricCounter>();
+        }
+        return *metric;
+    }
+
+    MetricGauge &MetricsRegistry::gauge(const std::string &name) {
+        std::lock_guard<std::mutex> lock(mRegistryMutex);
+        auto &metric = mGauges[name];
+        if (!metric) {
+            metric = std::make_unique<MetricGauge>();
+        }
+        return *metric;
+    }
+
+    MetricHistogram &MetricsRegistry::histogram(const std::string &name) {
+        std::lock_guard<std::mutex> lock(mRegistryMutex);
+        auto &metric = mHistograms[name];
+        if (!metric) {
+            metric = std::make_unique<MetricHistogram>();
+        }
+        return *metric;
+    }
+
+    std::string MetricsRegistry::snapshotJson() {
+        const auto now = std::chrono::steady_clock::now();
+        const double interval = std::max(1e-3, std::chrono::duration<double>(now - mLastExport).count());
+        mLastExport = now;
+
+        std::string json;
+        json.reserve(4096);
+        appendFormat(json, "{\"ts\":%" PRId64 ",\"interval\":%.3f,\"counters\":{", currentTimestampMs(), interval);
+
+        std::lock_guard<std::mutex> lock(mRegistryMutex);
+        bool first = true;
+        for (const auto &[name, metric] : mCounters) {
+            const int64_t total = metric->value();
+            int64_t &last = mLastCounts[name];
+            appendFormat(json, "%s\"%s\":{\"total\":%" PRId64 ",\"rate\":%.2f}", first ? "" : ",", name.c_str(),
+                         total, static_cast<double>(total - last) / interval);
+            last = total;
+            first = false;
+        }
+
+        json += "},\"gauges\":{";
+        first = true;
+        for (const auto &[name, metric] : mGauges) {
+            appendFormat(json, "%s\"%s\":%.6g", first ? "" : ",", name.c_str(), metric->value());
+            first = false;
+        }
+
+        json += "},\"histograms\":{";
+        first = true;
+        for (const auto &[name, metric] : mHistograms) {
+            const auto s = metric->take();
+            appendFormat(json, "%s\"%s\":{\"count\":%" PRId64 ",\"mean\":%.1f,\"p50\":%" PRId64 ",\"p95\":%" PRId64
+                               ",\"p99\":%" PRId64 ",\"max\":%" PRId64 "}",
+                         first ? "" : ",", name.c_str(), s.count, s.mean, s.p50, s.p95, s.p99, s.max);
+            first = false;
+        }
+        json += "}}";
+        return json;
+    }
+
+    void MetricsRegistry::writeLine(const std::string &line) {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+
+        // metrics.jsonl -> metrics.1.jsonl -> ... -> metrics.<FileCount-1>.jsonl, the oldest is dropped
+        const fs::path path(mFilePath);
+        const auto size = fs::file_size(path, ec);
+        if (!ec && static_cast<int64_t>(size) >= mMaxFileBytes) {
+            const auto rotated = [&path](int index) {
+                fs::path p = path;
+                return p.replace_extension(std::to_string(index) + path.extension().string());
+            };
+            fs::remove(rotated(mFileCount - 1), ec);
+            for (int i = mFileCount - 2; i >= 1; --i) {
+                fs::rename(rotated(i), rotated(i + 1), ec);
+            }
+            if (mFileCount > 1) {
+                fs::rename(path, rotated(1), ec);
+            }
+            else {
+                fs::remove(path, ec);
+            }
+        }
+
+        std::ofstream file(path, std::ios::app);
+        if (!file) {
+            LOG_F(ERROR, "MetricsRegistry failed to open %s", mFilePath.c_str());
+            return;
+        }
+        file << line << '\n';
+    }
+
+    void MetricsRegistry::exportThreadFunc() {
+        while (mRunning.load()) {
+            {
+                std::unique_lock<std::mutex> lock(mWaitMutex);
+                mCond.wait_for(lock, std::chrono::seconds(mIntervalSec), [this] { return !mRunning.load(); });
+            }
+            if (!mRunning.load()) {
+                break;
+            }
+
+            const std::string json = snapshotJson();
+            writeLine(json);
+            if (mZmqEnabled) {
+                DataPubZmqManager::instance().publishMetrics(json);
+            }
+        }
+    }
+
+}
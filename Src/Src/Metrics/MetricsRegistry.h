@@ -0,0 +1,172 @@
+/**************************************************************************
+
+           Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : MetricsRegistry.h
+   Author : tao.jing
+   Date   : 2026.10.19
+   Brief  : In-process counters, gauges and latency histograms
+**************************************************************************/
+#ifndef FIREAPP_METRICSREGISTRY_H
+#define FIREAPP_METRICSREGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <TSingleton.h>
+
+
+namespace TF {
+
+    // Log-linear bucket layout of the latency histograms: values below Linear get a bucket
+    // each, above that four buckets per power of two (about 20% relative error)
+    struct HdrBuckets {
+        static constexpr int Linear = 16;
+        static constexpr int Count = Linear + 4 * 36;
+
+        static int indexOf(int64_t value);
+
+        // Largest value that falls into the bucket
+        static int64_t upperOf(int index);
+    };
+
+    // Monotonic counter spread over cache-line sized shards. Every thread adds to its own
+    // shard, so writers never share a cache line; reading sums the shards.
+    class MetricCounter {
+    public:
+        void add(int64_t n = 1) {
+            mShards[shardIndex()].value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] int64_t value() const;
+
+    private:
+        static constexpr int ShardCount = 16;
+
+        struct alignas(64) Shard {
+            std::atomic<int64_t> value{0};
+        };
+
+        static int shardIndex();
+
+        std::array<Shard, ShardCount> mShards{};
+    };
+
+    // Last written value, for queue depths and backlogs
+    class MetricGauge {
+    public:
+        void set(double value) { mValue.store(value, std::memory_order_relaxed); }
+
+        [[nodiscard]] double value() const { return mValue.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> mValue{0.0};
+    };
+
+    struct HistogramSnapshot {
+        int64_t count{0};
+        double mean{0.0};
+        int64_t p50{0};
+        int64_t p95{0};
+        int64_t p99{0};
+        int64_t max{0};
+    };
+
+    // Lock-free histogram of microsecond latencies. An export takes the samples recorded
+    // since the previous one, so percentiles always describe the last interval.
+    class MetricHistogram {
+    public:
+        void record(int64_t us);
+
+        HistogramSnapshot take();
+
+    private:
+        std::array<std::atomic<int64_t>, HdrBuckets::Count> mBuckets{};
+        std::atomic<int64_t> mSum{0};
+        std::atomic<int64_t> mMax{0};
+    };
+
+    // Records the lifetime of the scope into a histogram
+    class MetricTimer {
+    public:
+        explicit MetricTimer(MetricHistogram &histogram)
+            : mHistogram(histogram), mStart(std::chrono::steady_clock::now()) {
+        }
+
+        ~MetricTimer() {
+            mHistogram.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - mStart).count());
+        }
+
+        MetricTimer(const MetricTimer &) = delete;
+
+        MetricTimer &operator=(const MetricTimer &) = delete;
+
+    private:
+        MetricHistogram &mHistogram;
+        std::chrono::steady_clock::time_point mStart;
+    };
+
+    // Named metrics, exported every IntervalSec as one JSON line to a size-rotated file and,
+    // with ZmqEnabled, on the result PUB socket. Lookups take a lock, so call sites keep the
+    // returned reference in a function-local static; updating a metric never locks.
+    class MetricsRegistry : public TBase::TSingleton<MetricsRegistry> {
+    public:
+        ~MetricsRegistry();
+
+        void init();
+
+        void shutdown();
+
+        // References stay valid for the life of the process
+        MetricCounter &counter(const std::string &name);
+
+        MetricGauge &gauge(const std::string &name);
+
+        MetricHistogram &histogram(const std::string &name);
+
+        // Counters as total and rate over the interval, histograms are reset
+        std::string snapshotJson();
+
+    private:
+        friend class TBase::TSingleton<MetricsRegistry>;
+        MetricsRegistry() = default;
+
+        void exportThreadFunc();
+
+        void writeLine(const std::string &line);
+
+        std::mutex mRegistryMutex;
+        std::map<std::string, std::unique_ptr<MetricCounter>> mCounters;
+        std::map<std::string, std::unique_ptr<MetricGauge>> mGauges;
+        std::map<std::string, std::unique_ptr<MetricHistogram>> mHistograms;
+
+        // Export thread only
+        std::map<std::string, int64_t> mLastCounts;
+        std::chrono::steady_clock::time_point mLastExport{std::chrono::steady_clock::now()};
+
+        int mIntervalSec{10};
+        std::string mFilePath;
+        int64_t mMaxFileBytes{4 * 1024 * 1024};
+        int mFileCount{5};
+        bool mZmqEnabled{false};
+
+        std::thread mExportThread;
+        std::mutex mWaitMutex;
+        std::condition_variable mCond;
+        std::atomic<bool> mRunning{false};
+    };
+
+};
+
+
+#endif //FIREAPP_METRICSREGISTRY_H
@@ -5,6 +5,7 @@
 #include "TFMeaManager.h"
 #include "TSysUtils.h"
 #include "TLog.h"
+#include "MetricsRegistry.h"
 #include <limits>
 #include <algorithm>
 #include <cmath>
@@ -194,6 +195,10 @@ namespace TF {
         if (!frame || !frame->data)
             return;
 
+        // Exported as a rate, i.e. the thermal FPS
+        static auto& frames = MetricsRegistry::instance().counter("thermal.frames");
+        frames.add();
+
         const int w = static_cast<int>(frame->width);
         const int h = static_cast<int>(frame->height);
         const int pixelCount = w * h;
@@ -11,12 +11,23 @@
 #include "DataPubZmqManager.h"
 #include <chrono>
 #include <cstring>
+#include <optional>
 #include "TConfig.h"
 #include "TLog.h"
+#include "MetricsRegistry.h"
 
 
 namespace TF {
 
+    namespace {
+        constexpr std::size_t kMaxLiveQueueSize = 4;
+
+        int64_t currentTimestampMs() {
+            auto now = std::chrono::system_clock::now();
+            return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+        }
+    }
+
     DataPubZmqManager::DataPubZmqManager() = default;
 
     DataPubZmqManager::~DataPubZmqManager() {
@@ -30,6 +41,9 @@ namespace TF {
 
         mPubPort = GET_INT_CONFIG("PubZmq", "PubPort");
         mPubTopic = GET_STR_CONFIG("PubZmq", "PubTopic");
+        mLiveEnabled.store(GET_BOOL_CONFIG("PubZmq", "LiveEnabled"));
+        mLiveTopic = GET_STR_CONFIG("PubZmq", "LiveTopic");
+        mMetricsTopic = GET_STR_CONFIG("PubZmq", "MetricsTopic");
 
         try {
             mContext = std::make_unique<zmq::context_t>(1);
@@ -98,52 +112,105 @@ namespace TF {
         result.maxTemp    = inner_result.maxTemp;
         result.minTemp    = inner_result.minTemp;
 
-        auto now = std::chrono::system_clock::now();
-        result.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now.time_since_epoch()).count();
+        result.timestampMs = currentTimestampMs();
 
         publishResult(result);
     }
 
+    void DataPubZmqManager::publishLive(const FlameLiveResult &result) {
+        if (!mRunning.load() || !mLiveEnabled.load()) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mLiveQueue.size() >= kMaxLiveQueueSize) {
+                static auto &dropped = MetricsRegistry::instance().counter("zmq.live.dropped");
+                dropped.add();
+                mLiveQueue.pop_front();
+            }
+            mLiveQueue.push_back(result);
+            if (mLiveQueue.back().timestampMs == 0) {
+                mLiveQueue.back().timestampMs = currentTimestampMs();
+            }
+        }
+        mCond.notify_one();
+    }
+
+    void DataPubZmqManager::publishMetrics(const std::string &json) {
+        if (!mRunning.load()) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mMetricsQueue.clear();
+            mMetricsQueue.push_back(json);
+        }
+        mCond.notify_one();
+    }
+
     void DataPubZmqManager::safeStrCopy(char *dst, std::size_t dstSize, const std::string &src) {
         std::size_t len = std::min(src.size(), dstSize - 1);
         std::memcpy(dst, src.data(), len);
         dst[len] = '\0';
     }
 
+    void DataPubZmqManager::sendFrame(const std::string &topic, const void *data, std::size_t size) {
+        try {
+            // 发送topic帧
+            zmq::message_t topicMsg(topic.c_str(), topic.size());
+            mSocket->send(topicMsg, zmq::send_flags::sndmore);
+
+            // 发送数据帧
+            zmq::message_t dataMsg(data, size);
+            mSocket->send(dataMsg, zmq::send_flags::none);
+
+            static auto &sent = MetricsRegistry::instance().counter("zmq.sent");
+            sent.add();
+        } catch (const zmq::error_t &e) {
+            static auto &errors = MetricsRegistry::instance().counter("zmq.send_errors");
+            errors.add();
+            LOG_F(ERROR, "DataPubZmqManager publish %s failed: %s", topic.c_str(), e.what());
+        }
+    }
+
     void DataPubZmqManager::publishThreadFunc() {
         LOG_F(INFO, "DataPubZmqManager publish thread started");
 
         while (mRunning.load()) {
-            FlameDetectResult result{};
+            std::deque<FlameLiveResult> liveResults;
+            std::deque<std::string> metrics;
+            std::optional<FlameDetectResult> result;
             {
                 std::unique_lock<std::mutex> lock(mMutex);
                 mCond.wait(lock, [this] {
-                    return !mQueue.empty() || !mRunning.load();
+                    return !mQueue.empty() || !mLiveQueue.empty() || !mMetricsQueue.empty() || !mRunning.load();
                 });
 
                 if (!mRunning.load() && mQueue.empty()) {
                     break;
                 }
 
-                if (mQueue.empty()) {
-                    continue;
+                // 实时通道优先发送，避免被落盘结果阻塞
+                liveResults.swap(mLiveQueue);
+                metrics.swap(mMetricsQueue);
+                if (!mQueue.empty()) {
+                    result = mQueue.front();
+                    mQueue.pop();
                 }
+            }
 
-                result = mQueue.front();
-                mQueue.pop();
+            for (const auto &live : liveResults) {
+                sendFrame(mLiveTopic, &live, sizeof(FlameLiveResult));
             }
 
-            try {
-                // 发送topic帧
-                zmq::message_t topicMsg(mPubTopic.c_str(), mPubTopic.size());
-                mSocket->send(topicMsg, zmq::send_flags::sndmore);
+            if (result.has_value()) {
+                sendFrame(mPubTopic, &result.value(), sizeof(FlameDetectResult));
+            }
 
-                // 发送数据帧
-                zmq::message_t dataMsg(&result, sizeof(FlameDetectResult));
-                mSocket->send(dataMsg, zmq::send_flags::none);
-            } catch (const zmq::error_t &e) {
-                LOG_F(ERROR, "DataPubZmqManager publish failed: %s", e.what());
+            for (const auto &json : metrics) {
+                sendFrame(mMetricsTopic, json.data(), json.size());
             }
         }
 
@@ -14,6 +14,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <queue>
@@ -43,6 +44,23 @@ namespace TF {
     };
     #pragma pack(pop)
 
+    // 逐帧实时测量结果，由检测线程直接发布，不等待图像落盘
+    #pragma pack(push, 1)
+    struct FlameLiveResult {
+        int64_t frameId{0};                           // 检测序号(-1: 两次检测之间由跟踪预测的帧)
+        int32_t detectNum{0};                         // 检测目标数
+        float fireHeight{0.0f};                       // 火焰高度(m)
+        float fireArea{0.0f};                         // 火焰面积(m^2)
+        float hrr{0.0f};                              // 热释放速率
+        float distance{0.0f};                         // 测距(m)
+        float tiltAngle{0.0f};                        // 倾角(°)
+        float maxTemp{0.0f};                         // 最高温度(°)
+        float minTemp{0.0f};                         // 最低温度(°)
+        int64_t timestampMs{0};                       // 时间戳(毫秒)
+        int32_t trackId{-1};                          // 最大火焰的跟踪ID(-1: 未启用跟踪)
+    };
+    #pragma pack(pop)
+
     struct InnerFlameDetectResult
     {
         std::string detImagePath;
@@ -67,12 +85,22 @@ namespace TF {
 
         void publishResult(const InnerFlameDetectResult &inner_result);
 
+        // 实时通道：队列满时丢弃最旧数据，保证订阅端拿到的是最新帧
+        void publishLive(const FlameLiveResult &result);
+
+        [[nodiscard]] bool isLiveEnabled() const { return mLiveEnabled.load(); }
+
+        // 运行指标通道：JSON文本，只保留最新的一份
+        void publishMetrics(const std::string &json);
+
     private:
         friend class TBase::TSingleton<DataPubZmqManager>;
         DataPubZmqManager();
 
         void publishThreadFunc();
 
+        void sendFrame(const std::string &topic, const void *data, std::size_t size);
+
         static void safeStrCopy(char *dst, std::size_t dstSize, const std::string &src);
 
     private:
@@ -82,10 +110,17 @@ namespace TF {
         int mPubPort {25555};
         std::string mPubTopic {"FlameResult"};
 
+        std::atomic<bool> mLiveEnabled {true};
+        std::string mLiveTopic {"FlameLive"};
+
+        std::string mMetricsTopic {"FlameMetrics"};
+
         std::thread              mPubThread;
         std::mutex               mMutex;
         std::condition_variable  mCond;
         std::queue<FlameDetectResult> mQueue;
+        std::deque<FlameLiveResult> mLiveQueue;
+        std::deque<std::string>  mMetricsQueue;
         std::atomic<bool>        mRunning{false};
     };
 
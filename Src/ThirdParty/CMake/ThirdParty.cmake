@@ -38,8 +38,10 @@ set(T_LIBUVC_LIB_PATH ${THIRD_PARTY_PATH}/Libuvc)
 include(${T_LIBUVC_LIB_PATH}/CMake/Libuvc.cmake)
 
 # TrtYolo
-set(TRT_YOLO_LIB_PATH ${THIRD_PARTY_PATH}/TrtYolo)
-include(${TRT_YOLO_LIB_PATH}/CMake/TrtYolo.cmake)
+if (FIREAPP_WITH_TRT)
+    set(TRT_YOLO_LIB_PATH ${THIRD_PARTY_PATH}/TrtYolo)
+    include(${TRT_YOLO_LIB_PATH}/CMake/TrtYolo.cmake)
+endif ()
 
 # Sqlite
 set(SQLITE_LIB_PATH ${THIRD_PARTY_PATH}/Sqlite)
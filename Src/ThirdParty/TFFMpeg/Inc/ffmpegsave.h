@@ -129,6 +129,9 @@ private:
 
     bool initAudioStream();
 
+    //队列中待写入的数据数量
+    int pendingCount();
+
 private slots:
 
     //初始化
@@ -3,6 +3,7 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QWaitCondition>
 
 class FFmpegThread;
 
@@ -29,6 +30,12 @@ private:
     volatile bool stopped;
     //数据锁
     QMutex mutex;
+    //等待条件(添加数据包/继续播放/清空/停止时唤醒)
+    QWaitCondition condition;
+    //正在等待数据包
+    bool idle;
+    //清空次数(等待期间被清空则丢弃取出的数据包)
+    int clearIndex;
 
     //数据流类型
     StreamType streamType;
@@ -47,6 +54,11 @@ private:
     qint64 offsetTime;
     //解码开始时间
     qint64 startTime;
+    //裸流下一帧的显示时间
+    qint64 frameTime;
+
+    //等待到指定时间或被唤醒(返回false表示已停止或者已清空)
+    bool waitUntil(qint64 time, int index);
 
 public:
     //停止线程
@@ -58,6 +70,9 @@ public:
     //复位时钟
     void reset();
 
+    //唤醒线程(继续播放时调用)
+    void wake();
+
     //添加数据包
     void append(AVPacket *packet);
 
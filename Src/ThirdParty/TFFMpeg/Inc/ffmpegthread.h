@@ -78,6 +78,10 @@ private:
     AVFrame *imageFrame;
     //视频帧数据(转rgb)
     quint8 *imageData;
+    //视频帧对象(检测用缩放rgb)
+    AVFrame *detectFrame;
+    //视频帧数据(检测用缩放rgb)
+    quint8 *detectData;
 
     //音频帧对象
     AVFrame *audioFrame;
@@ -90,10 +94,19 @@ private:
     //音频转换通道数
     int pcmChannels;
 
+    //占用的解码线程数(关闭时归还给全局预算)
+    int decodeThreadCount;
+
+    //当前帧读取数据包和解码完成的时间(链路追踪用)
+    qint64 traceReadTime;
+    qint64 traceDecodeTime;
+
     //视频图像转换上下文(转yuv420)
     SwsContext *yuvSwsCtx;
     //视频图像转换上下文(转rgb)
     SwsContext *imageSwsCtx;
+    //视频图像转换上下文(直接从yuv缩放到检测尺寸的rgb)
+    SwsContext *detectSwsCtx;
     //音频数据转换上下文(转pcm)
     SwrContext *pcmSwrCtx;
 
@@ -151,6 +164,18 @@ private:
     bool lockData;
     QMutex mutexFrame;
 
+    //事件录像锁(视音频同步线程和解码线程都会访问)
+    QMutex eventMutex;
+    //事件前缓存的数据包及收到的时间(始终从关键帧开始)
+    QList<AVPacket *> eventPackets;
+    QList<qint64> eventTimes;
+    //事件录像保存类(不编码直接封装)
+    FFmpegSave *eventFile;
+    //事件录像结束时间(0=没有在录像/再次触发则顺延)
+    qint64 eventEndTime;
+    //触发线程只置位的事件录像请求(由解码线程打开或者顺延)
+    QAtomicInt eventRequest;
+
 private:
     //读取并清空(视频流暂停期间)
     void readAndClear();
@@ -189,11 +214,27 @@ private:
     //初始化保存类的属性
     void initSaveFile();
 
+    void initSaveFile(FFmpegSave *file, const SaveVideoType &videoType);
+
     //写入视音频数据到文件
     void writeFile(AVPacket *packet, bool video);
 
     void writeFile(AVFrame *frame, bool video);
 
+    //缓存数据包并写入事件录像
+    void writeEvent(AVPacket *packet, int index);
+
+    void writeEvent2(AVPacket *packet, int index);
+
+    //解码线程处理事件录像请求
+    void checkEvent();
+
+    //打开事件录像并先写入缓存的数据包
+    void openEvent();
+
+    //停止事件录像并清空缓存
+    void stopEvent();
+
 private slots:
 
     //初始化通信
@@ -360,6 +401,9 @@ public slots:
     //停止录制
     void recordStop();
 
+    //触发事件录像
+    void eventRecord();
+
     //设置标签信息集合
     void setOsdInfo(const QList<OsdInfo> &listOsd);
 
@@ -37,6 +37,10 @@ public:
     //转换图片
     static QImage frameToImage(SwsContext *swsCtx, AVFrame *srcFrame, AVFrame *dstFrame, quint8 *data);
 
+    //转换并缩放图片(按需创建转换上下文和缓存,尺寸或格式变化时自动重建)
+    static QImage frameToImage(SwsContext **swsCtx, AVFrame *srcFrame, AVFrame *dstFrame, quint8 **data,
+                               int width, int height, int flags);
+
     //初始化视频解码器
     static void initVideoCodec(AVCodecx **videoCodec, AVCodecID codecId, QString &videoCodecName, QString &hardware);
 
@@ -44,6 +48,15 @@ public:
     static bool
     initHardware(FFmpegThread *thread, AVCodecx *videoCodec, AVCodecContext *videoCodecCtx, const QString &hardware);
 
+    //设置全部解码器共用的线程预算(budget=0表示cpu核心数/streams为预计同时解码的路数)
+    static void setDecodeBudget(int budget, int streams);
+
+    //按预算设置解码线程数和线程类型(返回占用的线程数/关闭时需要归还)
+    static int initDecodeThread(FFmpegThread *thread, AVCodecContext *videoCodecCtx);
+
+    //归还占用的解码线程
+    static void freeDecodeThread(int count);
+
     //初始化解码视频相关数据
     static bool initVideoData(FFmpegThread *thread, AVFrame *yuvFrame, AVFrame *imageFrame, SwsContext **yuvSwsCtx,
                               SwsContext **imageSwsCtx, quint8 **imageData,
@@ -85,9 +85,8 @@ void FFmpegHelper::initOption(AVDictionary **options, int caching, const QString
     av_dict_set(options, "stimeout", "3000000", 0);
     //设置最大时延(单位微秒/1000000表示1秒)
     av_dict_set(options, "max_delay", "1000000", 0);
-    //自动开启线程数
+    //解码线程数不在这里设置/打开视频解码器时按全局解码线程预算分配(FFmpegThreadHelper::initDecodeThread)
     //av_dict_set(options, "threads", "auto", 0);
-    av_dict_set(options, "threads", "12", 0);
 
     //通信协议采用tcp还是udp(udp优点是无连接/在网线拔掉以后十几秒钟重新插上还能继续接收/缺点是网络不好的情况下会丢包花屏)
     if (transport != "auto") {
@@ -466,6 +466,10 @@ bool FFmpegSave::save() {
     return (packets.count() > 0 || frames.count() > 0);
 }
 
+int FFmpegSave::pendingCount() {
+    return (packets.count() + frames.count());
+}
+
 void FFmpegSave::close() {
     //将最后的缓冲数据写入到文件
     if (audioEncode) {
@@ -813,6 +817,7 @@ void FFmpegSave::writePacket(AVPacket *packet, int index) {
     //this->writePacket2(packet, packet->stream_index == videoIndexIn);
     mutex.lock();
     packets << FFmpegHelper::creatPacket(packet);
+    dataReady.wakeOne();
     mutex.unlock();
 }
 
@@ -864,5 +869,6 @@ void FFmpegSave::writeFrame(AVFrame *frame, int index) {
         }
     }
 
+    dataReady.wakeOne();
     mutex.unlock();
 }
@@ -1,9 +1,13 @@
 ﻿#include "ffmpegsync.h"
 #include "ffmpeghelper.h"
 #include "ffmpegthread.h"
+#include <QDeadlineTimer>
 
 FFmpegSync::FFmpegSync(StreamType streamType, QObject *parent) : QThread(parent) {
     this->stopped = false;
+    this->idle = false;
+    this->clearIndex = 0;
+    this->frameTime = 0;
     this->streamType = streamType;
     this->thread = (FFmpegThread *) parent;
 }
@@ -19,35 +23,59 @@ void FFmpegSync::run() {
 
     this->reset();
     while (!stopped) {
-        //暂停状态或者切换进度中或者队列中没有帧则不处理
-        if (thread->isPause || thread->changePosition || packets.count() == 0) {
-            msleep(1);
+        //暂停状态或者切换进度中或者队列中没有帧则等待唤醒
+        mutex.lock();
+        bool pause = (thread->isPause || thread->changePosition);
+        if (stopped || pause || packets.count() == 0) {
+            if (!stopped) {
+                //暂停期间的唤醒来自继续播放/这里限定最长等待时间防止漏掉暂停标志位的变化
+                idle = !pause;
+                if (pause) {
+                    condition.wait(&mutex, 100);
+                } else {
+                    condition.wait(&mutex);
+                }
+                idle = false;
+            }
+            mutex.unlock();
             continue;
         }
 
-        mutex.lock();
-        AVPacket *packet = packets.first();
+        //取出数据包后清空也不会释放它
+        AVPacket *packet = packets.takeFirst();
+        int index = clearIndex;
         mutex.unlock();
 
-        //h264的裸流文件同步有问题因为获取不到pts和dts(暂时用最蠢的延时办法解决)
+        bool show = true;
         if (thread->formatName == "h264" || thread->formatName == "hevc") {
-            int sleepTime = (1000 / thread->frameRate) - 5;
-            sleepTime = (double) sleepTime / thread->speed;
-            msleep(sleepTime);
+            //h264的裸流文件获取不到pts和dts/按帧率推算每帧的显示时间(解码耗时不会累积)
+            qint64 interval = (1000000.0 / qMax(1.0, (double) thread->frameRate)) / thread->speed;
+            qint64 now = av_gettime();
+            if (frameTime <= 0 || now - frameTime > interval * 5) {
+                frameTime = now;
+            }
+
+            while (show && av_gettime() < frameTime) {
+                show = this->waitUntil(frameTime, index);
+            }
+            frameTime += interval;
         } else {
-            //计算当前帧显示时间(外部时钟同步)
+            //计算当前帧显示时间(外部时钟同步)/没到时间则一直等到显示时间
             ptsTime = FFmpegHelper::getPtsTime(thread->formatCtx, packet);
-            if (!this->checkPtsTime()) {
-                msleep(1);
-                continue;
+            while (show && !this->checkPtsTime()) {
+                int offset = (streamType == StreamType_Audio ? 1000 : 5000);
+                qint64 remain = (ptsTime - offset - offsetTime) / thread->speed;
+                show = this->waitUntil(av_gettime() + remain, index);
             }
 
             //显示当前的播放进度
-            this->checkShowTime();
+            if (show) {
+                this->checkShowTime();
+            }
         }
 
         //如果解码线程停止了则不用处理
-        if (!thread->stopped) {
+        if (show && !thread->stopped) {
             if (streamType == StreamType_Audio) {
                 thread->decodeAudio1(packet);
             } else if (streamType == StreamType_Video) {
@@ -55,11 +83,8 @@ void FFmpegSync::run() {
             }
         }
 
-        //释放资源并移除
-        mutex.lock();
+        //释放资源
         FFmpegHelper::freePacket(packet);
-        packets.removeFirst();
-        mutex.unlock();
     }
 
     this->reset();
@@ -67,9 +92,24 @@ void FFmpegSync::run() {
     stopped = false;
 }
 
+bool FFmpegSync::waitUntil(qint64 time, int index) {
+    QMutexLocker locker(&mutex);
+    qint64 remain = time - av_gettime();
+    if (!stopped && index == clearIndex && remain > 0) {
+        QDeadlineTimer deadline(Qt::PreciseTimer);
+        deadline.setPreciseRemainingTime(0, remain * 1000, Qt::PreciseTimer);
+        condition.wait(&mutex, deadline);
+    }
+
+    return (!stopped && index == clearIndex);
+}
+
 void FFmpegSync::stop() {
     if (this->isRunning()) {
+        mutex.lock();
         stopped = true;
+        condition.wakeAll();
+        mutex.unlock();
         this->wait();
     }
 }
@@ -81,6 +121,8 @@ void FFmpegSync::clear() {
             FFmpegHelper::freePacket(packet);
         }
     packets.clear();
+    clearIndex++;
+    condition.wakeAll();
     mutex.unlock();
 }
 
@@ -90,15 +132,27 @@ void FFmpegSync::reset() {
     bufferTime = 0;
     offsetTime = -1;
     startTime = av_gettime();
+    frameTime = 0;
+}
+
+void FFmpegSync::wake() {
+    mutex.lock();
+    condition.wakeAll();
+    mutex.unlock();
 }
 
 void FFmpegSync::append(AVPacket *packet) {
     mutex.lock();
     packets << packet;
+    //只有在等待数据包的时候才需要唤醒
+    if (idle) {
+        condition.wakeOne();
+    }
     mutex.unlock();
 }
 
 int FFmpegSync::getPacketCount() {
+    QMutexLocker locker(&mutex);
     return this->packets.count();
 }
 
@@ -41,12 +41,17 @@ FFmpegThread::FFmpegThread(QObject *parent) : VideoThread(parent) {
     yuvFrame = NULL;
     imageFrame = NULL;
     imageData = NULL;
+    detectFrame = NULL;
+    detectData = NULL;
 
     audioFrame = NULL;
     pcmFrame = NULL;
 
+    decodeThreadCount = 0;
+
     yuvSwsCtx = NULL;
     imageSwsCtx = NULL;
+    detectSwsCtx = NULL;
     pcmSwrCtx = NULL;
 
     options = NULL;
@@ -93,6 +98,14 @@ FFmpegThread::FFmpegThread(QObject *parent) : VideoThread(parent) {
     isCrop = false;
     cropTime = QDateTime::currentDateTime().addDays(-1);
 
+    //事件录像保存类(本线程释放的时候也会自动释放)
+    eventFile = new FFmpegSave(this);
+    eventEndTime = 0;
+    eventRequest.storeRelaxed(0);
+
+    traceReadTime = 0;
+    traceDecodeTime = 0;
+
     //线程启动后初始化websocket通信
     avio = NULL;
     connect(this, SIGNAL(started()), this, SLOT(initAvio()));
@@ -126,6 +139,9 @@ void FFmpegThread::run() {
             continue;
         }
 
+        //事件录像的打开和顺延都在解码线程(要用到解码上下文)
+        this->checkEvent();
+
         //读取一帧(通过标志位控制回调那边做超时判断)
         tryRead = true;
         int result = av_read_frame(formatCtx, packet);
@@ -141,6 +157,12 @@ void FFmpegThread::run() {
 
             //判断当前包是视频还是音频
             int index = packet->stream_index;
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+            //读取时间随数据包进入解码器并复制到解码后的帧
+            if (isTrace && index == videoIndex) {
+                packet->opaque = (void *) (intptr_t) traceTime();
+            }
+#endif
             //qint64 time = FFmpegHelper::getPtsTime(formatCtx, packet) / 1000;
             //QString msg = QString("time: %1 pts: %2 dts: %3 pos: %4").arg(time).arg(packet->pts).arg(packet->dts).arg(position);
             if (index == videoIndex) {
@@ -343,6 +365,11 @@ void FFmpegThread::checkAndShowVideo(bool needScale, AVFrame *frame) {
 
         //如果有旋转角度先要旋转
         VideoHelper::rotateImage(rotate, image);
+        //时间戳先于图片发出(同一个接收者按发出顺序收到)
+        if (isTrace && isDetect && !isSnap) {
+            emit receiveTrace(traceReadTime, traceDecodeTime, traceTime());
+        }
+
         if (isSnap) {
             isSnap = false;
             //裁剪期间应用了裁剪滤镜对应的截图有问题
@@ -360,6 +387,21 @@ void FFmpegThread::checkAndShowVideo(bool needScale, AVFrame *frame) {
             if (rotate > 0) {
                 videoFilter.init = false;
             }
+        } else if (isDetect && detectFrame && detectSize.isValid()) {
+            //另外直接从yuv缩放出检测尺寸的图片,省掉检测时对全尺寸图片的缩放
+            //检测尺寸只限定长边,按原图比例缩放避免火焰变形,检测框映射回原图时两个方向的系数也一致
+            int flags = FFmpegThreadHelper::getDecodeFlags(decodeType);
+            QSize scaleSize = QSize(framex->width, framex->height).scaled(detectSize, Qt::KeepAspectRatio);
+            QImage detectImage = FFmpegThreadHelper::frameToImage(&detectSwsCtx, framex, detectFrame, &detectData,
+                                                                  scaleSize.width(), scaleSize.height(), flags);
+            if (detectImage.isNull()) {
+                emit receiveImage(image, timer.elapsed());
+                return;
+            }
+
+            VideoHelper::rotateImage(rotate, detectImage);
+            emit receiveDetectImage(image, detectImage, timer.elapsed());
+            return;
         } else {
             emit receiveImage(image, timer.elapsed());
             return;
@@ -459,6 +501,13 @@ void FFmpegThread::decodeVideo2(AVPacket *packet) {
     }
 #endif
 
+    //记下这一帧的读取时间和解码完成时间
+    if (isTrace) {
+        AVFrame *decoded = (hardware == "none" ? videoFrame : tempFrame);
+        traceReadTime = (qint64) (intptr_t) decoded->opaque;
+        traceDecodeTime = traceTime();
+    }
+
     //如果需要重新初始化则先初始化滤镜(带旋转角度的抓图也需要重新处理)
     if (!videoFilter.init || (isSnap && rotate > 0)) {
         this->initFilter();
@@ -583,6 +632,9 @@ void FFmpegThread::writeFile(AVPacket *packet, bool video) {
         emit writePacket(packet, video ? videoIndex : audioIndex);
     }
 
+    //事件录像缓存的是原始数据包
+    this->writeEvent(packet, video ? videoIndex : audioIndex);
+
     if (!saveFile->getIsOk()) {
         return;
     }
@@ -633,6 +685,141 @@ void FFmpegThread::writeFile(AVFrame *frame, bool video) {
     }
 }
 
+void FFmpegThread::writeEvent(AVPacket *packet, int index) {
+    //没有启用事件录像不用处理
+    if (eventPreTime <= 0) {
+        return;
+    }
+
+    qint64 time = QDateTime::currentMSecsSinceEpoch();
+    bool key = (index == videoIndex && FFmpegHelper::checkPacketKey(packet));
+
+    eventMutex.lock();
+    //缓存必须从关键帧开始(纯音频则从任意包开始)
+    if (key || videoIndex < 0 || !eventPackets.isEmpty()) {
+        AVPacket *pkt = FFmpegHelper::creatPacket(packet);
+        pkt->stream_index = index;
+        eventPackets << pkt;
+        eventTimes << time;
+    }
+
+    //收到关键帧时丢弃时长以外的数据/保留最后一个超出时长的关键帧保证开头能解码
+    if (key || videoIndex < 0) {
+        qint64 minTime = time - eventPreTime * 1000;
+        int start = 0;
+        int count = eventPackets.count();
+        for (int i = 1; i < count; ++i) {
+            if (eventTimes.at(i) > minTime) {
+                break;
+            }
+            AVPacket *pkt = eventPackets.at(i);
+            if (videoIndex < 0 || (pkt->stream_index == videoIndex && FFmpegHelper::checkPacketKey(pkt))) {
+                start = i;
+            }
+        }
+
+        for (int i = 0; i < start; ++i) {
+            AVPacket *pkt = eventPackets.takeFirst();
+            FFmpegHelper::freePacket(pkt);
+            eventTimes.removeFirst();
+        }
+    }
+
+    //录像中直接写入/过了结束时间交给保存线程写完后自己关闭(不阻塞解码)
+    if (eventEndTime > 0) {
+        if (time > eventEndTime) {
+            eventEndTime = 0;
+            eventFile->finish();
+        } else {
+            this->writeEvent2(packet, index);
+        }
+    }
+    eventMutex.unlock();
+}
+
+void FFmpegThread::checkEvent() {
+    if (eventRequest.loadAcquire() == 0) {
+        return;
+    }
+
+    eventMutex.lock();
+    if (eventEndTime > 0) {
+        //录像中再次触发则顺延结束时间
+        eventRequest.storeRelease(0);
+        eventEndTime = QDateTime::currentMSecsSinceEpoch() + qMax(eventPostTime, 0) * 1000;
+    } else if (!eventFile->isRunning()) {
+        eventRequest.storeRelease(0);
+        this->openEvent();
+    }
+    //上一个文件还在收尾则保留请求等收尾完成后再打开
+    eventMutex.unlock();
+}
+
+void FFmpegThread::writeEvent2(AVPacket *packet, int index) {
+    //音频需要编码的时候没有对应的数据帧只能不存音频
+    if (index == videoIndex) {
+        eventFile->writePacket(packet, index);
+    } else if (!eventFile->getAudioEncode()) {
+        eventFile->writePacket(packet, index);
+    }
+}
+
+void FFmpegThread::openEvent() {
+    //按照时间生成文件名
+    QString path = eventPath.isEmpty() ? "event" : eventPath;
+    QDir dir;
+    if (!dir.exists(path)) {
+        dir.mkpath(path);
+    }
+
+    QString name = QDateTime::currentDateTime().toString("yyyyMMddhhmmss");
+    if (!flag.isEmpty()) {
+        name = QString("%1_%2").arg(flag).arg(name);
+    }
+
+    QString fileName = QString("%1/%2.mp4").arg(path).arg(name);
+    this->initSaveFile(eventFile, SaveVideoType_Mp4);
+    eventFile->open(fileName);
+    if (!eventFile->getIsOk()) {
+        return;
+    }
+
+    //事件录像只做封装不编码
+    if (eventFile->getVideoEncode()) {
+        debug(0, "事件录像", "原因: 视频需要重新编码");
+        eventFile->stop();
+        return;
+    }
+
+    //先把事件前的数据包写入再继续写入实时数据包
+    foreach (AVPacket *pkt, eventPackets) {
+        this->writeEvent2(pkt, pkt->stream_index);
+    }
+
+    eventEndTime = QDateTime::currentMSecsSinceEpoch() + qMax(eventPostTime, 0) * 1000;
+    debug(0, "事件录像", QString("事件前: %1秒 事件后: %2秒 文件: %3").arg(eventPreTime).arg(eventPostTime).arg(fileName));
+}
+
+void FFmpegThread::stopEvent() {
+    eventMutex.lock();
+    eventEndTime = 0;
+    eventRequest.storeRelease(0);
+    foreach (AVPacket *pkt, eventPackets) {
+        FFmpegHelper::freePacket(pkt);
+    }
+    eventPackets.clear();
+    eventTimes.clear();
+    eventMutex.unlock();
+
+    //需要等缓存中的所有数据存储完再停止(输入流对象关闭后就不能用了)
+    if (eventFile->getIsOk() || eventFile->isRunning()) {
+        while (eventFile->isRunning() && eventFile->getPacketCount() > 0) {
+            msleep(10);
+        }
+        eventFile->stop();
+    }
+}
+
 void FFmpegThread::initOption() {
     //增加rtp/sdp支持/貌似网络地址带.sdp结尾的这种可以不用加
     if (mediaType == MediaType_FileLocal && mediaUrl.endsWith(".sdp")) {
@@ -818,6 +1005,15 @@ bool FFmpegThread::initVideo() {
             videoCodecCtx->flags2 |= AV_CODEC_FLAG2_FAST;
         }
 
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+        //数据包的opaque复制到解码后的帧(链路追踪用)
+        videoCodecCtx->flags |= AV_CODEC_FLAG_COPY_OPAQUE;
+#endif
+
+        //解码线程数和线程类型
+        FFmpegThreadHelper::freeDecodeThread(decodeThreadCount);
+        decodeThreadCount = FFmpegThreadHelper::initDecodeThread(this, videoCodecCtx);
+
         //打开视频解码器
         result = avcodec_open2(videoCodecCtx, videoCodec, &options);
         if (result < 0) {
@@ -940,6 +1136,7 @@ void FFmpegThread::initData() {
         tempFrame = av_frame_alloc();
         yuvFrame = av_frame_alloc();
         imageFrame = av_frame_alloc();
+        detectFrame = av_frame_alloc();
 
         //加速转码标志位
         int flags = FFmpegThreadHelper::getDecodeFlags(decodeType);
@@ -1132,6 +1329,7 @@ void FFmpegThread::closeVideo() {
 
     //先停止录制
     this->recordStop();
+    this->stopEvent();
     //搞个标志位判断是否需要调用父类的释放(可以防止重复调用)
     bool needClose = formatCtx;
 
@@ -1140,6 +1338,9 @@ void FFmpegThread::closeVideo() {
         packet = NULL;
     }
 
+    FFmpegThreadHelper::freeDecodeThread(decodeThreadCount);
+    decodeThreadCount = 0;
+
     if (yuvSwsCtx) {
         sws_freeContext(yuvSwsCtx);
         yuvSwsCtx = NULL;
@@ -1150,6 +1351,11 @@ void FFmpegThread::closeVideo() {
         imageSwsCtx = NULL;
     }
 
+    if (detectSwsCtx) {
+        sws_freeContext(detectSwsCtx);
+        detectSwsCtx = NULL;
+    }
+
     if (pcmSwrCtx) {
         swr_free(&pcmSwrCtx);
         pcmSwrCtx = NULL;
@@ -1180,6 +1386,16 @@ void FFmpegThread::closeVideo() {
         imageData = NULL;
     }
 
+    if (detectFrame) {
+        FFmpegHelper::freeFrame(detectFrame);
+        detectFrame = NULL;
+    }
+
+    if (detectData) {
+        av_free(detectData);
+        detectData = NULL;
+    }
+
     if (audioFrame) {
         FFmpegHelper::freeFrame(audioFrame);
         audioFrame = NULL;
@@ -1505,6 +1721,7 @@ void FFmpegThread::setFlag(const QString &flag) {
     AbstractVideoThread::setFlag(flag);
     //设置音频对象名称
     audioPlayer->setObjectName("audioPlayer_" + flag);
+    eventFile->setFlag(flag);
 }
 
 void FFmpegThread::debug(int result, const QString &head, const QString &msg) {
@@ -1529,6 +1746,8 @@ void FFmpegThread::next() {
         //复位同步线程(不复位继续播放后会瞬间快速跳帧)
         audioSync->reset();
         videoSync->reset();
+        audioSync->wake();
+        videoSync->wake();
     }
 }
 
@@ -1539,30 +1758,34 @@ void FFmpegThread::step(bool backward) {
 }
 
 void FFmpegThread::initSaveFile() {
+    this->initSaveFile(saveFile, saveVideoType);
+}
+
+void FFmpegThread::initSaveFile(FFmpegSave *file, const SaveVideoType &videoType) {
     bool mp4ToAnnexB = false;
     bool audioEncode = false;
     bool videoEncode = false;
 
     //有正确的帧率则就用该帧率/否则用设置的帧率
     encodeVideoFps = (frameRate <= 120 ? frameRate : encodeVideoFps);
-    FFmpegThreadHelper::checkVideoEncode(mediaType, mediaUrl, saveVideoType, formatName, getIsFile(), mp4ToAnnexB,
+    FFmpegThreadHelper::checkVideoEncode(mediaType, mediaUrl, videoType, formatName, getIsFile(), mp4ToAnnexB,
                                          videoEncode);
-    saveFile->setEncodePara(mp4ToAnnexB, audioEncode, videoEncode, encodeSpeed, encodeAudio, encodeVideo,
-                            encodeVideoFps, encodeVideoRatio, encodeVideoScale);
-    saveFile->setSavePara(mediaType, saveVideoType, getVideoStream(), getAudioStream());
+    file->setEncodePara(mp4ToAnnexB, audioEncode, videoEncode, encodeSpeed, encodeAudio, encodeVideo,
+                        encodeVideoFps, encodeVideoRatio, encodeVideoScale);
+    file->setSavePara(mediaType, videoType, getVideoStream(), getAudioStream());
 
     //设置加密秘钥字串
     QByteArray cryptoKey = this->property("encryptKey").toByteArray();
-    saveFile->setProperty("encryptKey", cryptoKey);
+    file->setProperty("encryptKey", cryptoKey);
 
     //设置一些弱属性方便其他地方处理
-    saveFile->setProperty("mediaUrl", FFmpegHelper::getUrl(formatCtx));
-    saveFile->setProperty("isFile", getIsFile());
+    file->setProperty("mediaUrl", FFmpegHelper::getUrl(formatCtx));
+    file->setProperty("isFile", getIsFile());
 
     //告诉保存那边这边传过去的真实的音频数据相关参数
-    saveFile->setProperty("resample", (pcmSwrCtx != NULL));
-    saveFile->setProperty("sampleRate", pcmSampleRate);
-    saveFile->setProperty("channelCount", pcmChannels);
+    file->setProperty("resample", (pcmSwrCtx != NULL));
+    file->setProperty("sampleRate", pcmSampleRate);
+    file->setProperty("channelCount", pcmChannels);
 }
 
 void FFmpegThread::recordStart(const QString &fileName) {
@@ -1612,6 +1835,16 @@ void FFmpegThread::recordStop() {
     }
 }
 
+void FFmpegThread::eventRecord() {
+    //没有启用事件录像或者还没打开不处理
+    if (eventPreTime <= 0 || !isOk) {
+        return;
+    }
+
+    //这里在界面线程只置位请求/打开文件和写入缓存都由解码线程处理
+    eventRequest.storeRelease(1);
+}
+
 void FFmpegThread::setOsdInfo(const QList<OsdInfo> &listOsd) {
     if (!FFmpegThreadHelper::checkFilter(false, videoCodecName, hardware, mediaType, mediaUrl)) {
         return;
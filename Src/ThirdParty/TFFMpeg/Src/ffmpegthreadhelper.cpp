@@ -1,6 +1,8 @@
 ﻿#include "ffmpegthreadhelper.h"
 #include "ffmpegthread.h"
 #include "ffmpeghelper.h"
+#include <QMutex>
+#include <QThread>
 
 int FFmpegThreadHelper::getDecodeFlags(DecodeType decodeType) {
     //默认速度优先的解码采用的SWS_FAST_BILINEAR参数(可能会丢失部分图片数据)
@@ -177,6 +179,46 @@ QImage FFmpegThreadHelper::frameToImage(SwsContext *swsCtx, AVFrame *srcFrame, A
     }
 }
 
+QImage FFmpegThreadHelper::frameToImage(SwsContext **swsCtx, AVFrame *srcFrame, AVFrame *dstFrame, quint8 **data,
+                                        int width, int height, int flags) {
+    //源头尺寸格式和目标尺寸都没变的话会复用之前的上下文
+    AVPixelFormat srcFormat = (AVPixelFormat) srcFrame->format;
+    AVPixelFormat imageFormat = AV_PIX_FMT_RGB24;
+    (*swsCtx) = sws_getCachedContext((*swsCtx), srcFrame->width, srcFrame->height, srcFormat, width, height,
+                                     imageFormat, flags, NULL, NULL, NULL);
+    if (!(*swsCtx)) {
+        return QImage();
+    }
+
+    //目标尺寸变化需要重新分配缓存
+    int align = 4;
+    if (!(*data) || dstFrame->width != width || dstFrame->height != height) {
+        av_freep(data);
+        int imageSize = av_image_get_buffer_size(imageFormat, width, height, align);
+        (*data) = (quint8 *) av_malloc(imageSize * sizeof(quint8));
+        if (!(*data)) {
+            return QImage();
+        }
+
+        int result = av_image_fill_arrays(dstFrame->data, dstFrame->linesize, (*data), imageFormat, width, height,
+                                          align);
+        if (result < 0) {
+            av_freep(data);
+            return QImage();
+        }
+        dstFrame->width = width;
+        dstFrame->height = height;
+    }
+
+    int result = sws_scale((*swsCtx), (const quint8 **) srcFrame->data, srcFrame->linesize, 0, srcFrame->height,
+                           dstFrame->data, dstFrame->linesize);
+    if (result < 0) {
+        return QImage();
+    } else {
+        return QImage((*data), width, height, dstFrame->linesize[0], QImage::Format_RGB888);
+    }
+}
+
 void FFmpegThreadHelper::initVideoCodec(AVCodecx **videoCodec, AVCodecID codecId, QString &videoCodecName,
                                         QString &hardware) {
     //获取默认的解码器
@@ -249,6 +291,64 @@ bool FFmpegThreadHelper::initHardware(FFmpegThread *thread, AVCodecx *videoCodec
 #endif
 }
 
+//所有解码线程共用的预算
+static QMutex decodeMutex;
+static int decodeBudget = 0;
+static int decodeStreams = 1;
+static int decodeUsed = 0;
+
+void FFmpegThreadHelper::setDecodeBudget(int budget, int streams) {
+    QMutexLocker locker(&decodeMutex);
+    decodeBudget = budget;
+    decodeStreams = qMax(1, streams);
+}
+
+int FFmpegThreadHelper::initDecodeThread(FFmpegThread *thread, AVCodecContext *videoCodecCtx) {
+    //硬解码由硬件完成一个线程足够/软解码按预算分配(已打开的解码器不会重新分配所以超出预算时只给一个线程)
+    int count = 1;
+    int used = 0;
+    {
+        QMutexLocker locker(&decodeMutex);
+        if (thread->getHardware() == "none") {
+            int budget = (decodeBudget > 0 ? decodeBudget : QThread::idealThreadCount());
+            int wanted = thread->getDecodeThreads();
+            if (wanted <= 0) {
+                wanted = qMax(1, budget / decodeStreams);
+            }
+            count = qMax(1, qMin(wanted, budget - decodeUsed));
+        }
+        decodeUsed += count;
+        used = decodeUsed;
+    }
+
+    //帧线程每多一个线程就多延时一帧/实时流低延时模式只用切片线程
+    QString threadType = thread->getThreadType();
+    if (thread->getLowLatency() && !thread->getIsFile()) {
+        threadType = "slice";
+    }
+
+    int type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    if (threadType == "frame") {
+        type = FF_THREAD_FRAME;
+    } else if (threadType == "slice") {
+        type = FF_THREAD_SLICE;
+    }
+
+    videoCodecCtx->thread_count = count;
+    videoCodecCtx->thread_type = type;
+    thread->debug(0, "解码线程", QString("线程: %1 类型: %2 已用: %3").arg(count).arg(threadType).arg(used));
+    return count;
+}
+
+void FFmpegThreadHelper::freeDecodeThread(int count) {
+    if (count <= 0) {
+        return;
+    }
+
+    QMutexLocker locker(&decodeMutex);
+    decodeUsed = qMax(0, decodeUsed - count);
+}
+
 bool
 FFmpegThreadHelper::initVideoData(FFmpegThread *thread, AVFrame *yuvFrame, AVFrame *imageFrame, SwsContext **yuvSwsCtx,
                                   SwsContext **imageSwsCtx, quint8 **imageData,
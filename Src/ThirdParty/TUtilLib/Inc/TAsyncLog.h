@@ -0,0 +1,341 @@
+/**************************************************************************
+
+           Copyright(C), tao.jing All rights reserved
+
+ **************************************************************************
+   File   : TAsyncLog.h
+   Author : tao.jing
+   Date   : 2026/10/19
+   Brief  : Non-blocking LOG_F backend on top of loguru
+**************************************************************************/
+
+#ifndef TUTILLIB_TASYNCLOG_H
+#define TUTILLIB_TASYNCLOG_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "TSingleton.h"
+#include "loguru.hpp"
+
+
+namespace TBase {
+
+    /*
+     * Every logging thread owns a single-producer ring of fixed-size records. LOG_F
+     * only formats the message into the next free slot; the preamble, the loguru
+     * sinks and the file I/O run on the writer thread. A full ring drops the message
+     * and counts it, so a stalled disk can never block the caller. Messages from one
+     * call site beyond repeatLimitPerSec per second and thread are suppressed, and the
+     * next one that passes reports how many were skipped.
+     *
+     * Before start() and after stop() LOG_F goes straight to loguru. FATAL is always
+     * synchronous, after the queued messages have been written. While running, a loguru
+     * fatal handler drains the rings too, so a CHECK failure or a crash signal still
+     * writes the messages that led up to it.
+     */
+    class TAsyncLog : public TSingleton<TAsyncLog> {
+    public:
+        struct Params {
+            std::size_t threadQueueSize{128};   // records per thread, rounded up to a power of two
+            int repeatLimitPerSec{20};          // per call site and thread, 0 = no limit
+            int flushIntervalMs{10};            // writer thread poll interval
+        };
+
+        ~TAsyncLog() override {
+            stop();
+        }
+
+        void start(const Params &params) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mRunning.load()) {
+                return;
+            }
+            mParams = params;
+            mCapacity = 1;
+            while (mCapacity < std::max<std::size_t>(params.threadQueueSize, 2)) {
+                mCapacity <<= 1;
+            }
+            mRunning.store(true, std::memory_order_release);
+            mWriter = std::thread(&TAsyncLog::writerLoop, this);
+
+            mPrevFatalHandler = loguru::get_fatal_handler();
+            loguru::set_fatal_handler(&TAsyncLog::onFatal);
+        }
+
+        void stop() {
+            if (!mRunning.exchange(false)) {
+                return;
+            }
+            if (mWriter.joinable()) {
+                mWriter.join();
+            }
+            loguru::set_fatal_handler(mPrevFatalHandler);
+        }
+
+        [[nodiscard]] bool isRunning() const {
+            return mRunning.load(std::memory_order_acquire);
+        }
+
+        // Waits until the messages queued so far are written, at most timeoutMs
+        void flush(int timeoutMs = 500) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+            while (isRunning() && hasPending() && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        void log(loguru::Verbosity verbosity, const char *file, unsigned line, const char *format, ...)
+        LOGURU_PRINTF_LIKE(5, 6) {
+            va_list args;
+            va_start(args, format);
+            if (!isRunning() || verbosity <= loguru::Verbosity_FATAL) {
+                if (verbosity <= loguru::Verbosity_FATAL) {
+                    flush();
+                }
+                loguru::vlog(verbosity, file, line, format, args);
+                va_end(args);
+                return;
+            }
+
+            Buffer &buffer = localBuffer();
+            const auto now = std::chrono::system_clock::now();
+            int suppressed = 0;
+            if (!buffer.allow(file, line, now, mParams.repeatLimitPerSec, suppressed)) {
+                va_end(args);
+                return;
+            }
+
+            const std::size_t head = buffer.head.load(std::memory_order_relaxed);
+            if (head - buffer.tail.load(std::memory_order_acquire) >= buffer.records.size()) {
+                buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+                va_end(args);
+                return;
+            }
+
+            Record &record = buffer.records[head & (buffer.records.size() - 1)];
+            record.verbosity = verbosity;
+            record.file = file;
+            record.line = line;
+            record.time = now;
+            int len = std::vsnprintf(record.text, sizeof(record.text), format, args);
+            va_end(args);
+            len = std::clamp<int>(len, 0, static_cast<int>(sizeof(record.text)) - 1);
+            if (suppressed > 0) {
+                std::snprintf(record.text + len, sizeof(record.text) - len, " (%d similar suppressed)", suppressed);
+            }
+            buffer.head.store(head + 1, std::memory_order_release);
+        }
+
+    private:
+        friend class TSingleton<TAsyncLog>;
+
+        TAsyncLog() = default;
+
+        // Called by loguru before it aborts, from LOG_F(FATAL), CHECK or its signal handler
+        static void onFatal(const loguru::Message &message) {
+            TAsyncLog &self = instance();
+            self.flush();
+            if (self.mPrevFatalHandler) {
+                self.mPrevFatalHandler(message);
+            }
+        }
+
+        static constexpr int SiteSlots = 64;
+
+        struct Record {
+            loguru::Verbosity verbosity{loguru::Verbosity_INFO};
+            const char *file{nullptr};
+            unsigned line{0};
+            std::chrono::system_clock::time_point time;
+            char text[1000]{};
+        };
+
+        struct Site {
+            const char *file{nullptr};
+            unsigned line{0};
+            int64_t second{0};
+            int count{0};
+            int suppressed{0};
+        };
+
+        struct Buffer {
+            explicit Buffer(std::size_t capacity) : records(capacity) {
+                loguru::get_thread_name(threadName, sizeof(threadName), false);
+            }
+
+            // Producer side only
+            bool allow(const char *file, unsigned line, std::chrono::system_clock::time_point now, int limit,
+                       int &suppressed) {
+                if (limit <= 0) {
+                    return true;
+                }
+                const auto key = reinterpret_cast<std::uintptr_t>(file) ^ (static_cast<std::uintptr_t>(line) * 2654435761u);
+                Site &site = sites[key % SiteSlots];
+                const int64_t second = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+                if (site.file != file || site.line != line) {
+                    site = Site{file, line, second, 0, 0};
+                }
+                if (site.second != second) {
+                    site.second = second;
+                    site.count = 0;
+                }
+                if (++site.count > limit) {
+                    ++site.suppressed;
+                    return false;
+                }
+                suppressed = site.suppressed;
+                site.suppressed = 0;
+                return true;
+            }
+
+            std::vector<Record> records;
+            std::atomic<std::size_t> head{0};
+            std::atomic<std::size_t> tail{0};
+            std::atomic<uint64_t> dropped{0};
+            std::atomic<bool> orphaned{false};
+            char threadName[LOGURU_THREADNAME_WIDTH + 1]{};
+            std::array<Site, SiteSlots> sites{};
+        };
+
+        // Marks the buffer once its thread is gone so the writer can release it after draining
+        struct LocalBuffer {
+            std::shared_ptr<Buffer> buffer;
+
+            ~LocalBuffer() {
+                if (buffer) {
+                    buffer->orphaned.store(true, std::memory_order_release);
+                }
+            }
+        };
+
+        Buffer &localBuffer() {
+            thread_local LocalBuffer local;
+            if (!local.buffer) {
+                local.buffer = std::make_shared<Buffer>(mCapacity);
+                std::lock_guard<std::mutex> lock(mMutex);
+                mBuffers.push_back(local.buffer);
+            }
+            return *local.buffer;
+        }
+
+        std::vector<std::shared_ptr<Buffer>> buffers() {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mBuffers;
+        }
+
+        bool hasPending() {
+            for (const auto &buffer : buffers()) {
+                if (buffer->head.load(std::memory_order_acquire) != buffer->tail.load(std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static const char *levelName(loguru::Verbosity verbosity, char *buf, std::size_t size) {
+            switch (verbosity) {
+                case loguru::Verbosity_FATAL:
+                    return "FATL";
+                case loguru::Verbosity_ERROR:
+                    return "ERR";
+                case loguru::Verbosity_WARNING:
+                    return "WARN";
+                case loguru::Verbosity_INFO:
+                    return "INFO";
+                default:
+                    std::snprintf(buf, size, "%d", static_cast<int>(verbosity));
+                    return buf;
+            }
+        }
+
+        // Same layout as the loguru preamble, with the caller's time and thread
+        static void write(const Record &record, const char *threadName) {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                record.time.time_since_epoch()).count();
+            const std::time_t seconds = static_cast<std::time_t>(ms / 1000);
+            std::tm tm{};
+#ifdef _WIN32
+            localtime_s(&tm, &seconds);
+#else
+            localtime_r(&seconds, &tm);
+#endif
+            const char *file = record.file ? record.file : "";
+            for (const char *p = file; *p; ++p) {
+                if (*p == '/' || *p == '\\') {
+                    file = p + 1;
+                }
+            }
+            char level[8];
+            loguru::raw_log(record.verbosity, record.file, record.line,
+                            "%04d-%02d-%02d %02d:%02d:%02d.%03d [%-*s] %*s:%-5u %5s| %s",
+                            tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                            static_cast<int>(ms % 1000), LOGURU_THREADNAME_WIDTH, threadName,
+                            LOGURU_FILENAME_WIDTH, file, record.line,
+                            levelName(record.verbosity, level, sizeof(level)), record.text);
+        }
+
+        bool drain() {
+            bool wrote = false;
+            for (const auto &buffer : buffers()) {
+                std::size_t tail = buffer->tail.load(std::memory_order_relaxed);
+                const std::size_t head = buffer->head.load(std::memory_order_acquire);
+                for (; tail != head; ++tail) {
+                    write(buffer->records[tail & (buffer->records.size() - 1)], buffer->threadName);
+                    buffer->tail.store(tail + 1, std::memory_order_release);
+                    wrote = true;
+                }
+
+                const uint64_t dropped = buffer->dropped.exchange(0, std::memory_order_relaxed);
+                if (dropped > 0) {
+                    loguru::log(loguru::Verbosity_WARNING, __FILE__, __LINE__,
+                                "Log queue of thread %s full, %llu messages dropped", buffer->threadName,
+                                static_cast<unsigned long long>(dropped));
+                }
+            }
+
+            // Release the buffers of finished threads once they are empty
+            std::lock_guard<std::mutex> lock(mMutex);
+            mBuffers.erase(std::remove_if(mBuffers.begin(), mBuffers.end(), [](const auto &buffer) {
+                return buffer->orphaned.load(std::memory_order_acquire) &&
+                       buffer->head.load(std::memory_order_acquire) == buffer->tail.load(std::memory_order_relaxed);
+            }), mBuffers.end());
+            return wrote;
+        }
+
+        void writerLoop() {
+            loguru::set_thread_name("async log");
+            while (isRunning()) {
+                if (!drain()) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(mParams.flushIntervalMs));
+                }
+            }
+            // Messages queued while stopping
+            drain();
+        }
+
+        Params mParams;
+        std::size_t mCapacity{128};
+
+        std::mutex mMutex;
+        std::vector<std::shared_ptr<Buffer>> mBuffers;
+        std::atomic<bool> mRunning{false};
+        std::thread mWriter;
+        loguru::fatal_handler_t mPrevFatalHandler{nullptr};
+    };
+
+}
+
+
+#endif //TUTILLIB_TASYNCLOG_H
@@ -21,6 +21,16 @@
 
 #define LOGURU_EXPORT TAO_UTIL_API
 #include "loguru.hpp"
+#include "TAsyncLog.h"
+
+// LOG_F hands the message to TAsyncLog, which writes it on its own thread once started.
+// Define TLOG_SYNC to log straight through loguru.
+#ifndef TLOG_SYNC
+#undef LOG_F
+#define LOG_F(verbosity_name, ...)                                                                 \
+    ((loguru::Verbosity_ ## verbosity_name) > loguru::current_verbosity_cutoff()) ? (void)0        \
+        : TBase::TAsyncLog::instance().log(loguru::Verbosity_ ## verbosity_name, __FILE__, __LINE__, __VA_ARGS__)
+#endif
 
 
 namespace TBase {
@@ -475,6 +475,9 @@ void VideoHelper::initVideoThread(VideoThread *videoThread, const VideoPara &vid
     videoThread->setHardware(videoPara.hardware);
     videoThread->setTransport(videoPara.transport.toLower());
     videoThread->setCaching(videoPara.caching);
+    videoThread->setDecodeThreads(videoPara.decodeThreads);
+    videoThread->setThreadType(videoPara.threadType.toLower());
+    videoThread->setLowLatency(videoPara.lowLatency);
 
     videoThread->setAudioLevel(videoPara.audioLevel);
     videoThread->setDecodeAudio(videoPara.decodeAudio);
@@ -490,6 +493,8 @@ void VideoHelper::initVideoThread(VideoThread *videoThread, const VideoPara &vid
     videoThread->setOpenSleepTime(videoPara.openSleepTime);
     videoThread->setReadTimeout(videoPara.readTimeout);
     videoThread->setConnectTimeout(videoPara.connectTimeout);
+    videoThread->setEventTime(videoPara.eventPreTime, videoPara.eventPostTime);
+    videoThread->setEventPath(videoPara.eventPath);
 
     videoThread->setEncodeAudio(encodePara.encodeAudio);
     videoThread->setEncodeVideo(encodePara.encodeVideo);
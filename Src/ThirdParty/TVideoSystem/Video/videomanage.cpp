@@ -51,7 +51,6 @@ void VideoManage::run() {
     while (!stopped) {
         this->openVideo();
         this->checkRecord();
-        msleep(1);
     }
 
     stopped = false;
@@ -89,7 +88,7 @@ void VideoManage::openVideo() {
         //异步执行打开
         VideoWidget *videoWidget = videoWidgets.at(openIndex);
         QMetaObject::invokeMethod(videoWidget, "open", Q_ARG(QString, url));
-        msleep(openInterval);
+        this->waitFor(openInterval);
     }
 }
 
@@ -143,9 +142,14 @@ void VideoManage::checkRecord() {
         return;
     }
 
-    //没有开启录像存储则不处理
+    //没有开启录像存储则等到开启(设置存储录像时唤醒/跨天需要更新目录)
     if (!saveVideo) {
-        msleep(1000);
+        //加锁后再判断一次/避免在判断和等待之间设置的唤醒丢失
+        mutex.lock();
+        if (!stopped && !saveVideo) {
+            condition.wait(&mutex, 60 * 1000);
+        }
+        mutex.unlock();
         return;
     }
 
@@ -170,7 +174,21 @@ void VideoManage::checkRecord() {
         this->initPath();
     }
 
-    msleep(1000);
+    //整半点之间没有事情可做/直接等到下一个整半点(跨天也是整点)
+    QTime time = now.time();
+    QDateTime next(now.date(), QTime(time.hour(), time.minute() < 30 ? 30 : 0));
+    if (time.minute() >= 30) {
+        next = next.addSecs(3600);
+    }
+    this->waitFor(qMax(1000, (int) now.msecsTo(next)));
+}
+
+void VideoManage::waitFor(int msecs) {
+    mutex.lock();
+    if (!stopped) {
+        condition.wait(&mutex, msecs);
+    }
+    mutex.unlock();
 }
 
 void VideoManage::setMediaUrls(const QStringList &mediaUrls) {
@@ -197,7 +215,9 @@ void VideoManage::setOpenInterval(int openInterval) {
 }
 
 void VideoManage::setSaveVideo(bool saveVideo) {
+    QMutexLocker locker(&mutex);
     this->saveVideo = saveVideo;
+    condition.wakeAll();
 }
 
 void VideoManage::setPath(const QString &recordPath, const QString &snapPath) {
@@ -214,7 +234,10 @@ void VideoManage::stop() {
 
     //处于运行状态才可以停止
     if (this->isRunning()) {
+        mutex.lock();
         stopped = true;
+        condition.wakeAll();
+        mutex.unlock();
         this->wait();
     }
 }
@@ -21,6 +21,8 @@ private:
     static QScopedPointer<VideoManage> self;
     //数据锁
     QMutex mutex;
+    //等待条件(停止或者设置变化时唤醒)
+    QWaitCondition condition;
     //停止线程标志位
     volatile bool stopped;
 
@@ -73,6 +75,9 @@ private slots:
     //检查录像计划
     void checkRecord();
 
+    //等待指定时间(停止或者设置变化时提前返回)
+    void waitFor(int msecs);
+
 public slots:
 
     //设置媒体地址集合
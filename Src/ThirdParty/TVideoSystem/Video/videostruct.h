@@ -60,6 +60,9 @@ struct VideoPara {
     QString hardware;           //硬件加速名称
     QString transport;          //通信协议(tcp/udp)
     int caching;                //缓存时间(不同内核不同单位/vlc是ms/ffmpeg是mb)
+    int decodeThreads;          //解码线程数(0=按全局解码线程预算自动分配)
+    QString threadType;         //解码线程类型(auto/frame/slice)
+    bool lowLatency;            //低延时(实时流不用帧线程)
 
     bool audioLevel;            //开启音频振幅
     bool decodeAudio;           //解码音频数据
@@ -77,6 +80,10 @@ struct VideoPara {
     int readTimeout;            //采集超时时间(0=不处理/单位毫秒)
     int connectTimeout;         //连接超时时间(0=不处理/单位毫秒)
 
+    int eventPreTime;           //事件前录像时长(0=不启用事件录像/单位秒)
+    int eventPostTime;          //事件后录像时长(单位秒)
+    QString eventPath;          //事件录像保存目录
+
     VideoPara() {
         videoCore = VideoCore_None;
         mediaUrl = "";
@@ -89,6 +96,9 @@ struct VideoPara {
         hardware = "none";
         transport = "auto";
         caching = 0;
+        decodeThreads = 0;
+        threadType = "auto";
+        lowLatency = false;
 
         audioLevel = false;
         decodeAudio = true;
@@ -105,6 +115,10 @@ struct VideoPara {
         openSleepTime = 3000;
         readTimeout = 0;
         connectTimeout = 500;
+
+        eventPreTime = 0;
+        eventPostTime = 10;
+        eventPath = "";
     }
 
     void reset() {
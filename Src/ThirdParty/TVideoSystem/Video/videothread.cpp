@@ -77,6 +77,9 @@ VideoThread::VideoThread(QObject *parent) : AbstractVideoThread(parent) {
     hardware = "none";
     transport = "auto";
     caching = 0;
+    decodeThreads = 0;
+    threadType = "auto";
+    lowLatency = false;
 
     audioLevel = false;
     decodeAudio = true;
@@ -93,6 +96,10 @@ VideoThread::VideoThread(QObject *parent) : AbstractVideoThread(parent) {
     readTimeout = 0;
     connectTimeout = 500;
 
+    eventPreTime = 0;
+    eventPostTime = 10;
+    eventPath = "";
+
     //这里要过滤下只使用了解码线程而没有对应视频控件的时候
     videoWidget = (QWidget *) parent;
     if (videoWidget) {
@@ -451,6 +458,30 @@ void VideoThread::setCaching(int caching) {
     this->caching = caching;
 }
 
+int VideoThread::getDecodeThreads() const {
+    return this->decodeThreads;
+}
+
+void VideoThread::setDecodeThreads(int decodeThreads) {
+    this->decodeThreads = decodeThreads;
+}
+
+QString VideoThread::getThreadType() const {
+    return this->threadType;
+}
+
+void VideoThread::setThreadType(const QString &threadType) {
+    this->threadType = threadType;
+}
+
+bool VideoThread::getLowLatency() const {
+    return this->lowLatency;
+}
+
+void VideoThread::setLowLatency(bool lowLatency) {
+    this->lowLatency = lowLatency;
+}
+
 bool VideoThread::getAudioLevel() const {
     return this->audioLevel;
 }
@@ -553,12 +584,36 @@ void VideoThread::setConnectTimeout(int connectTimeout) {
     this->connectTimeout = connectTimeout;
 }
 
-void VideoThread::startDetect() {
+int VideoThread::getEventPreTime() const {
+    return this->eventPreTime;
+}
+
+int VideoThread::getEventPostTime() const {
+    return this->eventPostTime;
+}
+
+void VideoThread::setEventTime(int eventPreTime, int eventPostTime) {
+    this->eventPreTime = eventPreTime;
+    this->eventPostTime = eventPostTime;
+}
+
+QString VideoThread::getEventPath() const {
+    return this->eventPath;
+}
+
+void VideoThread::setEventPath(const QString &eventPath) {
+    this->eventPath = eventPath;
+}
+
+void VideoThread::startDetect(const QSize &detectSize, bool trace) {
+    this->detectSize = detectSize;
+    isTrace = trace;
     isDetect = true;
 }
 
 void VideoThread::stopDetect() {
     isDetect = false;
+    isTrace = false;
 }
 
 void VideoThread::readMediaInfo() {
@@ -746,3 +801,7 @@ void VideoThread::recordStopFinsh() {
         debug("结束录制", QString("文件: %1").arg(fileName));
     }
 }
+
+void VideoThread::eventRecord() {
+
+}
@@ -78,6 +78,12 @@ protected:
     QString transport;
     //缓存时间(默认500毫秒)
     int caching;
+    //解码线程数(0=自动分配)
+    int decodeThreads;
+    //解码线程类型(auto/frame/slice)
+    QString threadType;
+    //低延时解码
+    bool lowLatency;
 
     //开启音频振幅
     bool audioLevel;
@@ -106,6 +112,12 @@ protected:
     //连接超时时间(0=不处理/单位毫秒)
     int connectTimeout;
 
+    //事件前后录像时长(0=不启用事件录像/单位秒)
+    int eventPreTime;
+    int eventPostTime;
+    //事件录像保存目录
+    QString eventPath;
+
     //解码线程对应的视频控件(可能为空)
     QWidget *videoWidget;
 
@@ -175,6 +187,21 @@ public:
 
     void setCaching(int caching);
 
+    //获取和设置解码线程数
+    int getDecodeThreads() const;
+
+    void setDecodeThreads(int decodeThreads);
+
+    //获取和设置解码线程类型
+    QString getThreadType() const;
+
+    void setThreadType(const QString &threadType);
+
+    //获取和设置低延时解码
+    bool getLowLatency() const;
+
+    void setLowLatency(bool lowLatency);
+
     //获取和设置音频振幅
     bool getAudioLevel() const;
 
@@ -230,8 +257,22 @@ public:
 
     void setConnectTimeout(int connectTimeout);
 
-    // Detection
-    void startDetect();
+    //获取和设置事件前后录像时长
+    int getEventPreTime() const;
+
+    int getEventPostTime() const;
+
+    void setEventTime(int eventPreTime, int eventPostTime);
+
+    //获取和设置事件录像保存目录
+    QString getEventPath() const;
+
+    void setEventPath(const QString &eventPath);
+
+    // Detection, a valid detectSize also asks the decoder for a frame fitted into it with
+    // the aspect ratio kept,
+    // trace emits receiveTrace ahead of every detection frame
+    void startDetect(const QSize &detectSize = QSize(), bool trace = false);
 
     void stopDetect();
 
@@ -312,6 +353,9 @@ public slots:
     //停止录像完成
     virtual void recordStopFinsh();
 
+    //触发事件录像(保存事件前后一段时间的视频/ffmpeg内核专用/可在任意线程调用)
+    virtual void eventRecord();
+
 signals:
 
     //循环播放
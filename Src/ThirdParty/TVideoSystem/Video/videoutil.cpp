@@ -12,6 +12,7 @@
 #ifdef ffmpeg
 
 #include "ffmpeghelper.h"
+#include "ffmpegthreadhelper.h"
 
 #endif
 
@@ -221,6 +222,12 @@ VideoThread *VideoUtil::newVideoThread(QWidget *parent, const VideoCore &videoCo
     return videoThread;
 }
 
+void VideoUtil::setDecodeBudget(int budget, int streams) {
+#ifdef ffmpeg
+    FFmpegThreadHelper::setDecodeBudget(budget, streams);
+#endif
+}
+
 bool VideoUtil::checkSaveFile(const QString &fullName, const QString &fileName, bool isffmpeg) {
     //过滤不符合要求的命名的文件/不区分大小写
     if (!fileName.startsWith("ch", Qt::CaseInsensitive)) {
@@ -21,6 +21,9 @@ public:
     //创建视频采集类
     static VideoThread *newVideoThread(QWidget *parent, const VideoCore &videoCore, const VideoMode &videoMode);
 
+    //设置ffmpeg内核所有解码器共用的线程预算(budget=0表示cpu核心数/streams为预计同时解码的路数)
+    static void setDecodeBudget(int budget, int streams);
+
     //检查保存的文件是否符合要求
     static bool checkSaveFile(const QString &fullName, const QString &fileName, bool isffmpeg);
 
@@ -6,6 +6,7 @@
 #include "urlhelper.h"
 #include "DetectionQueueManager.h"
 #include "DetectorWorkerManager.h"
+#include "DetectManager.h"
 #include "TFMeaManager.h"
 
 
@@ -329,7 +330,10 @@ void VideoWidget::startDetect() {
             Qt::UniqueConnection);
     manager.start();
 
-    videoThread->startDetect();
+    //解码线程直接输出长边为检测尺寸的等比例图片,为0时检测使用全尺寸图片
+    const int detectSize = TF::TFDetectManager::instance().decodeScaleSize();
+    videoThread->startDetect(detectSize > 0 ? QSize(detectSize, detectSize) : QSize(),
+                             TF::LatencyTracer::instance().isEnabled());
 }
 
 void VideoWidget::stopDetect() {
@@ -339,6 +343,8 @@ void VideoWidget::stopDetect() {
 
     detectionEnabled = false;
     detectionFlag.clear();
+    detectOverlay = {};
+    pendingTrace = {};
 
     if (videoThread) {
         videoThread->stopDetect();
@@ -434,14 +440,35 @@ void VideoWidget::receiveImage(const QImage &image, int time) {
     }
 
     if (detectionEnabled && videoThread && videoThread->getIsDetect()) {
-        TF::DetectionQueueManager::instance().enqueue(detectionFlag, image, time);
+        TF::DetectionQueueManager::instance().enqueue(detectionFlag, image, time, pendingTrace);
+        pendingTrace = {};
         return;
     }
 
     AbstractVideoWidget::receiveImage(image, time);
 }
 
-void VideoWidget::receiveDetectedImage(const QString& flag, const QImage& image, double meanValue, int time) {
+void VideoWidget::receiveDetectImage(const QImage &image, const QImage &detectImage, int time) {
+    if (!this->checkReceive(true)) {
+        return;
+    }
+
+    if (detectionEnabled && videoThread && videoThread->getIsDetect()) {
+        TF::DetectionQueueManager::instance().enqueue(detectionFlag, image, detectImage, time, pendingTrace);
+        pendingTrace = {};
+        return;
+    }
+
+    AbstractVideoWidget::receiveImage(image, time);
+}
+
+void VideoWidget::receiveTrace(qint64 readTime, qint64 decodeTime, qint64 imageTime) {
+    //解码线程紧接着发出对应的图片,同一个接收者按顺序收到
+    pendingTrace = TF::LatencyTracer::instance().begin(readTime, decodeTime, imageTime);
+}
+
+void VideoWidget::receiveDetectedImage(const QString& flag, const QImage& image, const TF::DetectOverlay& overlay,
+                                       double meanValue, int time) {
     if (!this->checkReceive(true)) {
         return;
     }
@@ -453,9 +480,64 @@ void VideoWidget::receiveDetectedImage(const QString& flag, const QImage& image,
     //TF::TFMeaManager::instance().receiveNewValue(meanValue);
 
     Q_UNUSED(meanValue);
+    detectOverlay = overlay;
+
+    //检测到目标则触发事件录像(录像中再次触发会顺延结束时间)
+    if (!overlay.empty() && videoThread) {
+        videoThread->eventRecord();
+    }
     AbstractVideoWidget::receiveImage(image, time);
 }
 
+void VideoWidget::drawOverlay(QPainter *painter) {
+    if (!detectionEnabled) {
+        return;
+    }
+
+    if (!detectOverlay.empty() && detectOverlay.frameSize == image.size()) {
+        //检测结果为图片像素坐标,映射到图片显示区域
+        painter->save();
+        painter->translate(imageRect.topLeft());
+        painter->scale(static_cast<qreal>(imageRect.width()) / image.width(),
+                       static_cast<qreal>(imageRect.height()) / image.height());
+        TF::PaintDetectOverlay(*painter, detectOverlay);
+        painter->restore();
+    }
+
+    if (TF::LatencyTracer::instance().isOverlayEnabled()) {
+        this->drawLatency(painter);
+    }
+}
+
+void VideoWidget::drawLatency(QPainter *painter) {
+    QStringList lines = TF::LatencyTracer::instance().summaryLines();
+    if (lines.isEmpty()) {
+        return;
+    }
+
+    //等宽字体左上角逐行绘制,半透明底色保证任何画面上都能看清
+    painter->save();
+    QFont font("Courier New");
+    font.setStyleHint(QFont::Monospace);
+    font.setPixelSize(12);
+    painter->setFont(font);
+
+    QFontMetrics fm(font);
+    int lineHeight = fm.height();
+    int width = 0;
+    foreach (QString line, lines) {
+        width = qMax(width, fm.horizontalAdvance(line));
+    }
+
+    QRect rect(imageRect.topLeft() + QPoint(5, 5), QSize(width + 10, lineHeight * lines.count() + 10));
+    painter->fillRect(rect, QColor(0, 0, 0, 160));
+    painter->setPen(QColor(255, 255, 0));
+    for (int i = 0; i < lines.count(); ++i) {
+        painter->drawText(rect.left() + 5, rect.top() + 5 + fm.ascent() + i * lineHeight, lines.at(i));
+    }
+    painter->restore();
+}
+
 void VideoWidget::receiveFrame(int width, int height, quint8 *dataRGB, int type) {
     if (this->checkReceive()) {
         AbstractVideoWidget::receiveFrame(width, height, dataRGB, type);
@@ -576,6 +658,10 @@ void VideoWidget::connectThreadSignal() {
 
     connect(videoThread, SIGNAL(receiveImage(QImage, int)), this, SLOT(receiveImage(QImage, int)),
             Qt::UniqueConnection);
+    connect(videoThread, SIGNAL(receiveDetectImage(QImage, QImage, int)), this,
+            SLOT(receiveDetectImage(QImage, QImage, int)), Qt::UniqueConnection);
+    connect(videoThread, SIGNAL(receiveTrace(qint64, qint64, qint64)), this,
+            SLOT(receiveTrace(qint64, qint64, qint64)), Qt::UniqueConnection);
     connect(videoThread, SIGNAL(snapImage(QImage, QString)), this, SLOT(snapImage(QImage, QString)),
             Qt::UniqueConnection);
     connect(videoThread, SIGNAL(receiveFrame(int, int, quint8 * , int)), this,
@@ -616,6 +702,10 @@ void VideoWidget::disconnectThreadSignal() {
     disconnect(videoThread, SIGNAL(receivePlayFinsh()), this, SLOT(receivePlayFinsh()));
 
     disconnect(videoThread, SIGNAL(receiveImage(QImage, int)), this, SLOT(receiveImage(QImage, int)));
+    disconnect(videoThread, SIGNAL(receiveDetectImage(QImage, QImage, int)), this,
+               SLOT(receiveDetectImage(QImage, QImage, int)));
+    disconnect(videoThread, SIGNAL(receiveTrace(qint64, qint64, qint64)), this,
+               SLOT(receiveTrace(qint64, qint64, qint64)));
     disconnect(videoThread, SIGNAL(snapImage(QImage, QString)), this, SLOT(snapImage(QImage, QString)));
     disconnect(videoThread, SIGNAL(receiveFrame(int, int, quint8 * , int)), this,
                SLOT(receiveFrame(int, int, quint8 * , int)));
@@ -3,6 +3,8 @@
 
 #include "videothread.h"
 #include "abstractvideowidget.h"
+#include "DetectOverlay.h"
+#include "LatencyTracer.h"
 
 class VideoWidget : public AbstractVideoWidget {
 Q_OBJECT
@@ -16,6 +18,12 @@ protected:
     //窗体尺寸发生变化
     void resizeEvent(QResizeEvent *);
 
+    //绘制检测结果(框和掩膜),与当前图片一一对应
+    void drawOverlay(QPainter *painter) override;
+
+    //绘制各环节延时统计(调试用)
+    void drawLatency(QPainter *painter);
+
 private:
     //按下坐标
     QPoint lastPoint;
@@ -26,6 +34,9 @@ private:
     //AI检测
     bool detectionEnabled{false};
     QString detectionFlag;
+    TF::DetectOverlay detectOverlay;
+    //下一张检测图片的链路时间戳
+    TF::FrameTrace pendingTrace;
 
 public:
     //获取和设置采集参数
@@ -116,7 +127,14 @@ private slots:
     //收到一张图片
     void receiveImage(const QImage &image, int time);
 
-    void receiveDetectedImage(const QString &flag, const QImage &image, double meanValue, int time);
+    //收到一张图片及解码时缩放好的检测图片
+    void receiveDetectImage(const QImage &image, const QImage &detectImage, int time);
+
+    //收到下一张检测图片的解码链路时间戳
+    void receiveTrace(qint64 readTime, qint64 decodeTime, qint64 imageTime);
+
+    void receiveDetectedImage(const QString &flag, const QImage &image, const TF::DetectOverlay &overlay,
+                              double meanValue, int time);
 
     //接收一帧并绘制
     void receiveFrame(int width, int height, quint8 *dataRGB, int type);
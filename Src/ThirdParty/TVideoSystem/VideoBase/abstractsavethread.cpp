@@ -5,6 +5,7 @@ bool AbstractSaveThread::directSave = true;
 
 AbstractSaveThread::AbstractSaveThread(QObject *parent) : QThread(parent) {
     stopped = false;
+    finishing = false;
     isOk = false;
     isPause = false;
     errorCount = 0;
@@ -50,13 +51,28 @@ void AbstractSaveThread::run() {
             continue;
         }
 
-        //如果保存失败则休息一下
+        //队列为空则等待写入数据时唤醒/收尾阶段队列写完就退出
         if (!this->save()) {
-            msleep(1);
+            mutex.lock();
+            bool empty = (this->pendingCount() == 0);
+            if (finishing && empty) {
+                mutex.unlock();
+                break;
+            }
+            if (!stopped && isOk && empty) {
+                dataReady.wait(&mutex);
+            }
+            mutex.unlock();
         }
     }
 
+    //收尾阶段由本线程自己关闭文件(调用者不用等待写完)
+    if (finishing && !stopped) {
+        this->release();
+    }
+
     stopped = false;
+    finishing = false;
     isOk = false;
     isPause = false;
     errorCount = 0;
@@ -126,6 +142,10 @@ bool AbstractSaveThread::save() {
     return false;
 }
 
+int AbstractSaveThread::pendingCount() {
+    return 0;
+}
+
 void AbstractSaveThread::close() {
 
 }
@@ -205,11 +225,31 @@ void AbstractSaveThread::pause() {
 void AbstractSaveThread::stop() {
     //处于运行状态才可以停止
     if (this->isRunning()) {
+        mutex.lock();
         stopped = true;
         isPause = false;
+        dataReady.wakeAll();
+        mutex.unlock();
         this->wait();
     }
 
+    this->release();
+}
+
+void AbstractSaveThread::finish() {
+    //处于运行状态才需要收尾
+    if (this->isRunning()) {
+        mutex.lock();
+        finishing = true;
+        isPause = false;
+        dataReady.wakeAll();
+        mutex.unlock();
+    } else {
+        this->release();
+    }
+}
+
+void AbstractSaveThread::release() {
     //关闭释放并清理文件
     isOk = false;
     this->close();
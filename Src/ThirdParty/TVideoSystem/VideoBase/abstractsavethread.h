@@ -23,11 +23,21 @@ protected:
     //线程执行内容
     virtual void run();
 
+    //队列中待写入的数据数量(为0时线程等待唤醒)
+    virtual int pendingCount();
+
+    //关闭释放并清理文件
+    void release();
+
 protected:
     //数据锁
     QMutex mutex;
+    //等待条件(写入数据或者停止时唤醒)
+    QWaitCondition dataReady;
     //停止线程标志位
     volatile bool stopped;
+    //收尾标志位(写完队列后自动停止)
+    volatile bool finishing;
     //打开是否成功
     volatile bool isOk;
     //暂停写入标志位
@@ -108,6 +118,9 @@ public slots:
     //停止保存
     virtual void stop();
 
+    //写完队列中的数据后在后台停止保存(不阻塞调用者)
+    virtual void finish();
+
 signals:
 
     //保存成功
@@ -1,6 +1,7 @@
 ﻿#include "abstractvideothread.h"
 #include "deviceinfohelper.h"
 #include "urlhelper.h"
+#include <chrono>
 
 #ifdef videosave
 #include "savevideo.h"
@@ -16,6 +17,11 @@
 int AbstractVideoThread::debugInfo = 2;
 bool AbstractVideoThread::snapSource = false;
 
+qint64 AbstractVideoThread::traceTime() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 AbstractVideoThread::AbstractVideoThread(QObject *parent) : QThread(parent) {
     //注册数据类型
     qRegisterMetaType<RecorderState>("RecorderState");
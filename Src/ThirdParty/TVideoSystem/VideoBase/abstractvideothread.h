@@ -18,6 +18,9 @@ public:
     //从原始图像截图
     static bool snapSource;
 
+    //链路追踪用的时间戳(微秒/稳定时钟/跨线程可比)
+    static qint64 traceTime();
+
     explicit AbstractVideoThread(QObject *parent = 0);
 
     ~AbstractVideoThread();
@@ -44,6 +47,10 @@ protected:
     volatile bool isRecord;
     // AI detecting
     volatile bool isDetect {false};
+    // Size of the extra frame scaled for detection, invalid means only the full frame is sent
+    QSize detectSize;
+    // Stamp detection frames along the decode path, see receiveTrace
+    volatile bool isTrace {false};
 
     //地址标识
     QString addr;
@@ -340,6 +347,12 @@ signals:
     //收到一张图片
     void receiveImage(const QImage &image, int time);
 
+    //收到一张图片及其缩放到检测尺寸的图片
+    void receiveDetectImage(const QImage &image, const QImage &detectImage, int time);
+
+    //紧接着发出的检测图片的时间戳(读取数据包/解码完成/转成图片)
+    void receiveTrace(qint64 readTime, qint64 decodeTime, qint64 imageTime);
+
     //抓拍一张图片
     void snapImage(const QImage &image, const QString &snapName);
 
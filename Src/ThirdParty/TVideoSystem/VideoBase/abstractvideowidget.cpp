@@ -254,6 +254,7 @@ bool AbstractVideoWidget::eventFilter(QObject *watched, QEvent *event) {
             //如果图片不为空则绘制图片否则绘制背景
             if (!image.isNull()) {
                 drawImage(&painter);
+                drawOverlay(&painter);
             } else {
                 drawBg(&painter);
             }
@@ -441,6 +442,10 @@ void AbstractVideoWidget::drawImage(QPainter *painter) {
     painter->restore();
 }
 
+void AbstractVideoWidget::drawOverlay(QPainter *painter) {
+    Q_UNUSED(painter);
+}
+
 int AbstractVideoWidget::getBgTextSize() const {
     return widgetPara.bgTextSize;
 }
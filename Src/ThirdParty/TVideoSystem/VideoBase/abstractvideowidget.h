@@ -87,6 +87,9 @@ protected:
 
     void drawImage(QPainter *painter);
 
+    //在图片上方绘制附加内容(比如检测结果),在图片之后绘制
+    virtual void drawOverlay(QPainter *painter);
+
 protected:
     //数据锁
     QMutex mutex;
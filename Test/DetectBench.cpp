@@ -0,0 +1,869 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <opencv2/opencv.hpp>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "TConfig.h"
+#include "DetectDef.h"
+#include "DetectManager.h"
+#include "Detector.h"
+#include "InferenceORT.h"
+
+// Headless detector benchmark and accuracy regression check.
+//
+//   DetectBench --config TFConfigs/TFConfigsBench.yml --images Data/Bench [--write-golden golden.json]
+//   DetectBench --config TFConfigs/TFConfigsBench.yml --video clip.mp4 --golden golden.json --min-map 0.9
+//   DetectBench --config TFConfigs/TFConfigsBench.yml --images Data/Bench --tune [--tune-out OrtTune.json]
+//   DetectBench --config TFConfigs/TFConfigsBench.yml --images Data/Bench --swap <ModelRegistry name> [--swap-rounds 3]
+//
+// Built by -DFIREAPP_BUILD_BENCH=ON from the Detector sources, ORT on the CPU only (no USE_CUDA, no TensorRT).
+// Exit code 0 passes, 1 is a performance or accuracy regression, 2 is a setup error.
+
+namespace
+{
+    std::atomic<uint64_t> gAllocCount{0};
+}
+
+void *operator new(std::size_t size)
+{
+    gAllocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct BenchOptions
+    {
+        std::string config;
+        std::string images;
+        std::string video;
+        std::string golden;
+        std::string writeGolden;
+        int maxFrames{0};
+        int warmup{3};
+        float iou{0.5f};
+        double minMap{0.0};
+        double minRecall{0.0};
+        double maxP90Ms{0.0};
+        bool tune{false};
+        std::string tuneOut;
+        std::string swapModel;
+        int swapRounds{3};
+    };
+
+    struct FrameResult
+    {
+        std::string key;
+        std::vector<TF::Detection> detections;
+    };
+
+    struct StageSamples
+    {
+        std::vector<double> preprocess;
+        std::vector<double> infer;
+        std::vector<double> decode;
+        std::vector<double> mask;
+        std::vector<double> overlay;
+        std::vector<double> total;
+        std::vector<double> allocs;
+    };
+
+    struct GoldenBox
+    {
+        int classId{0};
+        float score{0.0f};
+        cv::Rect box;
+    };
+
+    double ElapsedMs(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    double Percentile(std::vector<double> values, double pct)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        const auto idx = static_cast<size_t>(pct / 100.0 * static_cast<double>(values.size() - 1) + 0.5);
+        return values[std::min(idx, values.size() - 1)];
+    }
+
+    void PrintStage(const std::string &title, const std::vector<double> &samples, const std::string &unit = "ms")
+    {
+        std::cout << std::fixed << std::setprecision(2)
+                  << "  " << std::left << std::setw(12) << title << std::right
+                  << "p50 " << std::setw(8) << Percentile(samples, 50)
+                  << "  p90 " << std::setw(8) << Percentile(samples, 90)
+                  << "  p99 " << std::setw(8) << Percentile(samples, 99)
+                  << "  max " << std::setw(8) << Percentile(samples, 100) << " " << unit << std::endl;
+    }
+
+    long PeakRssKb()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+        }
+        return 0;
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss;
+#endif
+    }
+
+    float Iou(const cv::Rect &a, const cv::Rect &b)
+    {
+        const float inter = static_cast<float>((a & b).area());
+        if (inter <= 0.0f)
+        {
+            return 0.0f;
+        }
+        return inter / static_cast<float>(a.area() + b.area() - inter);
+    }
+
+    // Frames in a stable order so that golden keys line up between runs
+    class FrameSource
+    {
+    public:
+        bool open(const BenchOptions &opts)
+        {
+            if (!opts.video.empty())
+            {
+                return mCapture.open(opts.video);
+            }
+            const std::vector<std::string> exts{".jpg", ".jpeg", ".png", ".bmp"};
+            std::error_code ec;
+            for (const auto &entry : std::filesystem::directory_iterator(opts.images, ec))
+            {
+                auto ext = entry.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+                if (entry.is_regular_file() && std::find(exts.begin(), exts.end(), ext) != exts.end())
+                {
+                    mFiles.push_back(entry.path());
+                }
+            }
+            std::sort(mFiles.begin(), mFiles.end());
+            return !mFiles.empty();
+        }
+
+        bool next(cv::Mat &frame, std::string &key)
+        {
+            if (mCapture.isOpened())
+            {
+                if (!mCapture.read(frame))
+                {
+                    return false;
+                }
+                std::ostringstream oss;
+                oss << "frame_" << std::setw(6) << std::setfill('0') << mIndex++;
+                key = oss.str();
+                return true;
+            }
+            while (mIndex < mFiles.size())
+            {
+                const auto &path = mFiles[mIndex++];
+                frame = cv::imread(path.string());
+                if (!frame.empty())
+                {
+                    key = path.filename().string();
+                    return true;
+                }
+                std::cerr << "Skip unreadable image " << path.string() << std::endl;
+            }
+            return false;
+        }
+
+    private:
+        cv::VideoCapture mCapture;
+        std::vector<std::filesystem::path> mFiles;
+        size_t mIndex{0};
+    };
+
+    bool WriteGolden(const std::string &path, const std::vector<FrameResult> &results)
+    {
+        QJsonArray frames;
+        for (const auto &result : results)
+        {
+            QJsonArray dets;
+            for (const auto &det : result.detections)
+            {
+                QJsonObject obj;
+                obj["classId"] = det.class_id;
+                obj["score"] = static_cast<double>(det.confidence);
+                obj["box"] = QJsonArray{det.box.x, det.box.y, det.box.width, det.box.height};
+                dets.append(obj);
+            }
+            QJsonObject frame;
+            frame["key"] = QString::fromStdString(result.key);
+            frame["detections"] = dets;
+            frames.append(frame);
+        }
+        QJsonObject root;
+        root["frames"] = frames;
+
+        QFile file(QString::fromStdString(path));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            return false;
+        }
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+        return true;
+    }
+
+    bool ReadGolden(const std::string &path, std::map<std::string, std::vector<GoldenBox>> &golden)
+    {
+        QFile file(QString::fromStdString(path));
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return false;
+        }
+        const auto doc = QJsonDocument::fromJson(file.readAll());
+        if (!doc.isObject())
+        {
+            return false;
+        }
+        for (const auto &frameVal : doc.object()["frames"].toArray())
+        {
+            const auto frame = frameVal.toObject();
+            auto &boxes = golden[frame["key"].toString().toStdString()];
+            for (const auto &detVal : frame["detections"].toArray())
+            {
+                const auto det = detVal.toObject();
+                const auto box = det["box"].toArray();
+                GoldenBox gb;
+                gb.classId = det["classId"].toInt();
+                gb.score = static_cast<float>(det["score"].toDouble());
+                gb.box = cv::Rect(box[0].toInt(), box[1].toInt(), box[2].toInt(), box[3].toInt());
+                boxes.push_back(gb);
+            }
+        }
+        return true;
+    }
+
+    // All-point interpolated AP over detections ranked by score
+    double AveragePrecision(std::vector<std::pair<float, bool>> ranked, size_t positives)
+    {
+        if (positives == 0)
+        {
+            return ranked.empty() ? 1.0 : 0.0;
+        }
+        std::sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+
+        std::vector<double> precision;
+        std::vector<double> recall;
+        size_t tp = 0;
+        for (size_t i = 0; i < ranked.size(); ++i)
+        {
+            tp += ranked[i].second ? 1 : 0;
+            precision.push_back(static_cast<double>(tp) / static_cast<double>(i + 1));
+            recall.push_back(static_cast<double>(tp) / static_cast<double>(positives));
+        }
+        for (size_t i = precision.size(); i-- > 1;)
+        {
+            precision[i - 1] = std::max(precision[i - 1], precision[i]);
+        }
+        double ap = 0.0;
+        double prevRecall = 0.0;
+        for (size_t i = 0; i < precision.size(); ++i)
+        {
+            ap += (recall[i] - prevRecall) * precision[i];
+            prevRecall = recall[i];
+        }
+        return ap;
+    }
+
+    // Golden detections are the ground truth; returns false on an accuracy regression
+    bool CompareGolden(const std::vector<FrameResult> &results,
+                       const std::map<std::string, std::vector<GoldenBox>> &golden,
+                       const BenchOptions &opts)
+    {
+        std::map<int, std::vector<std::pair<float, bool>>> ranked;
+        std::map<int, size_t> positives;
+        size_t matched = 0;
+        size_t totalGolden = 0;
+        size_t missingFrames = 0;
+        double iouSum = 0.0;
+
+        for (const auto &[key, boxes] : golden)
+        {
+            for (const auto &gb : boxes)
+            {
+                positives[gb.classId]++;
+                totalGolden++;
+            }
+        }
+
+        for (const auto &result : results)
+        {
+            const auto it = golden.find(result.key);
+            if (it == golden.end())
+            {
+                missingFrames++;
+                continue;
+            }
+            const auto &boxes = it->second;
+            std::vector<bool> used(boxes.size(), false);
+
+            std::vector<const TF::Detection *> dets;
+            for (const auto &det : result.detections)
+            {
+                dets.push_back(&det);
+            }
+            std::sort(dets.begin(), dets.end(), [](const auto *a, const auto *b) {
+                return a->confidence > b->confidence;
+            });
+
+            for (const auto *det : dets)
+            {
+                int best = -1;
+                float bestIou = opts.iou;
+                for (size_t g = 0; g < boxes.size(); ++g)
+                {
+                    if (used[g] || boxes[g].classId != det->class_id)
+                    {
+                        continue;
+                    }
+                    const float v = Iou(det->box, boxes[g].box);
+                    if (v >= bestIou)
+                    {
+                        bestIou = v;
+                        best = static_cast<int>(g);
+                    }
+                }
+                if (best >= 0)
+                {
+                    used[best] = true;
+                    matched++;
+                    iouSum += bestIou;
+                }
+                ranked[det->class_id].emplace_back(det->confidence, best >= 0);
+            }
+        }
+
+        double mapSum = 0.0;
+        for (const auto &[cls, count] : positives)
+        {
+            mapSum += AveragePrecision(ranked[cls], count);
+        }
+        const double map = positives.empty() ? 1.0 : mapSum / static_cast<double>(positives.size());
+        const double recall = totalGolden == 0 ? 1.0 : static_cast<double>(matched) / static_cast<double>(totalGolden);
+
+        std::cout << std::fixed << std::setprecision(4)
+                  << "==== accuracy vs golden (IoU " << opts.iou << ") ====\n"
+                  << "  mAP " << map << "  recall " << recall
+                  << "  mean IoU " << (matched == 0 ? 0.0 : iouSum / static_cast<double>(matched)) << "\n"
+                  << "  matched " << matched << "/" << totalGolden
+                  << "  frames without golden " << missingFrames << std::endl;
+
+        bool pass = true;
+        if (map < opts.minMap)
+        {
+            std::cout << "  REGRESSION: mAP " << map << " < " << opts.minMap << std::endl;
+            pass = false;
+        }
+        if (recall < opts.minRecall)
+        {
+            std::cout << "  REGRESSION: recall " << recall << " < " << opts.minRecall << std::endl;
+            pass = false;
+        }
+        return pass;
+    }
+
+    // Thread counts 1, 2, 4, ... up to the core count, with and without spinning, on the CPU and XNNPACK providers
+    std::vector<TF::ORT_RUNTIME_PARAM> TuneCandidates(const TF::ORT_RUNTIME_PARAM &base)
+    {
+        const int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        std::vector<int> threads;
+        for (int t = 1; t < cores; t *= 2)
+        {
+            threads.push_back(t);
+        }
+        threads.push_back(cores);
+
+        std::vector<TF::ORT_RUNTIME_PARAM> candidates;
+        for (const std::string provider : {"CPU", "XNNPACK"})
+        {
+            for (int t : threads)
+            {
+                for (bool spin : {true, false})
+                {
+                    // XNNPACK turns ORT spinning off anyway
+                    if (provider == "XNNPACK" && spin)
+                    {
+                        continue;
+                    }
+                    auto param = base;
+                    param.provider = provider;
+                    param.intraOpThreads = t;
+                    param.allowSpinning = spin;
+                    param.globalThreadPool = false;
+                    param.parallelExecution = false;
+                    candidates.push_back(param);
+                }
+            }
+        }
+        return candidates;
+    }
+
+    // Runs the frames through one session per candidate and records the fastest by p50
+    int RunTune(const BenchOptions &opts)
+    {
+        FrameSource source;
+        if (!source.open(opts))
+        {
+            std::cerr << "No input frames" << std::endl;
+            return 2;
+        }
+        const int maxFrames = opts.maxFrames > 0 ? opts.maxFrames : 20;
+        std::vector<cv::Mat> frames;
+        cv::Mat frame;
+        std::string key;
+        while (static_cast<int>(frames.size()) < maxFrames && source.next(frame, key))
+        {
+            frames.push_back(frame.clone());
+        }
+        if (frames.empty())
+        {
+            std::cerr << "No input frames" << std::endl;
+            return 2;
+        }
+
+        const auto modelPath = GET_STR_CONFIG("VisionMea", "DetModelName");
+        const auto base = TF::LoadOrtRuntimeParam();
+        TF::ORT_RUNTIME_PARAM best;
+        double bestP50 = 0.0;
+        bool found = false;
+
+        std::cout << "==== ORT tune, " << frames.size() << " frames per candidate ====" << std::endl;
+        for (const auto &candidate : TuneCandidates(base))
+        {
+            TF::InferenceORT inference(modelPath, candidate);
+            if (!inference.ready())
+            {
+                std::cout << "  skip  " << TF::OrtRuntimeParamToString(candidate) << std::endl;
+                continue;
+            }
+            for (int i = 0; i < opts.warmup; ++i)
+            {
+                inference.runInference(frames[static_cast<size_t>(i) % frames.size()]);
+            }
+            std::vector<double> samples;
+            for (const auto &input : frames)
+            {
+                const auto start = Clock::now();
+                inference.runInference(input);
+                samples.push_back(ElapsedMs(start, Clock::now()));
+            }
+            const double p50 = Percentile(samples, 50);
+            std::cout << std::fixed << std::setprecision(2)
+                      << "  p50 " << std::setw(8) << p50 << " ms  p90 " << std::setw(8) << Percentile(samples, 90)
+                      << " ms  " << TF::OrtRuntimeParamToString(candidate) << std::endl;
+            if (!found || p50 < bestP50)
+            {
+                best = candidate;
+                bestP50 = p50;
+                found = true;
+            }
+        }
+        if (!found)
+        {
+            std::cerr << "No candidate could create a session" << std::endl;
+            return 2;
+        }
+
+        std::string out = opts.tuneOut;
+        if (out.empty())
+        {
+            out = GET_STR_CONFIG("OrtRuntime", "TuneFile");
+        }
+        if (out.empty())
+        {
+            out = "OrtTune.json";
+        }
+        if (!TF::SaveOrtTuneFile(out, best, bestP50))
+        {
+            std::cerr << "Write tune file " << out << " failed" << std::endl;
+            return 2;
+        }
+        std::cout << "  best " << TF::OrtRuntimeParamToString(best) << ", p50 " << bestP50 << " ms\n"
+                  << "  written to " << out << ", point OrtRuntime/TuneFile at it" << std::endl;
+        return 0;
+    }
+
+    // Swaps to opts.swapModel and rolls back while a second thread keeps detecting through
+    // TFDetectManager, the way DetectorWorker does; every frame must still succeed
+    int RunSwap(const BenchOptions &opts)
+    {
+        FrameSource source;
+        if (!source.open(opts))
+        {
+            std::cerr << "No input frames" << std::endl;
+            return 2;
+        }
+        const int maxFrames = opts.maxFrames > 0 ? opts.maxFrames : 20;
+        std::vector<cv::Mat> frames;
+        cv::Mat frame;
+        std::string key;
+        while (static_cast<int>(frames.size()) < maxFrames && source.next(frame, key))
+        {
+            frames.push_back(frame.clone());
+        }
+        if (frames.empty())
+        {
+            std::cerr << "No input frames" << std::endl;
+            return 2;
+        }
+
+        auto &manager = TF::TFDetectManager::instance();
+        if (!manager.init())
+        {
+            std::cerr << "TFDetectManager init failed, check DetMode/DetModelName in " << opts.config << std::endl;
+            return 2;
+        }
+        const auto baseModel = manager.activeModelName();
+
+        std::atomic<bool> running{true};
+        std::atomic<int> failures{0};
+        std::vector<double> samples;
+        std::thread detectThread([&]() {
+            size_t index = 0;
+            while (running.load())
+            {
+                size_t detectNum = 0;
+                std::vector<TF::Detection> detections;
+                const auto start = Clock::now();
+                if (manager.runDetect(frames[index++ % frames.size()], detectNum, detections) < 0)
+                {
+                    failures.fetch_add(1);
+                }
+                samples.push_back(ElapsedMs(start, Clock::now()));
+            }
+        });
+
+        const auto waitSwap = [&manager]() {
+            while (manager.isSwapLoading())
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        };
+        // Frames run on each model for a while before the next switch
+        const auto settle = []() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        };
+
+        int ret = 0;
+        const int generationBefore = manager.modelGeneration();
+        settle();
+        for (int round = 0; round < opts.swapRounds && ret == 0; ++round)
+        {
+            const auto swapStart = Clock::now();
+            if (!manager.swapModelAsync(opts.swapModel))
+            {
+                std::cerr << "Swap to " << opts.swapModel << " rejected, is it in [ModelRegistry]?" << std::endl;
+                ret = 2;
+                break;
+            }
+            waitSwap();
+            const double swapMs = ElapsedMs(swapStart, Clock::now());
+            if (manager.activeModelName() != opts.swapModel)
+            {
+                std::cout << "  FAIL: round " << round << ", " << opts.swapModel << " not active after the swap"
+                          << std::endl;
+                ret = 1;
+                break;
+            }
+            settle();
+
+            if (!manager.rollbackModel() || manager.activeModelName() != baseModel)
+            {
+                std::cout << "  FAIL: round " << round << ", rollback did not restore " << baseModel << std::endl;
+                ret = 1;
+                break;
+            }
+            std::cout << std::fixed << std::setprecision(2)
+                      << "  round " << round << ": " << baseModel << " -> " << opts.swapModel << " loaded in "
+                      << swapMs << " ms, rolled back" << std::endl;
+            settle();
+        }
+
+        running = false;
+        detectThread.join();
+
+        std::cout << "==== model swap, " << samples.size() << " frames across "
+                  << manager.modelGeneration() - generationBefore << " model changes ====" << std::endl;
+        PrintStage("frame", samples);
+        for (const auto &stat : manager.modelLatencyStats())
+        {
+            std::cout << std::fixed << std::setprecision(2)
+                      << "  " << std::left << std::setw(12) << stat.name << std::right
+                      << "frames " << std::setw(6) << stat.frames
+                      << "  mean " << std::setw(8) << stat.meanMs
+                      << "  max " << std::setw(8) << stat.maxMs << " ms" << std::endl;
+        }
+        if (failures.load() > 0)
+        {
+            std::cout << "  FAIL: " << failures.load() << " frames failed during the swaps" << std::endl;
+            ret = ret == 0 ? 1 : ret;
+        }
+        if (ret == 0 && opts.maxP90Ms > 0.0 && Percentile(samples, 90) > opts.maxP90Ms)
+        {
+            std::cout << "  REGRESSION: frame p90 " << Percentile(samples, 90) << " ms > " << opts.maxP90Ms
+                      << " ms" << std::endl;
+            ret = 1;
+        }
+        return ret;
+    }
+
+    void PrintUsage()
+    {
+        std::cout << "Usage: DetectBench --config <yml> (--images <dir> | --video <file>)\n"
+                  << "                   [--max-frames N] [--warmup N]\n"
+                  << "                   [--write-golden <json>] [--golden <json> --iou 0.5 --min-map X --min-recall X]\n"
+                  << "                   [--max-p90-ms X]\n"
+                  << "                   [--tune [--tune-out <json>]]\n"
+                  << "                   [--swap <model> [--swap-rounds N]]" << std::endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions opts;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc)
+        {
+            opts.config = argv[++i];
+        }
+        else if (arg == "--images" && i + 1 < argc)
+        {
+            opts.images = argv[++i];
+        }
+        else if (arg == "--video" && i + 1 < argc)
+        {
+            opts.video = argv[++i];
+        }
+        else if (arg == "--golden" && i + 1 < argc)
+        {
+            opts.golden = argv[++i];
+        }
+        else if (arg == "--write-golden" && i + 1 < argc)
+        {
+            opts.writeGolden = argv[++i];
+        }
+        else if (arg == "--max-frames" && i + 1 < argc)
+        {
+            opts.maxFrames = std::stoi(argv[++i]);
+        }
+        else if (arg == "--warmup" && i + 1 < argc)
+        {
+            opts.warmup = std::stoi(argv[++i]);
+        }
+        else if (arg == "--iou" && i + 1 < argc)
+        {
+            opts.iou = std::stof(argv[++i]);
+        }
+        else if (arg == "--min-map" && i + 1 < argc)
+        {
+            opts.minMap = std::stod(argv[++i]);
+        }
+        else if (arg == "--min-recall" && i + 1 < argc)
+        {
+            opts.minRecall = std::stod(argv[++i]);
+        }
+        else if (arg == "--max-p90-ms" && i + 1 < argc)
+        {
+            opts.maxP90Ms = std::stod(argv[++i]);
+        }
+        else if (arg == "--tune")
+        {
+            opts.tune = true;
+        }
+        else if (arg == "--tune-out" && i + 1 < argc)
+        {
+            opts.tuneOut = argv[++i];
+        }
+        else if (arg == "--swap" && i + 1 < argc)
+        {
+            opts.swapModel = argv[++i];
+        }
+        else if (arg == "--swap-rounds" && i + 1 < argc)
+        {
+            opts.swapRounds = std::stoi(argv[++i]);
+        }
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (opts.config.empty() || (opts.images.empty() == opts.video.empty()))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    TBase::TConfig::instance().addYamlConfigFile(opts.config);
+    if (opts.tune)
+    {
+        return RunTune(opts);
+    }
+    if (!opts.swapModel.empty())
+    {
+        return RunSwap(opts);
+    }
+
+    TF::Detector detector;
+    if (!detector.init())
+    {
+        std::cerr << "Detector init failed, check DetMode/DetModelName in " << opts.config << std::endl;
+        return 2;
+    }
+
+    FrameSource source;
+    if (!source.open(opts))
+    {
+        std::cerr << "No input frames" << std::endl;
+        return 2;
+    }
+
+    std::vector<FrameResult> results;
+    StageSamples samples;
+    int frameCount = 0;
+    double measuredMs = 0.0;
+    const long rssBeforeKb = PeakRssKb();
+
+    cv::Mat frame;
+    std::string key;
+    while (source.next(frame, key))
+    {
+        if (opts.maxFrames > 0 && frameCount >= opts.maxFrames + opts.warmup)
+        {
+            break;
+        }
+
+        size_t detectNum = 0;
+        FrameResult result;
+        result.key = key;
+
+        const uint64_t allocBefore = gAllocCount.load(std::memory_order_relaxed);
+        detector.resetStageTimes();
+        const auto start = Clock::now();
+        detector.runDetect(frame, detectNum, result.detections);
+        const auto inferEnd = Clock::now();
+
+        cv::Mat overlay = frame.clone();
+        TF::Detector::drawDetections(overlay, result.detections);
+        const auto end = Clock::now();
+        const uint64_t allocs = gAllocCount.load(std::memory_order_relaxed) - allocBefore;
+
+        // Warm-up frames still go to the golden file, only their timings are dropped
+        if (frameCount >= opts.warmup)
+        {
+            const auto stages = detector.stageTimes();
+            samples.preprocess.push_back(stages.preprocessMs);
+            samples.infer.push_back(stages.inferMs);
+            samples.decode.push_back(stages.decodeMs);
+            samples.mask.push_back(stages.maskMs);
+            samples.overlay.push_back(ElapsedMs(inferEnd, end));
+            samples.total.push_back(ElapsedMs(start, end));
+            samples.allocs.push_back(static_cast<double>(allocs));
+            measuredMs += ElapsedMs(start, end);
+        }
+        results.emplace_back(std::move(result));
+        frameCount++;
+    }
+
+    const size_t measured = samples.total.size();
+    std::cout << std::fixed << std::setprecision(2)
+              << "==== detector latency, " << measured << " frames (" << opts.warmup << " warm-up) ====" << std::endl;
+    PrintStage("preprocess", samples.preprocess);
+    PrintStage("infer", samples.infer);
+    PrintStage("decode", samples.decode);
+    PrintStage("mask", samples.mask);
+    PrintStage("overlay", samples.overlay);
+    PrintStage("total", samples.total);
+    PrintStage("allocs", samples.allocs, "per frame");
+    std::cout << "  throughput " << (measuredMs > 0.0 ? 1000.0 * static_cast<double>(measured) / measuredMs : 0.0)
+              << " frames/s" << "\n"
+              << "  peak RSS " << PeakRssKb() / 1024 << " MB (" << rssBeforeKb / 1024 << " MB after init)" << std::endl;
+
+    int ret = 0;
+    if (opts.maxP90Ms > 0.0 && Percentile(samples.total, 90) > opts.maxP90Ms)
+    {
+        std::cout << "  REGRESSION: total p90 " << Percentile(samples.total, 90) << " ms > " << opts.maxP90Ms
+                  << " ms" << std::endl;
+        ret = 1;
+    }
+
+    if (!opts.writeGolden.empty())
+    {
+        if (!WriteGolden(opts.writeGolden, results))
+        {
+            std::cerr << "Write golden " << opts.writeGolden << " failed" << std::endl;
+            return 2;
+        }
+        std::cout << "Golden written to " << opts.writeGolden << std::endl;
+    }
+
+    if (!opts.golden.empty())
+    {
+        std::map<std::string, std::vector<GoldenBox>> golden;
+        if (!ReadGolden(opts.golden, golden))
+        {
+            std::cerr << "Read golden " << opts.golden << " failed" << std::endl;
+            return 2;
+        }
+        if (!CompareGolden(results, golden, opts))
+        {
+            ret = 1;
+        }
+    }
+    return ret;
+}
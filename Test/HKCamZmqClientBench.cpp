@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QJsonObject>
+
+#include "../Src/Src/HKCam/HKCamMockServer.h"
+#include "../Src/Src/HKCam/HKCamZmqClient.h"
+
+using TF::HKCamMockConfig;
+using TF::HKCamMockServer;
+using TF::HKCamZmqClient;
+using TF::RpcCallResult;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    double Percentile(std::vector<double> values, double pct)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+        std::sort(values.begin(), values.end());
+        const auto idx = static_cast<size_t>(pct / 100.0 * static_cast<double>(values.size() - 1) + 0.5);
+        return values[std::min(idx, values.size() - 1)];
+    }
+
+    void PrintLatency(const std::string &title, const std::vector<double> &samples, int failures)
+    {
+        std::cout << std::fixed << std::setprecision(2)
+                  << "==== " << title << " ====\n"
+                  << "  samples " << samples.size() << " failures " << failures << "\n"
+                  << "  p50 " << Percentile(samples, 50) << " ms"
+                  << "  p90 " << Percentile(samples, 90) << " ms"
+                  << "  p99 " << Percentile(samples, 99) << " ms"
+                  << "  max " << Percentile(samples, 100) << " ms" << std::endl;
+    }
+
+    // 顺序同步调用，测量单次往返时延
+    void BenchRoundTrip(HKCamZmqClient &client, int calls)
+    {
+        std::vector<double> samples;
+        int failures = 0;
+        for (int i = 0; i < calls; ++i)
+        {
+            TF::RpcResponse resp;
+            std::string err;
+            const auto start = Clock::now();
+            if (client.Ping(resp, err))
+            {
+                samples.push_back(ElapsedMs(start, Clock::now()));
+            }
+            else
+            {
+                ++failures;
+            }
+        }
+        PrintLatency("sequential ping RTT", samples, failures);
+    }
+
+    // 保持 window 个请求在途，测量吞吐与排队后的时延
+    void BenchThroughput(HKCamZmqClient &client, int calls, int window)
+    {
+        std::mutex mutex;
+        std::condition_variable cond;
+        int inFlight = 0;
+        int done = 0;
+        int failures = 0;
+        std::vector<double> samples;
+        samples.reserve(calls);
+
+        const auto start = Clock::now();
+        for (int i = 0; i < calls; ++i)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&] { return inFlight < window; });
+                ++inFlight;
+            }
+            const auto sentAt = Clock::now();
+            client.CallAsync("get_zoom", QJsonObject(), [&, sentAt](const RpcCallResult &result) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (result.success)
+                {
+                    samples.push_back(ElapsedMs(sentAt, Clock::now()));
+                }
+                else
+                {
+                    ++failures;
+                }
+                --inFlight;
+                ++done;
+                cond.notify_all();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&] { return done == calls; });
+        const double totalMs = ElapsedMs(start, Clock::now());
+        PrintLatency("async get_zoom, window " + std::to_string(window), samples, failures);
+        std::cout << "  throughput " << (1000.0 * calls / totalMs) << " calls/s" << std::endl;
+    }
+
+    // 服务中断后重启，测量客户端恢复到首次成功调用的时间
+    void BenchRecovery(HKCamZmqClient &client, HKCamMockServer &server, const HKCamMockConfig &cfg, int outageMs)
+    {
+        server.Stop();
+        int failedDuringOutage = 0;
+        const auto outageStart = Clock::now();
+        while (ElapsedMs(outageStart, Clock::now()) < outageMs)
+        {
+            TF::RpcResponse resp;
+            std::string err;
+            if (!client.Ping(resp, err))
+            {
+                ++failedDuringOutage;
+            }
+        }
+
+        std::string err;
+        if (!server.Start(cfg, err))
+        {
+            std::cerr << "Restart mock failed: " << err << std::endl;
+            return;
+        }
+
+        const auto restartAt = Clock::now();
+        int attempts = 0;
+        while (true)
+        {
+            TF::RpcResponse resp;
+            ++attempts;
+            if (client.Ping(resp, err))
+            {
+                break;
+            }
+            if (ElapsedMs(restartAt, Clock::now()) > 30000.0)
+            {
+                std::cout << "==== recovery ====\n  not recovered within 30 s" << std::endl;
+                return;
+            }
+        }
+        std::cout << std::fixed << std::setprecision(2)
+                  << "==== recovery ====\n"
+                  << "  failed calls during outage " << failedDuringOutage << "\n"
+                  << "  recovered after " << ElapsedMs(restartAt, Clock::now()) << " ms, "
+                  << attempts << " attempts" << std::endl;
+    }
+
+    // 多线程同时 reconnect，模拟界面反复点击连接
+    void BenchReconnectStorm(HKCamZmqClient &client, int threads, int callsPerThread)
+    {
+        std::atomic<int> failures{0};
+        std::mutex mutex;
+        std::vector<double> samples;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&] {
+                for (int i = 0; i < callsPerThread; ++i)
+                {
+                    TF::RpcResponse resp;
+                    std::string err;
+                    const auto start = Clock::now();
+                    if (client.ReconnectDevice(resp, err))
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        samples.push_back(ElapsedMs(start, Clock::now()));
+                    }
+                    else
+                    {
+                        ++failures;
+                    }
+                }
+            });
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+        PrintLatency("reconnect storm, " + std::to_string(threads) + " threads", samples, failures.load());
+    }
+
+    // 连续变焦步进，统计实际到达服务端的 set_zoom_abs 数量
+    void BenchZoomCoalescing(HKCamZmqClient &client, HKCamMockServer &server, int steps)
+    {
+        double zoom = 0.0;
+        QJsonObject raw;
+        std::string err;
+        client.GetZoom(zoom, raw, err);
+        client.SetZoomLimits(0.0, 1.0);
+        server.ResetOpCounts();
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        int finished = 0;
+        int superseded = 0;
+        for (int i = 0; i < steps; ++i)
+        {
+            client.ZoomStepCoalesced(0.005, std::nullopt, [&](const RpcCallResult &result) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!result.success && result.errorReason == QStringLiteral("Superseded"))
+                {
+                    ++superseded;
+                }
+                ++finished;
+                cond.notify_all();
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&] { return finished == steps; });
+        const auto counts = server.OpCounts();
+        const auto it = counts.find("set_zoom_abs");
+        std::cout << "==== zoom coalescing ====\n"
+                  << "  steps " << steps << " superseded " << superseded
+                  << " set_zoom_abs sent " << (it == counts.end() ? 0 : it->second) << std::endl;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    HKCamMockConfig cfg;
+    cfg.endpoint = "tcp://127.0.0.1:5599";
+    int timeoutMs = 1000;
+    int calls = 200;
+    int window = 8;
+    int outageMs = 2000;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--endpoint" && i + 1 < argc)
+        {
+            cfg.endpoint = argv[++i];
+        }
+        else if (arg == "--latency" && i + 1 < argc)
+        {
+            cfg.latencyMs = std::stoi(argv[++i]);
+        }
+        else if (arg == "--jitter" && i + 1 < argc)
+        {
+            cfg.jitterMs = std::stoi(argv[++i]);
+        }
+        else if (arg == "--error-rate" && i + 1 < argc)
+        {
+            cfg.errorRate = std::stod(argv[++i]);
+        }
+        else if (arg == "--drop-rate" && i + 1 < argc)
+        {
+            cfg.dropRate = std::stod(argv[++i]);
+        }
+        else if (arg == "--parallel")
+        {
+            cfg.serial = false;
+        }
+        else if (arg == "--timeout" && i + 1 < argc)
+        {
+            timeoutMs = std::stoi(argv[++i]);
+        }
+        else if (arg == "--calls" && i + 1 < argc)
+        {
+            calls = std::stoi(argv[++i]);
+        }
+        else if (arg == "--window" && i + 1 < argc)
+        {
+            window = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--outage" && i + 1 < argc)
+        {
+            outageMs = std::stoi(argv[++i]);
+        }
+    }
+
+    HKCamMockServer server;
+    std::string err;
+    if (!server.Start(cfg, err))
+    {
+        std::cerr << err << std::endl;
+        return 1;
+    }
+
+    auto &client = HKCamZmqClient::instance();
+    if (!client.Connect(cfg.endpoint, timeoutMs, 3, err))
+    {
+        std::cerr << "Connect failed: " << err << std::endl;
+        return 1;
+    }
+
+    std::cout << "mock latency " << cfg.latencyMs << "+" << cfg.jitterMs << " ms, error " << cfg.errorRate
+              << ", drop " << cfg.dropRate << ", client timeout " << timeoutMs << " ms" << std::endl;
+
+    BenchRoundTrip(client, calls);
+    BenchThroughput(client, calls, window);
+    BenchReconnectStorm(client, window, std::max(1, calls / window / 4));
+    BenchZoomCoalescing(client, server, 100);
+    BenchRecovery(client, server, cfg, outageMs);
+
+    server.Stop();
+    return 0;
+}
@@ -0,0 +1,214 @@
+#!/usr/bin/env python3
+"""Builds an INT8 (QDQ) or FP16 copy of the detection model and checks it against FP32.
+
+    QuantizeModel.py --model v11s_seg.onnx --images ai_results --mode int8 --out v11s_seg_int8.onnx
+    QuantizeModel.py --model v11s_seg.onnx --images ai_results --mode fp16 --out v11s_seg_fp16.onnx \
+        --bench build/DetectBench --config TFConfigs/TFConfigsBench.yml --min-map 0.9
+
+Calibration uses the sample_ori_*.png frames saved under ai_results, preprocessed exactly as
+InferenceORT does (RGB, plain resize to the model input, /255, NCHW). A disjoint part of the
+frames is kept for evaluation: with --bench, DetectBench writes a golden file from the FP32
+model and then scores the quantized one against it, so the reported mAP/recall is the
+accuracy delta and the p50 ratio the speed-up. The exit code is DetectBench's (0 pass,
+1 regression, 2 setup error).
+
+Needs onnx, onnxruntime, opencv-python and, for --mode fp16, onnxconverter-common.
+"""
+
+import argparse
+import random
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+import cv2
+import numpy as np
+import onnx
+
+
+def find_samples(root):
+    return sorted(Path(root).rglob("sample_ori_*.png"))
+
+
+def model_input(model_path):
+    model = onnx.load(str(model_path), load_external_data=False)
+    inp = model.graph.input[0]
+    dims = [d.dim_value for d in inp.type.tensor_type.shape.dim]
+    return inp.name, dims
+
+
+def preprocess(path, width, height):
+    img = cv2.imread(str(path), cv2.IMREAD_COLOR)
+    if img is None:
+        return None
+    img = cv2.cvtColor(img, cv2.COLOR_BGR2RGB)
+    img = cv2.resize(img, (width, height))
+    blob = img.astype(np.float32) / 255.0
+    return blob.transpose(2, 0, 1)[np.newaxis, ...]
+
+
+def tag_precision(path, precision):
+    # InferenceORT reads this to log and report the precision; QDQ models keep float I/O
+    model = onnx.load(str(path))
+    for prop in model.metadata_props:
+        if prop.key == "precision":
+            prop.value = precision
+            break
+    else:
+        model.metadata_props.add(key="precision", value=precision)
+    onnx.save(model, str(path))
+
+
+def quantize_int8(args, calib, input_name, width, height):
+    from onnxruntime.quantization import (CalibrationDataReader, CalibrationMethod, QuantFormat,
+                                          QuantType, quantize_static)
+    from onnxruntime.quantization.shape_inference import quant_pre_process
+
+    class SampleReader(CalibrationDataReader):
+        def __init__(self, paths):
+            self.paths = iter(paths)
+
+        def get_next(self):
+            for path in self.paths:
+                blob = preprocess(path, width, height)
+                if blob is not None:
+                    return {input_name: blob}
+            return None
+
+    methods = {
+        "minmax": CalibrationMethod.MinMax,
+        "percentile": CalibrationMethod.Percentile,
+        "entropy": CalibrationMethod.Entropy,
+    }
+    exclude = []
+    if args.exclude:
+        pattern = re.compile(args.exclude)
+        graph = onnx.load(str(args.model), load_external_data=False).graph
+        exclude = [node.name for node in graph.node if pattern.search(node.name)]
+        print(f"keeping {len(exclude)} nodes in float: {args.exclude}")
+
+    with tempfile.TemporaryDirectory() as tmp:
+        prepared = Path(tmp) / "prepared.onnx"
+        quant_pre_process(str(args.model), str(prepared))
+        quantize_static(str(prepared), str(args.out), SampleReader(calib),
+                        quant_format=QuantFormat.QDQ,
+                        activation_type=QuantType.QUInt8,
+                        weight_type=QuantType.QInt8,
+                        per_channel=args.per_channel,
+                        calibrate_method=methods[args.method],
+                        nodes_to_exclude=exclude)
+    tag_precision(args.out, "INT8")
+
+
+def convert_fp16(args):
+    from onnxconverter_common import float16
+
+    model = onnx.load(str(args.model))
+    model = float16.convert_float_to_float16(model, keep_io_types=args.keep_io)
+    onnx.save(model, str(args.out))
+    tag_precision(args.out, "FP16")
+
+
+def run_bench(args, model, extra):
+    # DetectBench reads the model from the config, so each run gets a copy pointing at its model
+    config = Path(args.config).read_text(encoding="utf-8")
+    config, count = re.subn(r"(?m)^(\s*DetModelName:).*$", rf"\1 {Path(model).resolve().as_posix()}", config)
+    if count != 1:
+        print(f"DetModelName not found in {args.config}", file=sys.stderr)
+        return 2, ""
+    with tempfile.NamedTemporaryFile("w", suffix=".yml", delete=False, encoding="utf-8") as f:
+        f.write(config)
+        config_path = f.name
+    try:
+        cmd = [args.bench, "--config", config_path, "--images", str(args.eval_dir)] + extra
+        proc = subprocess.run(cmd, capture_output=True, text=True)
+        print(proc.stdout, end="")
+        return proc.returncode, proc.stdout
+    finally:
+        Path(config_path).unlink(missing_ok=True)
+
+
+def total_p50(report):
+    match = re.search(r"^\s*total\s+p50\s+([\d.]+)", report, re.M)
+    return float(match.group(1)) if match else 0.0
+
+
+def evaluate(args, evals):
+    with tempfile.TemporaryDirectory() as tmp:
+        # Flattened, DetectBench reads a single directory and keys the golden file by name
+        args.eval_dir = Path(tmp) / "eval"
+        args.eval_dir.mkdir()
+        for i, path in enumerate(evals):
+            shutil.copy(path, args.eval_dir / f"{i:05d}_{path.name}")
+        golden = Path(tmp) / "golden_fp32.json"
+
+        print(f"==== FP32 reference {args.model} ====")
+        ret, fp32 = run_bench(args, args.model, ["--write-golden", str(golden)])
+        if ret != 0:
+            return ret
+        print(f"==== {args.mode.upper()} {args.out} ====")
+        ret, quant = run_bench(args, args.out, ["--golden", str(golden),
+                                                "--min-map", str(args.min_map),
+                                                "--min-recall", str(args.min_recall)])
+        base, cur = total_p50(fp32), total_p50(quant)
+        if base > 0.0 and cur > 0.0:
+            print(f"total p50 {base:.2f} ms -> {cur:.2f} ms, speed-up x{base / cur:.2f}")
+        return ret
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--model", required=True, help="FP32 onnx model")
+    parser.add_argument("--images", required=True, help="directory searched for sample_ori_*.png")
+    parser.add_argument("--mode", choices=["int8", "fp16"], default="int8")
+    parser.add_argument("--out", required=True)
+    parser.add_argument("--calib-count", type=int, default=200)
+    parser.add_argument("--eval-count", type=int, default=100)
+    parser.add_argument("--method", choices=["minmax", "percentile", "entropy"], default="minmax")
+    parser.add_argument("--per-channel", action="store_true", default=True)
+    parser.add_argument("--no-per-channel", dest="per_channel", action="store_false")
+    parser.add_argument("--exclude", default="", help="regex of node names left in float, e.g. the head")
+    parser.add_argument("--input-size", type=int, default=0, help="only for models with dynamic H/W")
+    parser.add_argument("--keep-io", action="store_true", help="fp16: keep float inputs/outputs")
+    parser.add_argument("--bench", default="", help="DetectBench binary, skips evaluation when empty")
+    parser.add_argument("--config", default="TFConfigs/TFConfigsBench.yml")
+    parser.add_argument("--min-map", type=float, default=0.0)
+    parser.add_argument("--min-recall", type=float, default=0.0)
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    samples = find_samples(args.images)
+    if not samples:
+        print(f"No sample_ori_*.png under {args.images}", file=sys.stderr)
+        return 2
+    random.Random(args.seed).shuffle(samples)
+    evals = samples[:args.eval_count] if args.bench else []
+    calib = samples[len(evals):len(evals) + args.calib_count]
+    if args.mode == "int8" and not calib:
+        print("No frames left for calibration, lower --eval-count", file=sys.stderr)
+        return 2
+    print(f"{len(samples)} frames found, {len(calib)} for calibration, {len(evals)} for evaluation")
+
+    input_name, dims = model_input(args.model)
+    height = dims[2] if len(dims) == 4 and dims[2] > 0 else args.input_size
+    width = dims[3] if len(dims) == 4 and dims[3] > 0 else args.input_size
+    if args.mode == "int8" and (width <= 0 or height <= 0):
+        print("Model input is dynamic, pass --input-size", file=sys.stderr)
+        return 2
+
+    if args.mode == "int8":
+        quantize_int8(args, calib, input_name, width, height)
+    else:
+        convert_fp16(args)
+    print(f"Written {args.out}")
+
+    if not args.bench:
+        return 0
+    return evaluate(args, evals)
+
+
+if __name__ == "__main__":
+    sys.exit(main())